@@ -160,6 +160,10 @@ ifeq ($(MCL_USE_OMP),1)
     LDFLAGS+=-fopenmp
   endif
 endif
+ifeq ($(MCL_USE_STD_THREAD),1)
+  CFLAGS+=-DMCL_USE_STD_THREAD -pthread
+  LDFLAGS+=-pthread
+endif
 LDFLAGS+=$(GMP_LIB) $(BIT_OPT) $(LDFLAGS_USER)
 
 # -fpic is better than -fPIC in exchange for restriction of a size of GOT
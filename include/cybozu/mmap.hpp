@@ -0,0 +1,114 @@
+#pragma once
+/**
+	@file
+	@brief mmap class
+
+	@author MITSUNARI Shigeo(@herumi)
+*/
+#include <string>
+#include <cybozu/exception.hpp>
+#include <cybozu/inttype.hpp>
+
+#ifdef _WIN32
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#include <windows.h>
+#else
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace cybozu {
+
+/*
+	map a file into memory
+	ReadOnly : the mapped area must not be written
+	CopyOnWrite : the mapped area may be written but the file is not changed
+	(a written page is copied by OS)
+*/
+class Mmap {
+	char *map_;
+	uint64_t size_;
+#ifdef _WIN32
+	HANDLE hFile_;
+	HANDLE hMap_;
+#endif
+	Mmap(const Mmap&);
+	void operator=(const Mmap&);
+public:
+	enum Mode {
+		ReadOnly,
+		CopyOnWrite
+	};
+	explicit Mmap(const std::string& fileName, Mode mode = ReadOnly)
+		: map_(0)
+		, size_(0)
+#ifdef _WIN32
+		, hFile_(INVALID_HANDLE_VALUE)
+		, hMap_(0)
+#endif
+	{
+#ifdef _WIN32
+		hFile_ = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (hFile_ == INVALID_HANDLE_VALUE) {
+			throw cybozu::Exception("Mmap:CreateFile") << cybozu::ErrorNo() << fileName;
+		}
+		LARGE_INTEGER size;
+		if (GetFileSizeEx(hFile_, &size) == 0) {
+			CloseHandle(hFile_);
+			throw cybozu::Exception("Mmap:GetFileSize") << cybozu::ErrorNo() << fileName;
+		}
+		size_ = size.QuadPart;
+		if (size_ == 0) return;
+		hMap_ = CreateFileMapping(hFile_, NULL, mode == ReadOnly ? PAGE_READONLY : PAGE_WRITECOPY, 0, 0, NULL);
+		if (hMap_ == NULL) {
+			CloseHandle(hFile_);
+			throw cybozu::Exception("Mmap:CreateFileMapping") << cybozu::ErrorNo() << fileName;
+		}
+		map_ = (char*)MapViewOfFile(hMap_, mode == ReadOnly ? FILE_MAP_READ : FILE_MAP_COPY, 0, 0, 0);
+		if (map_ == 0) {
+			CloseHandle(hMap_);
+			CloseHandle(hFile_);
+			throw cybozu::Exception("Mmap:MapViewOfFile") << cybozu::ErrorNo() << fileName;
+		}
+#else
+		int fd = ::open(fileName.c_str(), O_RDONLY);
+		if (fd == -1) throw cybozu::Exception("Mmap:open") << cybozu::ErrorNo() << fileName;
+		struct stat st;
+		if (::fstat(fd, &st) != 0) {
+			::close(fd);
+			throw cybozu::Exception("Mmap:fstat") << cybozu::ErrorNo() << fileName;
+		}
+		size_ = st.st_size;
+		if (size_ == 0) {
+			::close(fd);
+			return;
+		}
+		const int prot = mode == ReadOnly ? PROT_READ : (PROT_READ | PROT_WRITE);
+		void *p = ::mmap(NULL, size_t(size_), prot, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (p == MAP_FAILED) throw cybozu::Exception("Mmap:mmap") << cybozu::ErrorNo() << fileName;
+		map_ = (char*)p;
+#endif
+	}
+	~Mmap()
+	{
+#ifdef _WIN32
+		if (map_) UnmapViewOfFile(map_);
+		if (hMap_) CloseHandle(hMap_);
+		if (hFile_ != INVALID_HANDLE_VALUE) CloseHandle(hFile_);
+#else
+		if (map_) ::munmap(map_, size_t(size_));
+#endif
+	}
+	uint64_t size() const { return size_; }
+	const char *get() const { return map_; }
+	// available only in CopyOnWrite mode
+	char *get() { return map_; }
+};
+
+} // cybozu
@@ -148,6 +148,37 @@ public:
 			}
 			return verify(&mv[0], &sv[0], &pubVec[0], n);
 		}
+		/*
+			batch verification of independent signatures
+			return true if pubVec[i].verify(sigVec[i], msgVec[i]) for all i
+			(except with probability 2^-64) by one millerLoopVec and one finalExp
+			the same message may appear more than once
+			with cpuN threads (the num of thread is automatically detected if cpuN = 0) if MCL_USE_OMP is defined
+		*/
+		static bool verifyBatch(const Signature *sigVec, const PublicKey *pubVec, const void *const *msgVec, const size_t *sizeVec, size_t n, size_t cpuN = 0)
+		{
+			if (n == 0) return false;
+			std::vector<G1> sv(n);
+			std::vector<G2> pv(n);
+			for (size_t i = 0; i < n; i++) {
+				sv[i] = sigVec[i].S_;
+				pv[i] = pubVec[i].xQ_;
+			}
+			return verifyBatchG1(&sv[0], &pv[0], msgVec, sizeVec, n, Q_, cpuN);
+		}
+		static bool verifyBatch(const std::vector<Signature>& sigVec, const std::vector<PublicKey>& pubVec, const std::vector<std::string>& msgVec, size_t cpuN = 0)
+		{
+			const size_t n = msgVec.size();
+			if (n != sigVec.size() || n != pubVec.size()) throw cybozu::Exception("aggs:Signature:verifyBatch:bad size") << sigVec.size() << pubVec.size() << msgVec.size();
+			if (n == 0) return false;
+			std::vector<const void*> mv(n);
+			std::vector<size_t> sv(n);
+			for (size_t i = 0; i < n; i++) {
+				mv[i] = msgVec[i].c_str();
+				sv[i] = msgVec[i].size();
+			}
+			return verifyBatch(&sigVec[0], &pubVec[0], &mv[0], &sv[0], n, cpuN);
+		}
 	};
 	class PublicKey : public fp::Serializable<PublicKey> {
 		G2 xQ_;
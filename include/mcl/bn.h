@@ -240,6 +240,14 @@ MCL_DLL_API mclSize mclBnG2_deserialize(mclBnG2 *x, const void *buf, mclSize buf
 MCL_DLL_API mclSize mclBnGT_deserialize(mclBnGT *x, const void *buf, mclSize bufSize);
 MCL_DLL_API mclSize mclBnFp_deserialize(mclBnFp *x, const void *buf, mclSize bufSize);
 MCL_DLL_API mclSize mclBnFp2_deserialize(mclBnFp2 *x, const void *buf, mclSize bufSize);
+/*
+	deserialize n points serialized by mclBnG1_serialize (mclBn_getG1ByteSize() bytes each) and concatenated in buf
+	ok[i] = 1 if x[i] is valid else 0 and x[i] is cleared (ok may be NULL)
+	return the num of valid points (= n if all points are valid)
+	multi thread version if the library built with MCL_USE_OMP=1 (the num of thread is automatically detected if cpuN = 0)
+*/
+MCL_DLL_API mclSize mclBnG1_deserializeVec(mclBnG1 *x, int *ok, const void *buf, mclSize bufSize, mclSize n, mclSize cpuN);
+MCL_DLL_API mclSize mclBnG2_deserializeVec(mclBnG2 *x, int *ok, const void *buf, mclSize bufSize, mclSize n, mclSize cpuN);
 
 /*
 	serialize
@@ -420,10 +428,21 @@ MCL_DLL_API int mclBnG1_isZero(const mclBnG1 *x);
 	mclBnG1_isValid() && mclBnG1_isValidOrder() is true if mclBn_verifyOrderG1(false)
 */
 MCL_DLL_API int mclBnG1_isValidOrder(const mclBnG1 *x);
+/*
+	return n if all x[i] have a correct order else the index of the first x[i] with an incorrect order
+	multi thread version if the library built with MCL_USE_OMP=1 (the num of thread is automatically detected if cpuN = 0)
+*/
+MCL_DLL_API mclSize mclBnG1_isValidOrderVec(const mclBnG1 *x, mclSize n, mclSize cpuN);
 
 MCL_DLL_API int mclBnG1_hashAndMapTo(mclBnG1 *x, const void *buf, mclSize bufSize);
 // user-defined dst
 MCL_DLL_API int mclBnG1_hashAndMapToWithDst(mclBnG1 *x, const void *buf, mclSize bufSize, const char *dst, mclSize dstSize);
+/*
+	x[i] = hashAndMapTo(msg[i]) for i < n where msg[i] is the msgSize bytes at (const char*)msgVec + msgSize * i
+	the messages are hashed at once with SHA extensions or AVX2 if available
+	multi thread version if the library built with MCL_USE_OMP=1 (the num of thread is automatically detected if cpuN = 0)
+*/
+MCL_DLL_API int mclBnG1_hashAndMapToVec(mclBnG1 *x, const void *msgVec, mclSize msgSize, mclSize n, mclSize cpuN);
 // set default dst
 MCL_DLL_API int mclBnG1_setDst(const char *dst, mclSize dstSize);
 
@@ -450,10 +469,12 @@ MCL_DLL_API int mclBnG2_isEqual(const mclBnG2 *x, const mclBnG2 *y);
 MCL_DLL_API int mclBnG2_isZero(const mclBnG2 *x);
 // return 1 if x has a correct order
 MCL_DLL_API int mclBnG2_isValidOrder(const mclBnG2 *x);
+MCL_DLL_API mclSize mclBnG2_isValidOrderVec(const mclBnG2 *x, mclSize n, mclSize cpuN);
 
 MCL_DLL_API int mclBnG2_hashAndMapTo(mclBnG2 *x, const void *buf, mclSize bufSize);
 // user-defined dst
 MCL_DLL_API int mclBnG2_hashAndMapToWithDst(mclBnG2 *x, const void *buf, mclSize bufSize, const char *dst, mclSize dstSize);
+MCL_DLL_API int mclBnG2_hashAndMapToVec(mclBnG2 *x, const void *msgVec, mclSize msgSize, mclSize n, mclSize cpuN);
 // set default dst
 MCL_DLL_API int mclBnG2_setDst(const char *dst, mclSize dstSize);
 
@@ -511,6 +532,24 @@ MCL_DLL_API void mclBnG1_mulVec(mclBnG1 *z, mclBnG1 *x, const mclBnFr *y, mclSiz
 MCL_DLL_API void mclBnG2_mulVec(mclBnG2 *z, mclBnG2 *x, const mclBnFr *y, mclSize n);
 MCL_DLL_API void mclBnGT_powVec(mclBnGT *z, const mclBnGT *x, const mclBnFr *y, mclSize n);
 
+/*
+	fixed-base mulVec
+	c : window size (1 <= c <= 20)
+	mclBn_getMulVecFixedBaseWindowSize(n) returns the default value for n
+	allocate tbl[mclBn_getPrecomputedMulVecSize(n, c)] before calling mclBnG1_precomputeMulVec
+	tbl is a flat array of normalized points and may be saved and loaded as it is in the same curve
+	tbl does not have c, so use the same c for mclBnG1_precomputeMulVec and mclBnG1_mulVecFixedBase
+	return 0 if success else -1 (c is out of the range)
+*/
+MCL_DLL_API mclSize mclBn_getMulVecFixedBaseWindowSize(mclSize n);
+// return 0 if c is out of the range
+MCL_DLL_API mclSize mclBn_getPrecomputedMulVecSize(mclSize n, mclSize c);
+MCL_DLL_API int mclBnG1_precomputeMulVec(mclBnG1 *tbl, const mclBnG1 *x, mclSize n, mclSize c);
+MCL_DLL_API int mclBnG2_precomputeMulVec(mclBnG2 *tbl, const mclBnG2 *x, mclSize n, mclSize c);
+// z = sum_{i=0}^{m-1} x[i] y[i] for m <= n with tbl made by mclBnG1_precomputeMulVec(tbl, x, n, c)
+MCL_DLL_API int mclBnG1_mulVecFixedBase(mclBnG1 *z, const mclBnG1 *tbl, const mclBnFr *y, mclSize m, mclSize c);
+MCL_DLL_API int mclBnG2_mulVecFixedBase(mclBnG2 *z, const mclBnG2 *tbl, const mclBnFr *y, mclSize m, mclSize c);
+
 // x[i] *= y[i]
 MCL_DLL_API void mclBnG1_mulEach(mclBnG1 *x, const mclBnFr *y, mclSize n);
 
@@ -529,11 +568,19 @@ MCL_DLL_API void mclBn_millerLoop(mclBnGT *z, const mclBnG1 *x, const mclBnG2 *y
 // z = prod_{i=0}^{n-1} millerLoop(x[i], y[i])
 MCL_DLL_API void mclBn_millerLoopVec(mclBnGT *z, const mclBnG1 *x, const mclBnG2 *y, mclSize n);
 // multi thread version of millerLoopVec/mclBnG1_mulVec/mclBnG2_mulVec (enabled if the library built with MCL_USE_OMP=1)
+// mclBn_millerLoopVecMT is also enabled if the library built with MCL_USE_STD_THREAD=1
 // the num of thread is automatically detected if cpuN = 0
 // x[] may be normalized (the values are not changed) when computing z
 MCL_DLL_API void mclBn_millerLoopVecMT(mclBnGT *z, const mclBnG1 *x, const mclBnG2 *y, mclSize n, mclSize cpuN);
 MCL_DLL_API void mclBnG1_mulVecMT(mclBnG1 *z, mclBnG1 *x, const mclBnFr *y, mclSize n, mclSize cpuN);
 MCL_DLL_API void mclBnG2_mulVecMT(mclBnG2 *z, mclBnG2 *x, const mclBnFr *y, mclSize n, mclSize cpuN);
+/*
+	return 1 if e(sig[i], *Q) = e(hashAndMapToG1(msg[i]), pub[i]) for all i < n else 0
+	msg[i] is the msgSize bytes at (const char*)msgVec + msgSize * i
+	sig[] must be in the subgroup (see mclBnG1_isValidOrderVec)
+	all equations are checked with one millerLoopVec and one finalExp (see verifyBatchG1 in bn.hpp)
+*/
+MCL_DLL_API int mclBn_verifyBatchG1(const mclBnG1 *sig, const mclBnG2 *pub, const void *msgVec, mclSize msgSize, mclSize n, const mclBnG2 *Q, mclSize cpuN);
 
 // return precomputedQcoeffSize * sizeof(Fp6) / sizeof(uint64_t)
 MCL_DLL_API int mclBn_getUint64NumToPrecompute(void);
@@ -63,10 +63,36 @@ MCL_DLL_API void precomputedMillerLoop2(Fp12& f, const G1& P1_, const Fp6* Q1coe
 */
 MCL_DLL_API void millerLoopVec(Fp12& f, const G1* Pvec, const G2* Qvec, size_t n, bool initF = true);
 
-// multi thread version of millerLoopVec
+// multi thread version of millerLoopVec (enabled if MCL_USE_OMP or MCL_USE_STD_THREAD is defined)
 // the num of thread is automatically detected if cpuN = 0
+// the pairs are split into min(cpuN, n) threads if cpuN > 0 is specified
 MCL_DLL_API void millerLoopVecMT(Fp12& f, const G1* Pvec, const G2* Qvec, size_t n, size_t cpuN = 0);
 
+/*
+	fixed-base mulVec
+	precomputeMulVec makes tbl[i * winN + k] = 2^(c k) xVec[i] for i < n, k < winN = ceil(bitSize(Fr) / c)
+	and mulVecFixedBase computes z = sum_{i=0}^{n-1} xVec[i] yVec[i] with tbl without doublings
+	c : window size (c = 0 means getMulVecFixedBaseWindowSize(n))
+	use the same n and c for precomputeMulVec and mulVecFixedBase
+	@note tbl consists of normalized points and may be saved and loaded as a flat array
+*/
+MCL_DLL_API size_t getMulVecFixedBaseWindowSize(size_t n);
+// get the num of elements of tbl
+MCL_DLL_API size_t getPrecomputedMulVecSize(size_t n, size_t c = 0);
+MCL_DLL_API void precomputeMulVec(G1 *tbl, const G1 *xVec, size_t n, size_t c = 0);
+MCL_DLL_API void precomputeMulVec(G2 *tbl, const G2 *xVec, size_t n, size_t c = 0);
+MCL_DLL_API void mulVecFixedBase(G1& z, const G1 *tbl, const Fr *yVec, size_t n, size_t c = 0);
+MCL_DLL_API void mulVecFixedBase(G2& z, const G2 *tbl, const Fr *yVec, size_t n, size_t c = 0);
+
+/*
+	deserialize n points from buf[0:bufSize] where the points are serialized to G::getSerializedByteSize() bytes and concatenated
+	okVec[i] = true if xVec[i] is deserialized and valid else false and xVec[i] is cleared (okVec may be null)
+	return the num of valid points (= n if all points are valid)
+	with cpuN threads (the num of thread is automatically detected if cpuN = 0) if MCL_USE_OMP is defined
+*/
+MCL_DLL_API size_t deserializeVec(G1 *xVec, const void *buf, size_t bufSize, size_t n, bool *okVec = 0, size_t cpuN = 0);
+MCL_DLL_API size_t deserializeVec(G2 *xVec, const void *buf, size_t bufSize, size_t n, bool *okVec = 0, size_t cpuN = 0);
+
 MCL_DLL_API bool setMapToMode(int mode);
 MCL_DLL_API int getMapToMode();
 MCL_DLL_API void mapToG1(bool *pb, G1& P, const Fp& x);
@@ -76,6 +102,19 @@ MCL_DLL_API void hashAndMapToG1(G1& P, const void *buf, size_t bufSize);
 MCL_DLL_API void hashAndMapToG2(G2& P, const void *buf, size_t bufSize);
 MCL_DLL_API void hashAndMapToG1(G1& P, const void *buf, size_t bufSize, const char *dst, size_t dstSize);
 MCL_DLL_API void hashAndMapToG2(G2& P, const void *buf, size_t bufSize, const char *dst, size_t dstSize);
+/*
+	P[i] = hashAndMapToG1(msgVec[i], msgSizeVec[i]) for i < n (resp. G2)
+	expand_message_xmd of several messages are computed at once (see expand_message_xmd_vec)
+	with cpuN threads (the num of thread is automatically detected if cpuN = 0) if MCL_USE_OMP is defined
+*/
+MCL_DLL_API void hashAndMapToG1Vec(G1 *P, const void *const *msgVec, const size_t *msgSizeVec, size_t n, size_t cpuN = 0);
+MCL_DLL_API void hashAndMapToG2Vec(G2 *P, const void *const *msgVec, const size_t *msgSizeVec, size_t n, size_t cpuN = 0);
+/*
+	Q[i] = h_eff P[i] for i < n on BLS12 (the cofactor clearing of hash-to-curve)
+	Q[i] are normalized
+	P must not overlap Q except for P == Q
+*/
+MCL_DLL_API void mulByCofactorBLS12fastVec(G2 *Q, const G2 *P, size_t n);
 // set the default dst for G1
 // return 0 if success else -1
 MCL_DLL_API bool setDstG1(const char *dst, size_t dstSize);
@@ -89,6 +128,21 @@ MCL_DLL_API void verifyOrderG2(bool doVerify);
 
 MCL_DLL_API bool isValidOrderBLS12(const G2& P);
 MCL_DLL_API bool isValidOrderBLS12(const G1& P);
+/*
+	return n if all xVec[i] are in the subgroup of order r
+	otherwise return the index of the first point not in the subgroup
+	with cpuN threads (the num of thread is automatically detected if cpuN = 0) if MCL_USE_OMP is defined
+*/
+MCL_DLL_API size_t isValidOrderVec(const G1 *xVec, size_t n, size_t cpuN = 0);
+MCL_DLL_API size_t isValidOrderVec(const G2 *xVec, size_t n, size_t cpuN = 0);
+/*
+	verify e(sigVec[i], Q) = e(hashAndMapToG1(msgVec[i]), pubVec[i]) for all i < n at once
+	with one millerLoopVec and one finalExp over sum_i r_i sigVec[i] for random 64-bit r_i
+	return false if n = 0 or some equation does not hold (except with probability 2^-64)
+	@note sigVec[i] must be in the subgroup (see isValidOrderVec)
+	with cpuN threads (the num of thread is automatically detected if cpuN = 0) if MCL_USE_OMP is defined
+*/
+MCL_DLL_API bool verifyBatchG1(const G1 *sigVec, const G2 *pubVec, const void *const *msgVec, const size_t *msgSizeVec, size_t n, const G2& Q, size_t cpuN = 0);
 
 // backward compatibility
 using mcl::CurveParam;
@@ -123,6 +177,7 @@ using namespace mcl;
 
 #ifndef CYBOZU_DONT_USE_EXCEPTION
 #include <vector>
+#include <cybozu/hash.hpp>
 namespace mcl {
 
 inline void precomputeG2(std::vector<Fp6>& Qcoeff, const G2& Q)
@@ -146,6 +201,130 @@ inline void precomputedMillerLoop2mixed(Fp12& f, const G1& P1, const G2& Q1, con
 	precomputedMillerLoop2mixed(f, P1, Q1, P2, Q2coeff.data());
 }
 
+/*
+	precomputed table for mulVecFixedBase
+	save/load : raw data of the table in the current curve
+	format : curveType, GtoChar, c, sizeof(G), n, checksum, table
+	load verifies n, the checksum and that each point is normalized and on the curve
+	(the order of the points is not verified)
+*/
+template<class G>
+class MsmPrecompT {
+	std::vector<G> tbl_;
+	size_t n_;
+	size_t c_;
+	// the num of points hashed (and read by load) at once
+	static const size_t blockSize = 4096;
+	static char GtoChar() { return sizeof(G) == sizeof(G1) ? '1' : '2'; }
+	static uint64_t updateChecksum(uint64_t h, const G *p, size_t n)
+	{
+		const uint32_t *q = (const uint32_t*)p;
+		return cybozu::hash64(q, q + sizeof(G) / sizeof(uint32_t) * n, h);
+	}
+	static uint64_t getChecksum(const G *p, size_t n)
+	{
+		uint64_t h = 0;
+		for (size_t i = 0; i < n; i += blockSize) {
+			h = updateChecksum(h, p + i, fp::min_(blockSize, n - i));
+		}
+		return h;
+	}
+	// the coordinates are less than p, P is normalized and on the curve
+	static bool isValidPoint(const G& P)
+	{
+		const Fp *v = (const Fp*)&P;
+		for (size_t i = 0; i < sizeof(G) / sizeof(Fp); i++) {
+			if (!v[i].isValid()) return false;
+		}
+		if (P.z.isZero()) return true;
+		return P.z.isOne() && ec::isValidJacobi(P);
+	}
+public:
+	MsmPrecompT() : n_(0), c_(0) {}
+	void init(const G *xVec, size_t n, size_t c = 0)
+	{
+		if (c == 0) c = getMulVecFixedBaseWindowSize(n);
+		tbl_.resize(getPrecomputedMulVecSize(n, c));
+		precomputeMulVec(tbl_.data(), xVec, n, c);
+		n_ = n;
+		c_ = c;
+	}
+	size_t size() const { return n_; }
+	size_t getWindowSize() const { return c_; }
+	const G *getTable() const { return tbl_.data(); }
+	/*
+		z = sum_{i=0}^{n-1} xVec[i] yVec[i]
+		n <= size()
+	*/
+	void mulVec(G& z, const Fr *yVec, size_t n) const
+	{
+		if (n > n_) throw cybozu::Exception("MsmPrecomp:mulVec:bad n") << n << n_;
+		// tbl_[0:n * winN] is the table for xVec[0:n]
+		mulVecFixedBase(z, tbl_.data(), yVec, n, c_);
+	}
+	template<class OutputStream>
+	void save(OutputStream& os) const
+	{
+		const uint32_t header[4] = { uint32_t(getCurveParam().curveType), uint32_t(GtoChar()), uint32_t(c_), uint32_t(sizeof(G)) };
+		const uint64_t n = n_;
+		const uint64_t checksum = getChecksum(tbl_.data(), tbl_.size());
+		cybozu::write(os, header, sizeof(header));
+		cybozu::write(os, &n, sizeof(n));
+		cybozu::write(os, &checksum, sizeof(checksum));
+		cybozu::write(os, tbl_.data(), sizeof(G) * tbl_.size());
+	}
+	/*
+		throw exception if the stream is truncated or the table is broken
+		the table is not changed if an exception is thrown
+	*/
+	template<class InputStream>
+	void load(InputStream& is)
+	{
+		uint32_t header[4];
+		uint64_t n, checksum;
+		cybozu::read(header, sizeof(header), is);
+		if (header[0] != uint32_t(getCurveParam().curveType)) throw cybozu::Exception("MsmPrecomp:load:bad curveType") << header[0];
+		if (header[1] != uint32_t(GtoChar())) throw cybozu::Exception("MsmPrecomp:load:bad group") << header[1];
+		if (header[2] == 0 || header[2] > 20) throw cybozu::Exception("MsmPrecomp:load:bad c") << header[2];
+		if (header[3] != sizeof(G)) throw cybozu::Exception("MsmPrecomp:load:bad size") << header[3];
+		cybozu::read(&n, sizeof(n), is);
+		cybozu::read(&checksum, sizeof(checksum), is);
+		const size_t c = header[2];
+		const size_t winN = (Fr::getBitSize() + c - 1) / c;
+		if (n > uint64_t(size_t(-1) / sizeof(G) / winN)) throw cybozu::Exception("MsmPrecomp:load:bad n") << n;
+		const size_t tblN = size_t(n) * winN;
+		// read by blocks so that a truncated stream fails before the whole table is allocated
+		std::vector<G> tbl;
+		uint64_t h = 0;
+		for (size_t i = 0; i < tblN; i += blockSize) {
+			const size_t m = fp::min_(blockSize, tblN - i);
+			tbl.resize(i + m);
+			cybozu::read(&tbl[i], sizeof(G) * m, is);
+			h = updateChecksum(h, &tbl[i], m);
+		}
+		if (h != checksum) throw cybozu::Exception("MsmPrecomp:load:bad checksum");
+		for (size_t i = 0; i < tblN; i++) {
+			if (!isValidPoint(tbl[i])) throw cybozu::Exception("MsmPrecomp:load:bad point") << i;
+		}
+		tbl_.swap(tbl);
+		n_ = size_t(n);
+		c_ = c;
+	}
+};
+
+typedef MsmPrecompT<G1> MsmPrecomp;
+typedef MsmPrecompT<G2> MsmPrecompG2;
+
+inline void mulVecFixedBase(G1& z, const MsmPrecomp& precomp, const Fr *yVec, size_t n)
+{
+	precomp.mulVec(z, yVec, n);
+}
+
+inline void mulVecFixedBase(G2& z, const MsmPrecompG2& precomp, const Fr *yVec, size_t n)
+{
+	precomp.mulVec(z, yVec, n);
+}
+
 inline void initPairing(const mcl::CurveParam& cp = mcl::BN254)
 {
 	bool b;
@@ -1022,6 +1022,7 @@ public:
 	static mpz_class order_;
 	static bool (*mulVecGLV)(EcT& z, const EcT *xVec, const void *yVec, size_t n, bool constTime, size_t b);
 	static void (*mulVecOpti)(EcT& z, EcT *xVec, const Fr *yVec, size_t n, size_t b);
+	static bool (*mulVecGLVMT)(EcT& z, const EcT *xVec, const void *yVec, size_t n, size_t cpuN);
 	static void (*mulEachOpti)(EcT *xVec, const Fr *yVec, size_t n);
 	static bool (*isValidOrderFast)(const EcT& x);
 	/* default constructor is undefined value */
@@ -1093,6 +1094,7 @@ public:
 		order_ = 0;
 		mulVecGLV = 0;
 		mulVecOpti = 0;
+		mulVecGLVMT = 0;
 		mulEachOpti = 0;
 		isValidOrderFast = 0;
 		mode_ = mode;
@@ -1124,6 +1126,10 @@ public:
 	{
 		mulVecOpti = f;
 	}
+	static void setMulVecGLVMT(bool f(EcT& z, const EcT *xVec, const void *yVec, size_t yn, size_t cpuN))
+	{
+		mulVecGLVMT = f;
+	}
 	static void setMulEachOpti(void f(EcT *xVec, const Fr *yVec, size_t yn))
 	{
 		mulEachOpti = f;
@@ -1816,8 +1822,12 @@ public:
 		}
 		z = r;
 	}
-	// multi thread version of mulVec
-	// the num of thread is automatically detected if cpuN = 0
+	/*
+		multi thread version of mulVec
+		the num of thread is automatically detected if cpuN = 0
+		If mulVecOpti is not set, the windows and the buckets of mulVec are shared by threads.
+		Otherwise xVec is split into cpuN parts and each part is computed by mulVecOpti.
+	*/
 	static inline void mulVecMT(EcT& z, EcT *xVec, const Fr *yVec, size_t n, size_t cpuN = 0)
 	{
 #ifdef MCL_USE_OMP
@@ -1828,6 +1838,9 @@ public:
 			cpuN = (n + minN - 1) / minN;
 		}
 	}
+	if (mulVecOpti == 0 && mulVecGLVMT && mulVecGLVMT(z, xVec, yVec, n, cpuN)) {
+		return;
+	}
 	if (cpuN <= 1 || n <= cpuN) {
 		mulVec(z, xVec, yVec, n);
 		return;
@@ -1922,6 +1935,7 @@ template<class Fp> bool EcT<Fp>::verifyOrder_;
 template<class Fp> mpz_class EcT<Fp>::order_;
 template<class Fp> bool (*EcT<Fp>::mulVecGLV)(EcT& z, const EcT *xVec, const void *yVec, size_t n, bool constTime, size_t b);
 template<class Fp> void (*EcT<Fp>::mulVecOpti)(EcT& z, EcT *xVec, const Fr *yVec, size_t n, size_t b);
+template<class Fp> bool (*EcT<Fp>::mulVecGLVMT)(EcT& z, const EcT *xVec, const void *yVec, size_t n, size_t cpuN);
 template<class Fp> bool (*EcT<Fp>::isValidOrderFast)(const EcT& x);
 template<class Fp> int EcT<Fp>::mode_;
 template<class Fp> void (*EcT<Fp>::mulEachOpti)(EcT<Fp> *xVec, const Fr *yVec, size_t n);
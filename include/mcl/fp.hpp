@@ -50,6 +50,11 @@ MCL_DLL_API uint32_t sha512(void *out, uint32_t maxOutSize, const void *msg, uin
 
 // draft-07 outSize = 128 or 256
 MCL_DLL_API void expand_message_xmd(uint8_t out[], size_t outSize, const void *msg, size_t msgSize, const void *dst, size_t dstSize);
+/*
+	out[outSize * i:outSize * (i + 1)] = expand_message_xmd(msgVec[i], msgSizeVec[i]) for i < n
+	SHA extensions or AVX2 (8 messages at once) are used if available
+*/
+MCL_DLL_API void expand_message_xmd_vec(uint8_t *out, size_t outSize, const void *const *msgVec, const size_t *msgSizeVec, size_t n, const void *dst, size_t dstSize);
 
 namespace local {
 
@@ -161,6 +166,10 @@ public:
 			op_.fp_mul2A_ = mul2A;
 		}
 #endif
+		mulVecOpti = 0;
+		addVecOpti = 0;
+		subVecOpti = 0;
+		invVecOpti = 0;
 		*pb = true;
 	}
 	static inline void init(bool *pb, const char *mstr, int u = 0, int xi_a = 0)
@@ -583,6 +592,92 @@ public:
 		assert(!x.isZero());
 		op_.fp_invOp(y.v_, x.v_, op_);
 	}
+	/*
+		optional functions for arrays (e.g. AVX-512 IFMA for Fr of BLS12-381)
+		n % 8 == 0
+	*/
+	static void (*mulVecOpti)(FpT *z, const FpT *x, const FpT *y, size_t n);
+	static void (*addVecOpti)(FpT *z, const FpT *x, const FpT *y, size_t n);
+	static void (*subVecOpti)(FpT *z, const FpT *x, const FpT *y, size_t n);
+	static void (*invVecOpti)(FpT *y, const FpT *x, size_t n);
+	static void setMulVecOpti(void f(FpT *z, const FpT *x, const FpT *y, size_t n))
+	{
+		mulVecOpti = f;
+	}
+	static void setAddVecOpti(void f(FpT *z, const FpT *x, const FpT *y, size_t n))
+	{
+		addVecOpti = f;
+	}
+	static void setSubVecOpti(void f(FpT *z, const FpT *x, const FpT *y, size_t n))
+	{
+		subVecOpti = f;
+	}
+	static void setInvVecOpti(void f(FpT *y, const FpT *x, size_t n))
+	{
+		invVecOpti = f;
+	}
+	// z[i] = x[i] * y[i] for i < n
+	static void mulVec(FpT *z, const FpT *x, const FpT *y, size_t n)
+	{
+		if (mulVecOpti && n >= 8) {
+			size_t n8 = n & ~size_t(8-1);
+			mulVecOpti(z, x, y, n8);
+			z += n8;
+			x += n8;
+			y += n8;
+			n -= n8;
+		}
+		for (size_t i = 0; i < n; i++) {
+			mul(z[i], x[i], y[i]);
+		}
+	}
+	// z[i] = x[i] + y[i] for i < n
+	static void addVec(FpT *z, const FpT *x, const FpT *y, size_t n)
+	{
+		if (addVecOpti && n >= 8) {
+			size_t n8 = n & ~size_t(8-1);
+			addVecOpti(z, x, y, n8);
+			z += n8;
+			x += n8;
+			y += n8;
+			n -= n8;
+		}
+		for (size_t i = 0; i < n; i++) {
+			add(z[i], x[i], y[i]);
+		}
+	}
+	// z[i] = x[i] - y[i] for i < n
+	static void subVec(FpT *z, const FpT *x, const FpT *y, size_t n)
+	{
+		if (subVecOpti && n >= 8) {
+			size_t n8 = n & ~size_t(8-1);
+			subVecOpti(z, x, y, n8);
+			z += n8;
+			x += n8;
+			y += n8;
+			n -= n8;
+		}
+		for (size_t i = 0; i < n; i++) {
+			sub(z[i], x[i], y[i]);
+		}
+	}
+	/*
+		the same as mcl::invVec(y, x, n)
+		y[i] = 1/x[i] for x[i] != 0 else 0
+		return num of x[i] not in {0, 1}
+	*/
+	static size_t invVec(FpT *y, const FpT *x, size_t n)
+	{
+		if (invVecOpti == 0 || n < 64) return mcl::invVec(y, x, n);
+		size_t retNum = 0;
+		for (size_t i = 0; i < n; i++) {
+			if (!(x[i].isZero() || x[i].isOne())) retNum++;
+		}
+		size_t n8 = n & ~size_t(8-1);
+		invVecOpti(y, x, n8);
+		mcl::invVec(y + n8, x + n8, n - n8);
+		return retNum;
+	}
 	static inline void divBy2(FpT& y, const FpT& x)
 	{
 		bool odd = (x.v_[0] & 1) != 0;
@@ -794,6 +889,14 @@ public:
 // Declare op_ as an external variable
 template<int tag, size_t maxBitSize>
 fp::Op FpT<tag, maxBitSize>::op_ MCL_INIT_PRIORITY(200);
+template<int tag, size_t maxBitSize>
+void (*FpT<tag, maxBitSize>::mulVecOpti)(FpT<tag, maxBitSize> *z, const FpT<tag, maxBitSize> *x, const FpT<tag, maxBitSize> *y, size_t n);
+template<int tag, size_t maxBitSize>
+void (*FpT<tag, maxBitSize>::addVecOpti)(FpT<tag, maxBitSize> *z, const FpT<tag, maxBitSize> *x, const FpT<tag, maxBitSize> *y, size_t n);
+template<int tag, size_t maxBitSize>
+void (*FpT<tag, maxBitSize>::subVecOpti)(FpT<tag, maxBitSize> *z, const FpT<tag, maxBitSize> *x, const FpT<tag, maxBitSize> *y, size_t n);
+template<int tag, size_t maxBitSize>
+void (*FpT<tag, maxBitSize>::invVecOpti)(FpT<tag, maxBitSize> *y, const FpT<tag, maxBitSize> *x, size_t n);
 
 } // mcl
 
@@ -8,6 +8,43 @@
 */
 namespace mcl {
 
+template<int tag, size_t maxBitSize>
+class FpT;
+
+namespace local {
+
+/*
+	use FpT::mulVec and FpT::invVec if F is FpT
+	and the scalar loops for other F
+*/
+template<class F>
+void mulVecF(F *z, const F *x, const F *y, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		F::mul(z[i], x[i], y[i]);
+	}
+}
+
+template<int tag, size_t maxBitSize>
+void mulVecF(FpT<tag, maxBitSize> *z, const FpT<tag, maxBitSize> *x, const FpT<tag, maxBitSize> *y, size_t n)
+{
+	FpT<tag, maxBitSize>::mulVec(z, x, y, n);
+}
+
+template<class F>
+void invVecF(F *y, const F *x, size_t n)
+{
+	mcl::invVec(y, x, n);
+}
+
+template<int tag, size_t maxBitSize>
+void invVecF(FpT<tag, maxBitSize> *y, const FpT<tag, maxBitSize> *x, size_t n)
+{
+	FpT<tag, maxBitSize>::invVec(y, x, n);
+}
+
+} // mcl::local
+
 /*
 	recover out = f(0) by { (x, y) | x = S[i], y = f(x) = vec[i] }
 	@retval 0 if succeed else -1
@@ -43,23 +80,26 @@ void LagrangeInterpolation(bool *pb, G& out, const F *S, const G *vec, size_t k)
 	// reduce # of inv
 	// d[i] = S[i] prod_{j!=i}(S[j] - S[i])
 	F *d = (F*)CYBOZU_ALLOCA(sizeof(F) * k);
+	F *v = (F*)CYBOZU_ALLOCA(sizeof(F) * k);
 	for (size_t i = 0; i < k; i++) {
 		d[i] = S[i];
 	}
-	for (size_t i = 0; i < k; i++) {
-		for (size_t j = 0; j < k; j++) {
-			if (j != i) {
-				F v;
-				F::sub(v, S[j], S[i]);
-				if (v.isZero()) {
-					*pb = false;
-					return;
-				}
-				d[i] *= v;
+	for (size_t j = 0; j < k; j++) {
+		// v[i] = S[j] - S[i] for i != j and v[j] = 1
+		for (size_t i = 0; i < k; i++) {
+			if (i == j) {
+				v[i] = 1;
+				continue;
+			}
+			F::sub(v[i], S[j], S[i]);
+			if (v[i].isZero()) {
+				*pb = false;
+				return;
 			}
 		}
+		local::mulVecF(d, d, v, k);
 	}
-	mcl::invVec(d, d, k);
+	local::invVecF(d, d, k);
 	G r;
 	d[0] *= a;
 	G::mul(r, vec[0], d[0]);
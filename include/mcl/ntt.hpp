@@ -1,11 +1,15 @@
 #pragma once
 /**
-	@brief NTT (number theoretic transform) for BLS12-381
+	@brief NTT (number theoretic transform) for Fr
 	@author MITSUNARI Shigeo(@herumi)
 	@license modified new BSD license
 	http://opensource.org/licenses/BSD-3-Clause
 */
 #include <cybozu/inttype.hpp>
+#include <mcl/gmp_util.hpp>
+#ifdef MCL_USE_OMP
+#include <omp.h>
+#endif
 
 namespace mcl {
 
@@ -78,37 +82,91 @@ struct BitReverse {
 	}
 };
 
+/*
+	y[j * n + i] = x[i * m + j] for i < n, j < m
+	x is an n x m matrix and y is an m x n matrix
+	copy by blocks to reduce cache misses
+*/
+template<class T>
+void transpose(T *y, const T *x, size_t n, size_t m)
+{
+	const size_t B = 16;
+	const size_t bn = (n + B - 1) / B;
+#ifdef MCL_USE_OMP
+	#pragma omp parallel for
+#endif
+	for (size_t bi = 0; bi < bn; bi++) {
+		const size_t i0 = bi * B;
+		const size_t i1 = (i0 + B < n) ? i0 + B : n;
+		for (size_t j0 = 0; j0 < m; j0 += B) {
+			const size_t j1 = (j0 + B < m) ? j0 + B : m;
+			for (size_t i = i0; i < i1; i++) {
+				for (size_t j = j0; j < j1; j++) {
+					y[j * n + i] = x[i * m + j];
+				}
+			}
+		}
+	}
+}
+
 } // mcl::local
 
 template<class Fr>
 struct Ntt {
+	// the transform of N <= 2^directMaxBitN is done in place without the four-step method
+	static const size_t directMaxBitN = 16;
+	// the number of butterflies whose multiplications are done at once in nttEc
+	static const size_t ecBlockSize = 256;
+	// the number of radix-4 butterflies done at once by Fr::mulVec, addVec and subVec
+	static const size_t vecBlockSize = 64;
+	// butterfly4Vec is used for L >= vecMinL
+	static const size_t vecMinL = 16;
 	local::BitReverse br_;
-	Fr root_; // (r-1)/(2^32)
+	mpz_class rootP_; // the modulus of Fr for root_
+	size_t maxBitN_; // r - 1 = 2^maxBitN_ q for odd q
+	Fr root_; // primitive 2^maxBitN_-th root of unity
 	Fr w_;
 	Fr invN_;
+	Fr imag_; // w^(N/4) ; primitive 4th root of unity
+	Fr imags_[vecBlockSize]; // copies of imag_ for Fr::mulVec
+	Fr invNs_[vecBlockSize]; // copies of invN_ for Fr::mulVec
 	bool isAllocated_;
 	Fr *ws_; // [N + 1];
+	Fr *tw_; // [getTwSize(N)] ; twiddles of radix-4 butterflies
 	size_t N_;
 	size_t bitN_;
 
 	Ntt()
-		: isAllocated_(false)
+		: maxBitN_(0)
+		, isAllocated_(false)
 		, ws_(0)
+		, tw_(0)
 		, N_(0)
 		, bitN_(0)
 	{
-		// 32 and 5 are for BLS12-381
-#if 1
+	}
+	/*
+		root_ = g^q for a quadratic non-residue g
+		it is computed once for the current Fr and cached
+	*/
+	bool initRoot()
+	{
+		const mpz_class& r = Fr::getOp().mp;
+		if (maxBitN_ > 0 && rootP_ == r) return true;
+		mpz_class q = r - 1;
+		const size_t maxBitN = gmp::getLowerZeroBitNum(q);
+		q >>= maxBitN;
 		bool b;
-		root_.setStr(&b, "212d79e5b416b6f0fd56dc8d168d6c0c4024ff270b3e0941b788f500b912f1f", 16);
-		assert(b); (void)b;
-#else
-		const Fr g = 5; // generator of Fr^*
-		// e=(r-1)/(2^32)
-		Vint e = (Fr::getOp().mp - 1) >> 32;
-		Fr::pow(root_, g, e);
-#endif
+		Fr g;
+		g.setMpz(&b, gmp::getQuadraticNonResidue(r));
+		if (!b) return false;
+		Fr::pow(root_, g, q);
+		maxBitN_ = maxBitN;
+		rootP_ = r;
+		return true;
 	}
+	// N = 2^maxBitN is the max size of the transform
+	size_t getMaxBitN() const { return maxBitN_; }
 	void clean()
 	{
 		if (isAllocated_) {
@@ -126,14 +184,36 @@ struct Ntt {
 	{
 		return N > 1 && (N & (N - 1)) == 0;
 	}
+	/*
+		the max size of the transforms done directly
+		N = N1 N2 where N1 = 2^ceil(bitN/2), N2 = 2^floor(bitN/2) for the four-step method
+	*/
+	static size_t getSubN(size_t N)
+	{
+		const size_t bitN = cybozu::bsr(N);
+		if (bitN <= directMaxBitN) return N;
+		return size_t(1) << ((bitN + 1) / 2);
+	}
+	/*
+		tw_[3(L-1) + kL + j] = w_{4L}^{j(k+1)}
+		for L = 1, 2, 4, ..., getSubN(N)/4, j < L and k < 3
+		where w_{4L} = w^(N/(4L)) is a (4L)-th root of unity
+	*/
+	static size_t getTwSize(size_t N)
+	{
+		const size_t subN = getSubN(N);
+		return subN >= 4 ? 3 * (subN / 2 - 1) : 0;
+	}
 	static size_t requiredByteSize(size_t N)
 	{
-		return sizeof(Fr) * (N + 1);
+		return sizeof(Fr) * (N + 1 + getTwSize(N));
 	}
 	// use malloc if buffer == 0, or buffer must have requiredByteSize(N)
 	bool init(size_t N, void *buffer = 0)
 	{
-		if (!verifyN(N)) return false;
+		if (!verifyN(N) || !initRoot()) return false;
+		const size_t bitN = cybozu::bsr(N);
+		if (bitN > maxBitN_) return false;
 		clean();
 		if (buffer) {
 			ws_ = reinterpret_cast<Fr*>(buffer);
@@ -145,12 +225,30 @@ struct Ntt {
 			isAllocated_ = true;
 		}
 		N_ = N;
-		bitN_ = cybozu::bsr(N);
-		// w = 2^maxBitN-th root of 1
-		Fr w;
-		Fr::pow(w, root_, (int64_t(1) << 32) / N);
+		bitN_ = bitN;
+		// w = root_^(2^maxBitN / N) is a primitive N-th root of unity
+		Fr w = root_;
+		for (size_t i = bitN; i < maxBitN_; i++) {
+			Fr::sqr(w, w);
+		}
 		local::initPowSeq(ws_, w, N + 1);
 		Fr::inv(invN_, N);
+		imag_ = N >= 4 ? ws_[N / 4] : Fr(1);
+		for (size_t i = 0; i < vecBlockSize; i++) {
+			imags_[i] = imag_;
+			invNs_[i] = invN_;
+		}
+		tw_ = ws_ + N + 1;
+		const size_t subN = getSubN(N);
+		for (size_t L = 1; L * 4 <= subN; L *= 2) {
+			Fr *t = tw_ + 3 * (L - 1);
+			const size_t step = N / (L * 4);
+			for (size_t j = 0; j < L; j++) {
+				t[j] = ws_[step * j];
+				t[L + j] = ws_[step * j * 2];
+				t[L * 2 + j] = ws_[step * j * 3];
+			}
+		}
 		return true;
 	}
 	const Fr& getW() const { return ws_[1]; }
@@ -188,6 +286,330 @@ struct Ntt {
 	void ntt(G *xs) const { _ntt(xs, ws_, false); }
 	template<class G>
 	void intt(G *xs) const { _ntt(xs, ws_, true); }
+	/*
+		the same as _ntt(xs, ws_, false) for Fr
+		the four-step method is used for N > 2^directMaxBitN
+		and the sub-transforms are done by multi threads if MCL_USE_OMP is defined
+	*/
+	void ntt(Fr *xs) const
+	{
+		if (bitN_ <= directMaxBitN) {
+			nttDirect(xs, bitN_);
+			return;
+		}
+		Fr *buf = (Fr*)malloc(sizeof(Fr) * N_);
+		if (buf == 0) {
+			_ntt(xs, ws_, false);
+			return;
+		}
+		nttFourStep(xs, buf);
+		free(buf);
+	}
+	/*
+		the same as _ntt(xs, ws_, true) for Fr
+		intt(xs)[k] = ntt(xs)[N-k] / N
+	*/
+	void intt(Fr *xs) const
+	{
+		ntt(xs);
+		const size_t half = N_ / 2;
+		if (Fr::mulVecOpti && N_ >= vecBlockSize) {
+			for (size_t i = 1; i < half; i++) {
+				Fr t = xs[i];
+				xs[i] = xs[N_ - i];
+				xs[N_ - i] = t;
+			}
+#ifdef MCL_USE_OMP
+			#pragma omp parallel for
+#endif
+			for (size_t i = 0; i < N_; i += vecBlockSize) {
+				Fr::mulVec(xs + i, xs + i, invNs_, vecBlockSize);
+			}
+			return;
+		}
+		Fr::mul(xs[0], xs[0], invN_);
+		Fr::mul(xs[half], xs[half], invN_);
+#ifdef MCL_USE_OMP
+		#pragma omp parallel for
+#endif
+		for (size_t i = 1; i < half; i++) {
+			Fr t;
+			Fr::mul(t, xs[i], invN_);
+			Fr::mul(xs[i], xs[N_ - i], invN_);
+			xs[N_ - i] = t;
+		}
+	}
+	/*
+		ntt for each xs + N * j (j < k)
+		the transforms run in parallel for small N and the buffer of the four-step method is shared
+	*/
+	void nttVec(Fr *xs, size_t k) const
+	{
+		if (bitN_ <= directMaxBitN) {
+#ifdef MCL_USE_OMP
+			#pragma omp parallel for
+#endif
+			for (size_t j = 0; j < k; j++) {
+				nttDirect(xs + N_ * j, bitN_);
+			}
+			return;
+		}
+		Fr *buf = (Fr*)malloc(sizeof(Fr) * N_);
+		for (size_t j = 0; j < k; j++) {
+			if (buf == 0) {
+				_ntt(xs + N_ * j, ws_, false);
+			} else {
+				nttFourStep(xs + N_ * j, buf);
+			}
+		}
+		free(buf);
+	}
+	// intt for each xs + N * j (j < k)
+	void inttVec(Fr *xs, size_t k) const
+	{
+		for (size_t j = 0; j < k; j++) {
+			intt(xs + N_ * j);
+		}
+	}
+	/*
+		the same as _ntt(xs, ws_, false) for points of an elliptic curve G
+		the multiplications by twiddles in each layer are done by G::mulEach
+		which uses GLV (and AVX-512 IFMA if available)
+		the output is normalized
+	*/
+	template<class G>
+	void nttEc(G *xs) const { _nttEc(xs, false); }
+	/*
+		the same as _ntt(xs, ws_, true) for points of an elliptic curve G
+		e.g. convert an SRS [tau^i]P in the monomial basis to [L_i(tau)]P in the Lagrange basis
+	*/
+	template<class G>
+	void inttEc(G *xs) const { _nttEc(xs, true); }
+private:
+	/*
+		radix-2 DIT as _ntt
+		the butterflies of a layer are split into blocks of ecBlockSize
+		and the points to be multiplied in a block are gathered for G::mulEach
+		the butterflies with the twiddle 1 (j = 0) need no multiplication
+	*/
+	template<class G>
+	void _nttEc(G *xs, bool inv) const
+	{
+		const size_t N = N_;
+		const size_t half = N / 2;
+		const size_t B = ecBlockSize;
+		const size_t blockN = (half + B - 1) / B;
+		br_.revArray(xs, bitN_);
+		for (size_t L = 1; L < N; L *= 2) {
+			const size_t h = N / (L * 2);
+#ifdef MCL_USE_OMP
+			#pragma omp parallel for
+#endif
+			for (size_t bi = 0; bi < blockN; bi++) {
+				G ts[B];
+				Fr ys[B];
+				const size_t k0 = bi * B;
+				const size_t k1 = (k0 + B < half) ? k0 + B : half;
+				// k-th butterfly is (xs[p], xs[p + L]) for p = (k / L) * 2L + j and j = k % L
+				size_t m = 0;
+				for (size_t k = k0; k < k1; k++) {
+					const size_t j = k & (L - 1);
+					if (j == 0) continue;
+					const size_t p = (k - j) * 2 + j;
+					ts[m] = xs[p + L];
+					ys[m] = ws_[inv ? N - j * h : j * h];
+					m++;
+				}
+				G::mulEach(ts, ys, m);
+				m = 0;
+				for (size_t k = k0; k < k1; k++) {
+					const size_t j = k & (L - 1);
+					const size_t p = (k - j) * 2 + j;
+					const G& t = (j == 0) ? xs[p + L] : ts[m++];
+					G u;
+					G::sub(u, xs[p], t);
+					G::add(xs[p], xs[p], t);
+					xs[p + L] = u;
+				}
+			}
+		}
+		const size_t allN = (N + B - 1) / B;
+#ifdef MCL_USE_OMP
+		#pragma omp parallel for
+#endif
+		for (size_t bi = 0; bi < allN; bi++) {
+			const size_t k0 = bi * B;
+			const size_t n = (k0 + B < N) ? B : N - k0;
+			if (inv) {
+				Fr ys[B];
+				for (size_t i = 0; i < n; i++) {
+					ys[i] = invN_;
+				}
+				G::mulEach(xs + k0, ys, n);
+			}
+			G::normalizeVec(xs + k0, xs + k0, n);
+		}
+	}
+	/*
+		butterflies of two layers of DIF for p[j + L * k] (j < L, k < 4)
+		t : twiddles for L
+		(a, b, c, d) = (p0 + p2, p1 + p3, p0 - p2, (p1 - p3) i)
+		(p0, p1, p2, p3) = (a + b, (a - b) w^2j, (c + d) w^j, (c - d) w^3j)
+	*/
+	void butterfly4(Fr *p, const Fr *t, size_t L) const
+	{
+		Fr *q = p + L;
+		Fr *r = p + L * 2;
+		Fr *s = p + L * 3;
+		for (size_t j = 0; j < L; j++) {
+			Fr a, b, c, d;
+			Fr::add(a, p[j], r[j]);
+			Fr::sub(c, p[j], r[j]);
+			Fr::add(b, q[j], s[j]);
+			Fr::sub(d, q[j], s[j]);
+			Fr::mul(d, d, imag_);
+			Fr::add(p[j], a, b);
+			Fr::sub(q[j], a, b);
+			Fr::add(r[j], c, d);
+			Fr::sub(s[j], c, d);
+			if (j == 0) continue;
+			Fr::mul(q[j], q[j], t[L + j]);
+			Fr::mul(r[j], r[j], t[j]);
+			Fr::mul(s[j], s[j], t[L * 2 + j]);
+		}
+	}
+	/*
+		the same as butterfly4 by Fr::mulVec, addVec and subVec
+		L must be a power of two and L >= vecMinL
+	*/
+	void butterfly4Vec(Fr *p, const Fr *t, size_t L) const
+	{
+		const size_t B = L < vecBlockSize ? L : vecBlockSize;
+		Fr *q = p + L;
+		Fr *r = p + L * 2;
+		Fr *s = p + L * 3;
+		Fr a[vecBlockSize], b[vecBlockSize], c[vecBlockSize], d[vecBlockSize];
+		for (size_t j = 0; j < L; j += B) {
+			Fr::addVec(a, p + j, r + j, B);
+			Fr::subVec(c, p + j, r + j, B);
+			Fr::addVec(b, q + j, s + j, B);
+			Fr::subVec(d, q + j, s + j, B);
+			Fr::mulVec(d, d, imags_, B);
+			Fr::addVec(p + j, a, b, B);
+			Fr::subVec(q + j, a, b, B);
+			Fr::addVec(r + j, c, d, B);
+			Fr::subVec(s + j, c, d, B);
+			Fr::mulVec(q + j, q + j, t + L + j, B);
+			Fr::mulVec(r + j, r + j, t + j, B);
+			Fr::mulVec(s + j, s + j, t + L * 2 + j, B);
+		}
+	}
+	/*
+		in-place DIF of size M = 2^bitM with radix-4 butterflies
+		the input is in the natural order and the output is in the bit-reversed order
+	*/
+	void difRadix4(Fr *x, size_t bitM) const
+	{
+		const size_t M = size_t(1) << bitM;
+		size_t L = M / 4;
+		for (; L > 1; L /= 4) {
+			const Fr *t = tw_ + 3 * (L - 1);
+			// use the array operations if they are optimized
+			const bool useVec = Fr::mulVecOpti != 0 && L >= vecMinL;
+			for (size_t i = 0; i < M; i += L * 4) {
+				if (useVec) {
+					butterfly4Vec(x + i, t, L);
+				} else {
+					butterfly4(x + i, t, L);
+				}
+			}
+		}
+		if (L == 1) {
+			for (size_t i = 0; i < M; i += 4) {
+				butterfly4(x + i, 0, 1);
+			}
+		} else {
+			// the last layer of radix-2 if bitM is odd
+			for (size_t i = 0; i < M; i += 2) {
+				Fr t;
+				Fr::sub(t, x[i], x[i + 1]);
+				Fr::add(x[i], x[i], x[i + 1]);
+				x[i + 1] = t;
+			}
+		}
+	}
+	// x[k] = sum_j x[j] w_M^(jk) for M = 2^bitM
+	void nttDirect(Fr *x, size_t bitM) const
+	{
+		difRadix4(x, bitM);
+		br_.revArray(x, bitM);
+	}
+	/*
+		x[k] *= u^k for k < n
+		u^(k + B) = u^k u^B are computed by Fr::mulVec for blocks of B = vecBlockSize
+	*/
+	void mulPowSeq(Fr *x, size_t n, const Fr& u) const
+	{
+		const size_t B = vecBlockSize;
+		if (Fr::mulVecOpti == 0 || n % B != 0) {
+			Fr t = u;
+			for (size_t k = 1; k < n; k++) {
+				Fr::mul(x[k], x[k], t);
+				Fr::mul(t, t, u);
+			}
+			return;
+		}
+		Fr t[B], uB[B];
+		local::initPowSeq(t, u, B);
+		Fr::mul(uB[0], t[B - 1], u);
+		for (size_t i = 1; i < B; i++) {
+			uB[i] = uB[0];
+		}
+		for (size_t k = 0; k < n; k += B) {
+			if (k > 0) Fr::mulVec(t, t, uB, B);
+			Fr::mulVec(x + k, x + k, t, B);
+		}
+	}
+	/*
+		four-step method for N = N1 N2 with a buffer buf[N]
+		X[k1 + N1 k2] = sum_{j2} w_N2^(j2 k2) w^(j2 k1) sum_{j1} w_N1^(j1 k1) x[j1 N2 + j2]
+		1. transpose x to buf as an N1 x N2 matrix
+		2. NTT of size N1 for each row of buf and multiply w^(j2 k1)
+		3. transpose buf to x
+		4. NTT of size N2 for each row of x
+		5. transpose x to buf and copy buf to x
+	*/
+	void nttFourStep(Fr *x, Fr *buf) const
+	{
+		const size_t bitN1 = (bitN_ + 1) / 2;
+		const size_t bitN2 = bitN_ - bitN1;
+		const size_t N1 = size_t(1) << bitN1;
+		const size_t N2 = size_t(1) << bitN2;
+		local::transpose(buf, x, N1, N2);
+#ifdef MCL_USE_OMP
+		#pragma omp parallel for
+#endif
+		for (size_t j2 = 0; j2 < N2; j2++) {
+			Fr *row = buf + j2 * N1;
+			nttDirect(row, bitN1);
+			if (j2 == 0) continue;
+			mulPowSeq(row, N1, ws_[j2]);
+		}
+		local::transpose(x, buf, N2, N1);
+#ifdef MCL_USE_OMP
+		#pragma omp parallel for
+#endif
+		for (size_t k1 = 0; k1 < N1; k1++) {
+			nttDirect(x + k1 * N2, bitN2);
+		}
+		local::transpose(buf, x, N1, N2);
+#ifdef MCL_USE_OMP
+		#pragma omp parallel for
+#endif
+		for (size_t i = 0; i < N_; i++) {
+			x[i] = buf[i];
+		}
+	}
 };
 
 } // mcl
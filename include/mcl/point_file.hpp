@@ -0,0 +1,183 @@
+#pragma once
+/**
+	@file
+	@brief save/load an array of points in the raw format with mmap
+	@author MITSUNARI Shigeo(@herumi)
+	@license modified new BSD license
+	http://opensource.org/licenses/BSD-3-Clause
+*/
+#include <mcl/bn.hpp>
+#include <cybozu/mmap.hpp>
+#include <cybozu/file.hpp>
+#include <cybozu/hash.hpp>
+#include <vector>
+
+namespace mcl {
+
+/*
+	file format
+	PointFileHeader (64 bytes) + n * sizeof(G) bytes of G[n]
+	each point is an element of G in memory (Montgomery form) and normalized (z = 1 or 0)
+	so the mapped area is used as G[n] without any conversion
+	@note the format depends on the curve, MCL_MAX_FP_BIT_SIZE and the endianness
+*/
+struct PointFileHeader {
+	char magic[8];
+	uint32_t curveType;
+	uint32_t group; // 1 : G1, 2 : G2
+	uint32_t pointSize; // sizeof(G)
+	uint32_t reserved;
+	uint64_t n;
+	uint64_t checksum; // getPointFileChecksum of G[n]
+	char pad[24];
+};
+
+namespace local {
+
+static const char pointFileMagic[8] = { 'm', 'c', 'l', 'p', 'o', 'i', 'n', 't' };
+
+template<class G>
+struct PointFileGroup {
+	static uint32_t get() { return sizeof(G) == sizeof(G1) ? 1 : 2; }
+};
+
+/*
+	checksum of buf[0:size]
+	hash64 of hash64 of each block, so the blocks can be hashed in parallel
+	size should be a multiple of 8
+*/
+inline uint64_t getPointFileChecksum(const void *buf, size_t size, size_t cpuN = 0)
+{
+	const size_t blockSize = 1024 * 1024;
+	const uint64_t *p = (const uint64_t*)buf;
+	const size_t w = size / 8;
+	const size_t blockW = blockSize / 8;
+	const size_t blockN = (w + blockW - 1) / blockW;
+	std::vector<uint64_t> h(blockN);
+#ifdef MCL_USE_OMP
+	if (cpuN == 0) cpuN = omp_get_num_procs();
+	#pragma omp parallel for num_threads(int(cpuN))
+	for (int i = 0; i < int(blockN); i++) {
+		const size_t begin = i * blockW;
+		const size_t end = fp::min_(begin + blockW, w);
+		h[i] = cybozu::hash64(p + begin, p + end);
+	}
+#else
+	(void)cpuN;
+	for (size_t i = 0; i < blockN; i++) {
+		const size_t begin = i * blockW;
+		const size_t end = fp::min_(begin + blockW, w);
+		h[i] = cybozu::hash64(p + begin, p + end);
+	}
+#endif
+	return cybozu::hash64(h.data(), h.size());
+}
+
+// the coordinates are less than p, P is normalized, on the curve and in the subgroup
+template<class G>
+bool isValidPointInFile(const G& P)
+{
+	const Fp *v = (const Fp*)&P;
+	for (size_t i = 0; i < sizeof(G) / sizeof(Fp); i++) {
+		if (!v[i].isValid()) return false;
+	}
+	if (P.z.isZero()) return true;
+	if (!P.z.isOne()) return false;
+	return ec::isValidJacobi(P) && P.isValidOrder();
+}
+
+} // mcl::local
+
+/*
+	save xVec[0:n] to fileName in the format of PointFileT
+*/
+template<class G>
+void savePointFile(const std::string& fileName, const G *xVec, size_t n)
+{
+	PointFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, local::pointFileMagic, sizeof(header.magic));
+	header.curveType = uint32_t(getCurveType());
+	header.group = local::PointFileGroup<G>::get();
+	header.pointSize = uint32_t(sizeof(G));
+	header.n = n;
+	std::vector<G> tbl(xVec, xVec + n);
+	G::normalizeVec(tbl.data(), tbl.data(), n);
+	for (size_t i = 0; i < n; i++) {
+		// [x:y:0] -> [0:0:0] to make the content unique
+		if (tbl[i].isZero()) tbl[i].clear();
+	}
+	header.checksum = local::getPointFileChecksum(tbl.data(), sizeof(G) * n);
+	cybozu::File f(fileName, std::ios::out | std::ios::trunc);
+	f.write(&header, sizeof(header));
+	f.write(tbl.data(), sizeof(G) * n);
+}
+
+/*
+	map a file made by savePointFile into memory
+	data() can be passed to mulVec and mulVecFixedBase without copying
+	(the file is mapped in the copy-on-write mode because mulVec takes G*,
+	but the normalized points are not written)
+*/
+template<class G>
+class PointFileT {
+	cybozu::Mmap map_;
+	G *p_;
+	size_t n_;
+	PointFileT(const PointFileT&);
+	void operator=(const PointFileT&);
+public:
+	/*
+		throw exception if the header is broken
+		verifyChecksum : verify the checksum of the points (cpuN threads are used)
+	*/
+	explicit PointFileT(const std::string& fileName, bool verifyChecksum = true, size_t cpuN = 0)
+		: map_(fileName, cybozu::Mmap::CopyOnWrite)
+		, p_(0)
+		, n_(0)
+	{
+		if (map_.size() < sizeof(PointFileHeader)) throw cybozu::Exception("PointFile:too small") << fileName;
+		const PointFileHeader *header = (const PointFileHeader*)map_.get();
+		if (memcmp(header->magic, local::pointFileMagic, sizeof(header->magic)) != 0) throw cybozu::Exception("PointFile:bad magic") << fileName;
+		if (header->curveType != uint32_t(getCurveType())) throw cybozu::Exception("PointFile:bad curveType") << fileName << header->curveType;
+		if (header->group != local::PointFileGroup<G>::get()) throw cybozu::Exception("PointFile:bad group") << fileName << header->group;
+		if (header->pointSize != sizeof(G)) throw cybozu::Exception("PointFile:bad pointSize") << fileName << header->pointSize;
+		if (header->n > (map_.size() - sizeof(PointFileHeader)) / sizeof(G)) throw cybozu::Exception("PointFile:bad n") << fileName << header->n;
+		p_ = (G*)(map_.get() + sizeof(PointFileHeader));
+		n_ = size_t(header->n);
+		if (verifyChecksum && local::getPointFileChecksum(p_, sizeof(G) * n_, cpuN) != header->checksum) {
+			throw cybozu::Exception("PointFile:bad checksum") << fileName;
+		}
+	}
+	size_t size() const { return n_; }
+	const G *data() const { return p_; }
+	G *data() { return p_; }
+	const G& operator[](size_t i) const { return p_[i]; }
+	/*
+		verify that all points are normalized, on the curve and in the subgroup
+		with cpuN threads (if MCL_USE_OMP is defined)
+		the num of thread is automatically detected if cpuN = 0
+	*/
+	bool isValid(size_t cpuN = 0) const
+	{
+		bool ok = true;
+#ifdef MCL_USE_OMP
+		if (cpuN == 0) cpuN = omp_get_num_procs();
+		#pragma omp parallel for num_threads(int(cpuN)) reduction(&&:ok)
+		for (size_t i = 0; i < n_; i++) {
+			ok = ok && local::isValidPointInFile(p_[i]);
+		}
+#else
+		(void)cpuN;
+		for (size_t i = 0; i < n_; i++) {
+			if (!local::isValidPointInFile(p_[i])) return false;
+		}
+#endif
+		return ok;
+	}
+};
+
+typedef PointFileT<G1> PointFileG1;
+typedef PointFileT<G2> PointFileG2;
+
+} // mcl
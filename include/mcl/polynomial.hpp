@@ -0,0 +1,256 @@
+#pragma once
+/**
+	@file
+	@brief polynomial operations with NTT
+	@author MITSUNARI Shigeo(@herumi)
+	@license modified new BSD license
+	http://opensource.org/licenses/BSD-3-Clause
+*/
+#include <mcl/ntt.hpp>
+#include <mcl/operator.hpp>
+
+namespace mcl {
+
+/*
+	operations of polynomials f(X) = sum_{i<N} f[i] X^i over Fr with Ntt of size N
+	H = { w^k | k < N } is the domain of Ntt and gH = { g w^k | k < N } is its coset
+	the tables of Ntt are shared, so ntt must be alive while this object is used
+*/
+template<class Fr>
+struct Polynomial {
+	const Ntt<Fr> *ntt_;
+	Fr g_; // generator of the coset
+	bool isAllocated_;
+	Fr *gs_; // [N] ; g^i
+	Fr *invGs_; // [N] ; g^(-i) / N
+	size_t N_;
+
+	Polynomial()
+		: ntt_(0)
+		, isAllocated_(false)
+		, gs_(0)
+		, invGs_(0)
+		, N_(0)
+	{
+	}
+	void clean()
+	{
+		if (isAllocated_) {
+			free(gs_);
+			gs_ = 0;
+			invGs_ = 0;
+			isAllocated_ = false;
+		}
+	}
+	~Polynomial()
+	{
+		clean();
+	}
+	static size_t requiredByteSize(size_t N)
+	{
+		return sizeof(Fr) * N * 2;
+	}
+	/*
+		ntt must be initialized
+		g^N != 1 is necessary so that gH and H are disjoint
+		the default 7 is a generator of Fr^* for BLS12-381 and return false if g^N = 1
+		use malloc if buffer == 0, or buffer must have requiredByteSize(N)
+	*/
+	bool init(const Ntt<Fr>& ntt, const Fr& g = 7, void *buffer = 0)
+	{
+		const size_t N = ntt.N_;
+		if (N == 0 || g.isZero()) return false;
+		Fr t;
+		Fr::pow(t, g, N);
+		if (t.isOne()) return false;
+		clean();
+		if (buffer) {
+			gs_ = reinterpret_cast<Fr*>(buffer);
+		} else {
+			gs_ = (Fr*)malloc(requiredByteSize(N));
+			if (gs_ == 0) {
+				return false;
+			}
+			isAllocated_ = true;
+		}
+		invGs_ = gs_ + N;
+		ntt_ = &ntt;
+		g_ = g;
+		N_ = N;
+		local::initPowSeq(gs_, g, N);
+		Fr::inv(t, g);
+		local::initPowSeq(invGs_, t, N);
+		for (size_t i = 0; i < N; i++) {
+			Fr::mul(invGs_[i], invGs_[i], ntt.invN_);
+		}
+		return true;
+	}
+	size_t getN() const { return N_; }
+	const Fr& getG() const { return g_; }
+	/*
+		xs[k] = f(g w^k) for k < N where f[i] = xs[i]
+	*/
+	void cosetNtt(Fr *xs) const
+	{
+		mulEach(xs, gs_, N_);
+		ntt_->ntt(xs);
+	}
+	// inverse of cosetNtt
+	void cosetIntt(Fr *xs) const
+	{
+		ntt_->ntt(xs);
+		revMulEach(xs);
+	}
+	// cosetNtt for each xs + N * j (j < k)
+	void cosetNttVec(Fr *xs, size_t k) const
+	{
+		for (size_t j = 0; j < k; j++) {
+			mulEach(xs + N_ * j, gs_, N_);
+		}
+		ntt_->nttVec(xs, k);
+	}
+	// cosetIntt for each xs + N * j (j < k)
+	void cosetInttVec(Fr *xs, size_t k) const
+	{
+		const size_t N = N_;
+		ntt_->nttVec(xs, k);
+#ifdef MCL_USE_OMP
+		#pragma omp parallel for
+#endif
+		for (size_t j = 0; j < k; j++) {
+			revMulEach(xs + N * j);
+		}
+	}
+	/*
+		out[k] = f(g w^k) for k < N where f[i] = c[i] for i < cn
+		out[k] = f(w^k) if coset is false
+		f is typically given on a smaller domain and H (or gH) is the extended domain
+	*/
+	bool evalExtended(Fr *out, const Fr *c, size_t cn, bool coset = true) const
+	{
+		if (cn > N_) return false;
+		for (size_t i = 0; i < cn; i++) {
+			out[i] = c[i];
+		}
+		for (size_t i = cn; i < N_; i++) {
+			out[i].clear();
+		}
+		if (coset) mulEach(out, gs_, cn);
+		ntt_->ntt(out);
+		return true;
+	}
+	/*
+		z = x * y where x has xn coefficients and y has yn ones
+		z has xn + yn - 1 coefficients and xn + yn - 1 <= N is necessary
+	*/
+	bool mul(Fr *z, const Fr *x, size_t xn, const Fr *y, size_t yn) const
+	{
+		if (xn == 0 || yn == 0 || xn + yn - 1 > N_) return false;
+		const size_t N = N_;
+		Fr *buf = (Fr*)malloc(sizeof(Fr) * N * 2);
+		if (buf == 0) return false;
+		Fr *a = buf;
+		Fr *b = buf + N;
+		for (size_t i = 0; i < N; i++) {
+			if (i < xn) { a[i] = x[i]; } else { a[i].clear(); }
+			if (i < yn) { b[i] = y[i]; } else { b[i].clear(); }
+		}
+		ntt_->nttVec(buf, 2);
+		mulEach(a, b, N);
+		ntt_->intt(a);
+		for (size_t i = 0; i < xn + yn - 1; i++) {
+			z[i] = a[i];
+		}
+		free(buf);
+		return true;
+	}
+	/*
+		q = f / (X^n - 1) where f has fn coefficients
+		q has fn - n coefficients if fn > n
+		return false if f is not divisible by X^n - 1
+		q must not overlap f
+	*/
+	static bool divByVanishing(Fr *q, const Fr *f, size_t fn, size_t n)
+	{
+		if (n == 0) return false;
+		const size_t qn = fn > n ? fn - n : 0;
+		// f[i] = q[i - n] - q[i] then q[i - n] = f[i] + q[i]
+		for (size_t i = fn; i > n;) {
+			i--;
+			if (i < qn) {
+				Fr::add(q[i - n], f[i], q[i]);
+			} else {
+				q[i - n] = f[i];
+			}
+		}
+		// the remainder f[i] + q[i] for i < n must be zero
+		for (size_t i = 0; i < n && i < fn; i++) {
+			Fr r = f[i];
+			if (i < qn) r += q[i];
+			if (!r.isZero()) return false;
+		}
+		return true;
+	}
+	/*
+		evals[k] /= Z(g w^k) for k < N where Z(X) = X^n - 1
+		n must be a power of two and divide N
+		Z(g w^k) = g^n w^(kn) - 1 takes N/n values which are nonzero because g^N != 1
+	*/
+	bool divByVanishingOnCoset(Fr *evals, size_t n) const
+	{
+		if (n == 0 || n > N_ || (n & (n - 1)) != 0) return false;
+		const size_t m = N_ / n;
+		Fr *z = (Fr*)malloc(sizeof(Fr) * m);
+		if (z == 0) return false;
+		Fr gn;
+		Fr::pow(gn, g_, n);
+		const Fr *ws = ntt_->getWs();
+		for (size_t k = 0; k < m; k++) {
+			Fr::mul(z[k], gn, ws[k * n]);
+			z[k] -= Fr::one();
+		}
+		Fr::invVec(z, z, m);
+		if (m >= 8) {
+#ifdef MCL_USE_OMP
+			#pragma omp parallel for
+#endif
+			for (size_t k = 0; k < N_; k += m) {
+				Fr::mulVec(evals + k, evals + k, z, m);
+			}
+		} else {
+#ifdef MCL_USE_OMP
+			#pragma omp parallel for
+#endif
+			for (size_t k = 0; k < N_; k++) {
+				Fr::mul(evals[k], evals[k], z[k & (m - 1)]);
+			}
+		}
+		free(z);
+		return true;
+	}
+private:
+	// xs[i] *= c[i] for i < n by Fr::mulVec for blocks
+	static void mulEach(Fr *xs, const Fr *c, size_t n)
+	{
+		const size_t B = 1024;
+#ifdef MCL_USE_OMP
+		#pragma omp parallel for
+#endif
+		for (size_t i = 0; i < n; i += B) {
+			Fr::mulVec(xs + i, xs + i, c + i, n - i < B ? n - i : B);
+		}
+	}
+	// xs[i] = xs[-i mod N] invGs_[i] for i < N
+	void revMulEach(Fr *xs) const
+	{
+		const size_t N = N_;
+		for (size_t i = 1; i < N / 2; i++) {
+			Fr t = xs[i];
+			xs[i] = xs[N - i];
+			xs[N - i] = t;
+		}
+		mulEach(xs, invGs_, N);
+	}
+};
+
+} // mcl
@@ -160,6 +160,22 @@ MCLSHE_DLL_API mclSize sheLoadTableForG1DLP(const void *buf, mclSize bufSize);
 MCLSHE_DLL_API mclSize sheLoadTableForG2DLP(const void *buf, mclSize bufSize);
 MCLSHE_DLL_API mclSize sheLoadTableForGTDLP(const void *buf, mclSize bufSize);
 
+/*
+	use the table in the file made by sheSaveTableFileFor*DLP in place by mmap
+	the mapped table is shared with other processes
+	return 0 if success
+*/
+MCLSHE_DLL_API int sheMapTableForG1DLP(const char *path);
+MCLSHE_DLL_API int sheMapTableForG2DLP(const char *path);
+MCLSHE_DLL_API int sheMapTableForGTDLP(const char *path);
+/*
+	save table for DLP to the file for sheMapTableFor*DLP
+	return 0 if success
+*/
+MCLSHE_DLL_API int sheSaveTableFileForG1DLP(const char *path);
+MCLSHE_DLL_API int sheSaveTableFileForG2DLP(const char *path);
+MCLSHE_DLL_API int sheSaveTableFileForGTDLP(const char *path);
+
 /*
 	get table size for DLP
 */
@@ -182,6 +198,17 @@ MCLSHE_DLL_API int sheEncGT(sheCipherTextGT *c, const shePublicKey *pub, mclInt
 MCLSHE_DLL_API int shePrecomputedPublicKeyEncG1(sheCipherTextG1 *c, const shePrecomputedPublicKey *ppub, mclInt m);
 MCLSHE_DLL_API int shePrecomputedPublicKeyEncG2(sheCipherTextG2 *c, const shePrecomputedPublicKey *ppub, mclInt m);
 MCLSHE_DLL_API int shePrecomputedPublicKeyEncGT(sheCipherTextGT *c, const shePrecomputedPublicKey *ppub, mclInt m);
+/*
+	encrypt m[i] and set c[i] for i in [0, n)
+	faster than calling sheEncG1 n times
+	return 0 if success
+*/
+MCLSHE_DLL_API int sheEncG1Vec(sheCipherTextG1 *c, const shePublicKey *pub, const mclInt *m, mclSize n);
+MCLSHE_DLL_API int sheEncG2Vec(sheCipherTextG2 *c, const shePublicKey *pub, const mclInt *m, mclSize n);
+MCLSHE_DLL_API int sheEncGTVec(sheCipherTextGT *c, const shePublicKey *pub, const mclInt *m, mclSize n);
+MCLSHE_DLL_API int shePrecomputedPublicKeyEncG1Vec(sheCipherTextG1 *c, const shePrecomputedPublicKey *ppub, const mclInt *m, mclSize n);
+MCLSHE_DLL_API int shePrecomputedPublicKeyEncG2Vec(sheCipherTextG2 *c, const shePrecomputedPublicKey *ppub, const mclInt *m, mclSize n);
+MCLSHE_DLL_API int shePrecomputedPublicKeyEncGTVec(sheCipherTextGT *c, const shePrecomputedPublicKey *ppub, const mclInt *m, mclSize n);
 
 /*
 	enc large integer
@@ -239,6 +266,14 @@ MCLSHE_DLL_API int sheDecWithZkpDecGT(mclInt *m, sheZkpDecGT *zkp, const sheSecr
 MCLSHE_DLL_API int sheDecG1(mclInt *m, const sheSecretKey *sec, const sheCipherTextG1 *c);
 MCLSHE_DLL_API int sheDecG2(mclInt *m, const sheSecretKey *sec, const sheCipherTextG2 *c);
 MCLSHE_DLL_API int sheDecGT(mclInt *m, const sheSecretKey *sec, const sheCipherTextGT *c);
+/*
+	decode c[i] and set m[i] for i in [0, n)
+	faster than calling sheDecG1 n times
+	return 0 if all of c[i] are decoded
+*/
+MCLSHE_DLL_API int sheDecG1Vec(mclInt *m, const sheSecretKey *sec, const sheCipherTextG1 *c, mclSize n);
+MCLSHE_DLL_API int sheDecG2Vec(mclInt *m, const sheSecretKey *sec, const sheCipherTextG2 *c, mclSize n);
+MCLSHE_DLL_API int sheDecGTVec(mclInt *m, const sheSecretKey *sec, const sheCipherTextGT *c, mclSize n);
 /*
 	verify zkp
 	return 1 if valid
@@ -310,6 +345,14 @@ MCLSHE_DLL_API int sheMul(sheCipherTextGT *z, const sheCipherTextG1 *x, const sh
 */
 MCLSHE_DLL_API int sheMulML(sheCipherTextGT *z, const sheCipherTextG1 *x, const sheCipherTextG2 *y);
 MCLSHE_DLL_API int sheFinalExpGT(sheCipherTextGT *y, const sheCipherTextGT *x);
+/*
+	z = sum_{i=0}^{n-1} x[i] * y[i]
+	faster than calling sheMul and sheAddGT n times
+	sheMulVecMT uses cpuN threads (the num of CPUs if cpuN = 0)
+	return 0 if success
+*/
+MCLSHE_DLL_API int sheMulVec(sheCipherTextGT *z, const sheCipherTextG1 *x, const sheCipherTextG2 *y, mclSize n);
+MCLSHE_DLL_API int sheMulVecMT(sheCipherTextGT *z, const sheCipherTextG1 *x, const sheCipherTextG2 *y, mclSize n, mclSize cpuN);
 
 // return 0 if success
 // rerandomize(c)
@@ -10,6 +10,7 @@
 #include <cmath>
 #include <vector>
 #include <iosfwd>
+#include <fstream>
 
 #include <mcl/bn.hpp>
 
@@ -17,6 +18,8 @@
 #include <cybozu/endian.hpp>
 #include <cybozu/serializer.hpp>
 #include <cybozu/sha2.hpp>
+#include <cybozu/mmap.hpp>
+#include <cybozu/hash.hpp>
 #include <mcl/ecparam.hpp>
 
 namespace mcl { namespace she {
@@ -31,6 +34,18 @@ namespace local {
 static const size_t winSize = MCLSHE_WIN_SIZE;
 static const size_t defaultHashSize = 1024;
 static const size_t defaultTryNum = 1;
+// the num of entries made at once in HashTable::init
+static const size_t initBlockSize = 1024;
+// the max num of ranges of buckets filled in parallel in HashTable::init
+static const size_t initPartNum = 1024;
+// the max num of entries moved to insert an entry into HashTable
+static const size_t maxKickNum = 1024;
+// the num of bytes read at once in HashTable::load
+static const size_t loadBlockSize = 1024 * 1024;
+// the num of ciphertexts normalized and summed at once in sumVec
+static const size_t sumVecBlockSize = 1024;
+// the num of pairs of ciphertexts passed to millerLoopVec at once in CipherTextGT::mulVec
+static const size_t mulVecBlockSize = 1024;
 
 struct KeyCount {
 	uint32_t key;
@@ -45,6 +60,296 @@ struct KeyCount {
 	}
 };
 
+/*
+	a bucket of the cuckoo hash table in HashTable
+	the size is equal to a cache line
+	count = 0 means an empty slot
+*/
+struct KeyCountBucket {
+	static const size_t N = 8;
+	KeyCount kc[N];
+	bool isSame(const KeyCountBucket& rhs) const
+	{
+		for (size_t i = 0; i < N; i++) {
+			if (!kc[i].isSame(rhs.kc[i])) return false;
+		}
+		return true;
+	}
+};
+
+// the lower 64 bits of x
+inline uint64_t getHash64(const Unit *x)
+{
+#if MCL_SIZEOF_UNIT == 8
+	return x[0];
+#else
+	return x[0] | (uint64_t(x[1]) << 32);
+#endif
+}
+
+/*
+	header of a file made by HashTable::saveMapFile (64 bytes)
+	the buckets follow the header, so they are aligned to 64 bytes in the mapped area
+	@note the format depends on the endianness
+*/
+struct HashTableFileHeader {
+	char magic[8];
+	uint32_t curveType;
+	uint32_t group; // GtoChar
+	uint32_t bucketSize; // sizeof(KeyCountBucket)
+	uint32_t version; // the version of save/load of HashTable
+	uint64_t hashSize;
+	uint64_t bucketNum;
+	uint64_t hashOfP; // getHashOfPoint(P)
+	char pad[16];
+};
+
+static const char hashTableFileMagic[8] = { 'm', 'c', 'l', 's', 'h', 'e', 't', 'b' };
+
+// hash of the serialized P
+template<class G>
+uint64_t getHashOfPoint(const G& P)
+{
+	uint8_t buf[sizeof(G) * 2];
+	const size_t n = P.serialize(buf, sizeof(buf));
+	if (n == 0) throw cybozu::Exception("she:getHashOfPoint:serialize");
+	return cybozu::hash64(buf, n);
+}
+
+/*
+	x[i] = random value for i = 0, ..., n-1
+	read random bytes for many elements at once
+*/
+inline void setRandVec(Fr *x, size_t n)
+{
+	const size_t N = 64;
+	const size_t byteSize = Fr::getOp().N * sizeof(Unit);
+	uint8_t *buf = (uint8_t*)CYBOZU_ALLOCA(byteSize * N);
+	fp::RandGen& rg = fp::RandGen::get();
+	while (n > 0) {
+		const size_t doneN = (n < N) ? n : N;
+		bool b;
+		rg.read(&b, buf, byteSize * doneN);
+		if (!b) throw cybozu::Exception("she:setRandVec:read") << doneN;
+		for (size_t i = 0; i < doneN; i++) {
+			x[i].setArrayMask(buf + byteSize * i, byteSize);
+		}
+		x += doneN;
+		n -= doneN;
+	}
+}
+
+// w bits of x[0, n) from the pos-th bit
+inline Unit getBitsAt(const Unit *x, size_t n, size_t pos, size_t w)
+{
+	const size_t q = pos / UnitBitSize;
+	const size_t r = pos % UnitBitSize;
+	if (q >= n) return 0;
+	Unit v = x[q] >> r;
+	if (r + w > UnitBitSize && q + 1 < n) {
+		v |= x[q + 1] << (UnitBitSize - r);
+	}
+	return v & ((Unit(1) << w) - 1);
+}
+
+/*
+	P[i] += y[i] B for i = 0, ..., n-1
+	wm : the window table of B
+	y[i] = neg[i] ? -|y[i]| : |y[i]| where |y[i]| = y[i * yn, (i + 1) * yn)
+	neg may be null for nonnegative y[i]
+	P[i] must be zero or normalized, and P[i] is normalized or zero after the call
+	the additions in each window are done in the affine coordinates
+	and share an inversion among all P[i]
+*/
+template<class G, class Ec>
+void addMulVecByWindowMethod(G *P, const mcl::fp::WindowMethod<Ec>& wm, const Unit *y, size_t yn, const uint8_t *neg, size_t n)
+{
+	typedef typename G::Fp F;
+	const size_t N = 256;
+	const size_t w = wm.winSize_;
+	const size_t tblNum = wm.tbl_.size() >> w;
+	const size_t winNum = (yn * UnitBitSize + w - 1) / w;
+	F *d = (F*)CYBOZU_ALLOCA(sizeof(F) * N);
+	uint32_t *idx = (uint32_t*)CYBOZU_ALLOCA(sizeof(uint32_t) * N);
+	const G **Q = (const G**)CYBOZU_ALLOCA(sizeof(const G*) * N);
+	while (n > 0) {
+		const size_t doneN = (n < N) ? n : N;
+		for (size_t k = 0; k < winNum; k++) {
+			size_t m = 0;
+			for (size_t i = 0; i < doneN; i++) {
+				const Unit v = getBitsAt(y + yn * i, yn, k * w, w);
+				if (v == 0) continue;
+				if (k >= tblNum) throw cybozu::Exception("she:addMulVecByWindowMethod:too large y") << i;
+				const G& B = static_cast<const G&>(wm.tbl_[(k << w) + v]);
+				const bool isNeg = neg && neg[i];
+				if (P[i].isZero()) {
+					if (isNeg) {
+						G::neg(P[i], B);
+					} else {
+						P[i] = B;
+					}
+					continue;
+				}
+				if (P[i].x == B.x) {
+					// P[i] = +-B is rare
+					G T;
+					if (isNeg) {
+						G::neg(T, B);
+					} else {
+						T = B;
+					}
+					mcl::ec::addAffine(P[i], P[i], T);
+					continue;
+				}
+				F::sub(d[m], B.x, P[i].x);
+				idx[m] = uint32_t(i);
+				Q[m] = &B;
+				m++;
+			}
+			if (m == 0) continue;
+			mcl::invVecT<F>(d, d, m, N);
+			for (size_t j = 0; j < m; j++) {
+				G& R = P[idx[j]];
+				const G& B = *Q[j];
+				F t, x3;
+				// t = (B.y - R.y) / (B.x - R.x)
+				if (neg && neg[idx[j]]) {
+					F::add(t, B.y, R.y);
+					F::neg(t, t);
+				} else {
+					F::sub(t, B.y, R.y);
+				}
+				t *= d[j];
+				F::sqr(x3, t);
+				x3 -= R.x;
+				x3 -= B.x;
+				F::sub(R.x, R.x, x3);
+				R.x *= t;
+				F::sub(R.y, R.x, R.y);
+				R.x = x3;
+			}
+		}
+		P += doneN;
+		y += yn * doneN;
+		if (neg) neg += doneN;
+		n -= doneN;
+	}
+}
+
+/*
+	z = sum_{i=0}^{n-1} P[i]
+	P[i] must be zero or normalized, and P is destroyed
+	P[i] += P[i + n/2] for i < n/2 in each round,
+	and the additions in a round are done in the affine coordinates sharing an inversion
+*/
+template<class G>
+void sumNormalizedVec(G& z, G *P, size_t n)
+{
+	typedef typename G::Fp F;
+	if (n == 0) {
+		z.clear();
+		return;
+	}
+	std::vector<F> d(n / 2);
+	std::vector<uint32_t> idx(n / 2);
+	while (n > 1) {
+		const size_t h = n / 2;
+		size_t m = 0;
+		for (size_t i = 0; i < h; i++) {
+			G& R = P[i];
+			const G& B = P[i + h];
+			if (B.isZero()) continue;
+			if (R.isZero()) {
+				R = B;
+				continue;
+			}
+			if (R.x == B.x) {
+				// R = +-B is rare
+				mcl::ec::addAffine(R, R, B);
+				continue;
+			}
+			F::sub(d[m], B.x, R.x);
+			idx[m] = uint32_t(i);
+			m++;
+		}
+		if (m > 0) {
+			F *pd = &d[0];
+			mcl::invVecT<F>(pd, pd, m, m);
+			for (size_t j = 0; j < m; j++) {
+				G& R = P[idx[j]];
+				const G& B = P[idx[j] + h];
+				F t, x3;
+				F::sub(t, B.y, R.y);
+				t *= d[j];
+				F::sqr(x3, t);
+				x3 -= R.x;
+				x3 -= B.x;
+				F::sub(R.x, R.x, x3);
+				R.x *= t;
+				F::sub(R.y, R.x, R.y);
+				R.x = x3;
+			}
+		}
+		if (n & 1) {
+			P[h] = P[n - 1];
+			n = h + 1;
+		} else {
+			n = h;
+		}
+	}
+	z = P[0];
+}
+
+/*
+	G::mul (resp. GT::pow) for each w[i] is faster than G::mulVec (resp. GT::powVec)
+	if |w[i]| < 2^16 for all i
+*/
+inline bool isSmallVec(const int64_t *w, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		if (w[i] <= -0x10000 || w[i] >= 0x10000) return false;
+	}
+	return true;
+}
+inline bool isSmallVec(const Fr *, size_t) { return false; }
+
+/*
+	multi thread version of CT::sumVec
+	the num of thread is automatically detected if cpuN = 0
+	c is split into cpuN parts
+*/
+template<class CT>
+void sumVecMT(CT& z, const CT *c, size_t n, size_t cpuN)
+{
+#ifdef MCL_USE_OMP
+	const size_t minN = sumVecBlockSize;
+	const bool autoN = cpuN == 0;
+	if (autoN) cpuN = omp_get_num_procs();
+	if (autoN && n < minN * cpuN) {
+		cpuN = (n + minN - 1) / minN;
+	}
+	if (cpuN <= 1 || n <= cpuN) {
+		CT::sumVec(z, c, n);
+		return;
+	}
+	std::vector<CT> zs(cpuN);
+	const size_t q = n / cpuN;
+	const size_t r = n % cpuN;
+	#pragma omp parallel for num_threads(int(cpuN))
+	for (int i = 0; i < int(cpuN); i++) {
+		const size_t adj = q * i + fp::min_(size_t(i), r);
+		CT::sumVec(zs[i], c + adj, q + (size_t(i) < r));
+	}
+	z = zs[0];
+	for (size_t i = 1; i < cpuN; i++) {
+		CT::add(z, z, zs[i]);
+	}
+#else
+	(void)cpuN;
+	CT::sumVec(z, c, n);
+#endif
+}
+
 template<class G, bool = true>
 struct InterfaceForHashTable : G {
 	static G& castG(InterfaceForHashTable& x) { return static_cast<G&>(x); }
@@ -54,8 +359,10 @@ struct InterfaceForHashTable : G {
 	static bool isZero(const G& P) { return P.isZero(); }
 	static int isEqualOrMinus(const G& P, const G& Q) { return P.isEqualOrMinus(Q); }
 	static uint32_t getHash(const G& P) { return uint32_t(*P.x.getUnit()); }
+	static uint64_t getHash64(const G& P) { return local::getHash64(P.x.getUnit()); }
 	static void clear(G& P) { P.clear(); }
 	static void normalize(G& P) { P.normalize(); }
+	static void normalizeVec(G *Q, size_t n) { G::normalizeVec(Q, Q, n); }
 	static void dbl(G& Q, const G& P) { G::dbl(Q, P); }
 	static void neg(G& Q, const G& P) { G::neg(Q, P); }
 	static void add(G& R, const G& P, const G& Q) { G::add(R, P, Q); }
@@ -85,8 +392,10 @@ struct InterfaceForHashTable<G, false> : G {
 		return 0;
 	}
 	static uint32_t getHash(const G& x) { return uint32_t(*x.getFp0()->getUnit()); }
+	static uint64_t getHash64(const G& x) { return local::getHash64(x.getFp0()->getUnit()); }
 	static void clear(G& x) { x = 1; }
 	static void normalize(G&) { }
+	static void normalizeVec(G *, size_t) { }
 	static void dbl(G& y, const G& x) { G::sqr(y, x); }
 	static void neg(G& Q, const G& P) { G::unitaryInv(Q, P); }
 	static void add(G& z, const G& x, const G& y) { G::mul(z, x, y); }
@@ -102,84 +411,293 @@ template<>char GtoChar<bn::GT>() { return 'T'; }
 
 /*
 	HashTable<EC, true> or HashTable<Fp12, false>
+	table of (hash of xP, x) for 1 <= x <= hashSize
+	the table made by init is a bucketized cuckoo hash table of KeyCountBucket.
+	the key is the upper 32 bits of the 64-bit hash, and an entry is in one of two buckets,
+	idx1 given by the lower 32 bits and idx2 = getAltBucketIdx(idx1, key),
+	so a lookup reads at most two buckets (two cache misses) whatever the load is.
+	the table of the old format (sorted KeyCount by 32-bit hash) is still loaded
+	and searched by equal_range.
 */
 template<class G, bool isEC = true>
 class HashTable {
 	typedef InterfaceForHashTable<G, isEC> I;
 	typedef std::vector<KeyCount> KeyCountVec;
-	KeyCountVec kcv_;
+	typedef std::vector<KeyCountBucket> BucketVec;
+	KeyCountVec kcv_; // old format
+	BucketVec bucketVec_;
+	cybozu::Mmap *map_; // set by mapFile
+	// bucketVec_ or the mapped area
+	const KeyCountBucket *bucket_;
+	size_t bucketNum_;
+	size_t hashSize_;
 	G P_;
 	mcl::fp::WindowMethod<I> wm_;
 	G nextP_;
 	G nextNegP_;
 	size_t tryNum_;
+public:
+	typedef void (*ProgressFunc)(void *arg, size_t done, size_t total);
+private:
+	ProgressFunc progressFunc_;
+	void *progressArg_;
+	// version of save/load (the old format has no version)
+	static const char versionMarker = 'V';
+	static const uint8_t version = 3;
+	void setBucket(const KeyCountBucket *bucket, size_t bucketNum)
+	{
+		bucket_ = bucket;
+		bucketNum_ = bucketNum;
+	}
+	// clear the tables and unmap the file
+	void clearTable()
+	{
+		kcv_.clear();
+		bucketVec_.clear();
+		delete map_;
+		map_ = 0;
+		setBucket(0, 0);
+		hashSize_ = 0;
+	}
+	static const HashTableFileHeader *verifyMapFile(const cybozu::Mmap& map, const std::string& fileName, const G& P)
+	{
+		if (map.size() < sizeof(HashTableFileHeader)) throw cybozu::Exception("HashTable:mapFile:too small") << fileName;
+		const HashTableFileHeader *header = (const HashTableFileHeader*)map.get();
+		if (memcmp(header->magic, hashTableFileMagic, sizeof(header->magic)) != 0) throw cybozu::Exception("HashTable:mapFile:bad magic") << fileName;
+		if (header->curveType != uint32_t(getCurveParam().curveType)) throw cybozu::Exception("HashTable:mapFile:bad curveType") << fileName << header->curveType;
+		if (header->group != uint32_t(GtoChar<G>())) throw cybozu::Exception("HashTable:mapFile:bad group") << fileName << header->group;
+		if (header->bucketSize != sizeof(KeyCountBucket)) throw cybozu::Exception("HashTable:mapFile:bad bucketSize") << fileName << header->bucketSize;
+		if (header->version != version) throw cybozu::Exception("HashTable:mapFile:bad version") << fileName << header->version;
+		if (header->hashSize >= 0x80000000u || header->bucketNum != getBucketNum(size_t(header->hashSize))) {
+			throw cybozu::Exception("HashTable:mapFile:bad size") << fileName << header->hashSize << header->bucketNum;
+		}
+		if (map.size() != sizeof(HashTableFileHeader) + sizeof(KeyCountBucket) * header->bucketNum) throw cybozu::Exception("HashTable:mapFile:bad file size") << fileName << map.size();
+		if (header->hashOfP != getHashOfPoint(P)) throw cybozu::Exception("HashTable:mapFile:bad P") << fileName;
+		return header;
+	}
 	void setWindowMethod()
 	{
 		const size_t bitSize = G::BaseFp::BaseFp::getBitSize();
 		wm_.init(static_cast<const I&>(P_), bitSize, local::winSize);
 	}
-public:
-	HashTable() : tryNum_(local::defaultTryNum) {}
-	bool operator==(const HashTable& rhs) const
+	void setNextP()
 	{
-		if (kcv_.size() != rhs.kcv_.size()) return false;
-		for (size_t i = 0; i < kcv_.size(); i++) {
-			if (!kcv_[i].isSame(rhs.kcv_[i])) return false;
+		I::mul(nextP_, P_, (hashSize_ * 2) + 1);
+		I::normalize(nextP_);
+		I::neg(nextNegP_, nextP_);
+	}
+	// the load factor is about 3/4
+	static size_t getBucketNum(size_t hashSize)
+	{
+		return (hashSize + KeyCountBucket::N * 3 / 4 - 1) / (KeyCountBucket::N * 3 / 4);
+	}
+	size_t getBucketIdx(uint64_t h) const
+	{
+		return size_t((uint64_t(uint32_t(h)) * bucketNum_) >> 32);
+	}
+	/*
+		the other bucket of an entry with key in bucket idx
+		idx1 + idx2 = (key * bucketNum_) >> 32 mod bucketNum_,
+		so it is computed from the key stored in a slot without the hash
+	*/
+	size_t getAltBucketIdx(size_t idx, uint32_t key) const
+	{
+		size_t alt = size_t((uint64_t(key) * bucketNum_) >> 32) + bucketNum_ - idx;
+		if (alt >= bucketNum_) alt -= bucketNum_;
+		return alt;
+	}
+	// put kc into an empty slot of bucketVec_[idx] if exists
+	bool insertIntoBucket(size_t idx, const KeyCount& kc)
+	{
+		KeyCountBucket& b = bucketVec_[idx];
+		for (size_t i = 0; i < KeyCountBucket::N; i++) {
+			if (b.kc[i].count == 0) {
+				b.kc[i] = kc;
+				return true;
+			}
 		}
-		return P_ == rhs.P_ && nextP_ == rhs.nextP_;
+		return false;
 	}
-	bool operator!=(const HashTable& rhs) const { return !operator==(rhs); }
 	/*
-		compute log_P(xP) for |x| <= hashSize * tryNum
+		insert (h, count) into one of the two buckets of h
+		if both are full, replace an entry and move it to its other bucket (cuckoo hashing)
+		the slots of the replaced entries are chosen by a fixed sequence, so the layout is deterministic
 	*/
-	void init(const G& P, size_t hashSize)
+	void insert(uint64_t h, int count)
 	{
-		if (hashSize == 0) {
-			kcv_.clear();
-			return;
+		KeyCount kc;
+		kc.key = uint32_t(h >> 32);
+		kc.count = count;
+		size_t idx = getBucketIdx(h);
+		if (insertIntoBucket(idx, kc)) return;
+		idx = getAltBucketIdx(idx, kc.key);
+		uint32_t r = kc.key;
+		for (size_t n = 0; n < local::maxKickNum; n++) {
+			if (insertIntoBucket(idx, kc)) return;
+			r = r * 1103515245 + 12345;
+			std::swap(kc, bucketVec_[idx].kc[(r >> 16) % KeyCountBucket::N]);
+			idx = getAltBucketIdx(idx, kc.key);
+		}
+		throw cybozu::Exception("HashTable:insert:too many kicks") << count;
+	}
+	/*
+		hv[i - begin] = hash of iP for i in [begin, end)
+		beginP is computed by the window method, and the points are normalized at once
+	*/
+	void makeHashBlock(uint64_t *hv, size_t begin, size_t end, G *buf) const
+	{
+		const size_t n = end - begin;
+		G P = P_;
+		I::normalize(P);
+		mulByWindowMethod(buf[0], int64_t(begin));
+		for (size_t i = 1; i < n; i++) {
+			I::add(buf[i], buf[i - 1], P);
+		}
+		I::normalizeVec(buf, n);
+		for (size_t i = 0; i < n; i++) {
+			hv[i] = I::getHash64(buf[i]);
 		}
-		if (hashSize >= 0x80000000u) throw cybozu::Exception("HashTable:init:hashSize is too large");
-		P_ = P;
-		kcv_.resize(hashSize);
-		G xP;
-		I::clear(xP);
-		for (int i = 1; i <= (int)kcv_.size(); i++) {
-			I::add(xP, xP, P_);
-			I::normalize(xP);
-			kcv_[i - 1].key = I::getHash(xP);
-			kcv_[i - 1].count = i;
-		}
-		nextP_ = xP;
-		I::dbl(nextP_, nextP_);
-		I::add(nextP_, nextP_, P_); // nextP = (hasSize * 2 + 1)P
-		I::neg(nextNegP_, nextP_); // nextNegP = -nextP
-		/*
-			ascending order of abs(count) for same key
-		*/
-		std::stable_sort(kcv_.begin(), kcv_.end());
-		setWindowMethod();
 	}
-	void init(const G& P, size_t hashSize, size_t tryNum)
+	/*
+		make hv[i] = hash of (i + 1)P for i in [0, hashSize_) with cpuN threads
+		each thread makes a block of contiguous entries
+	*/
+	void makeHashVec(std::vector<uint64_t>& hv, size_t cpuN) const
 	{
-		init(P, hashSize);
-		setTryNum(tryNum);
+		const size_t n = hashSize_;
+		const size_t blockSize = local::initBlockSize;
+		const size_t blockN = (n + blockSize - 1) / blockSize;
+		hv.resize(n);
+		size_t done = 0;
+#ifdef MCL_USE_OMP
+		if (cpuN == 0) cpuN = omp_get_num_procs();
+		#pragma omp parallel num_threads(int(cpuN))
+		{
+			std::vector<G> buf(blockSize);
+			#pragma omp for schedule(dynamic)
+			for (int b = 0; b < int(blockN); b++) {
+				const size_t begin = size_t(b) * blockSize;
+				const size_t end = fp::min_(begin + blockSize, n);
+				makeHashBlock(&hv[begin], begin + 1, end + 1, &buf[0]);
+				#pragma omp critical
+				{
+					done += end - begin;
+					if (progressFunc_) progressFunc_(progressArg_, done, n);
+				}
+			}
+		}
+#else
+		(void)cpuN;
+		std::vector<G> buf(blockSize);
+		for (size_t b = 0; b < blockN; b++) {
+			const size_t begin = b * blockSize;
+			const size_t end = fp::min_(begin + blockSize, n);
+			makeHashBlock(&hv[begin], begin + 1, end + 1, &buf[0]);
+			done += end - begin;
+			if (progressFunc_) progressFunc_(progressArg_, done, n);
+		}
+#endif
 	}
-	void setTryNum(size_t tryNum)
+	/*
+		insert (hv[i], i + 1) for i in [0, hv.size()) into bucketVec_
+		the buckets are split into partN ranges and the entries are partitioned
+		by their first bucket, then each range is filled in parallel
+		with the entries which fit in their first bucket.
+		the rest (a few percent) are inserted by insert at last.
+		the layout of the table does not depend on cpuN.
+	*/
+	void insertHashVec(const std::vector<uint64_t>& hv, size_t cpuN)
 	{
-		this->tryNum_ = tryNum;
+		const size_t n = hv.size();
+		const size_t bucketNum = bucketVec_.size();
+		const size_t partN = fp::min_(bucketNum, local::initPartNum);
+		// idx[pos[p], pos[p + 1]) are indices of hv for part p in ascending order
+		std::vector<uint32_t> part(n);
+		std::vector<size_t> pos(partN + 1);
+		for (size_t i = 0; i < n; i++) {
+			const uint32_t p = uint32_t(uint64_t(getBucketIdx(hv[i])) * partN / bucketNum);
+			part[i] = p;
+			pos[p + 1]++;
+		}
+		for (size_t p = 0; p < partN; p++) {
+			pos[p + 1] += pos[p];
+		}
+		std::vector<uint32_t> idx(n);
+		{
+			std::vector<size_t> cur(pos.begin(), pos.end() - 1);
+			for (size_t i = 0; i < n; i++) {
+				idx[cur[part[i]]++] = uint32_t(i);
+			}
+		}
+		std::vector<std::vector<uint32_t> > overflow(partN);
+#ifdef MCL_USE_OMP
+		if (cpuN == 0) cpuN = omp_get_num_procs();
+		#pragma omp parallel for num_threads(int(cpuN)) schedule(dynamic)
+		for (int p = 0; p < int(partN); p++) {
+#else
+		(void)cpuN;
+		for (size_t p = 0; p < partN; p++) {
+#endif
+			for (size_t j = pos[p]; j < pos[p + 1]; j++) {
+				const uint32_t i = idx[j];
+				KeyCount kc;
+				kc.key = uint32_t(hv[i] >> 32);
+				kc.count = int(i + 1);
+				if (!insertIntoBucket(getBucketIdx(hv[i]), kc)) overflow[p].push_back(i);
+			}
+		}
+		for (size_t p = 0; p < partN; p++) {
+			for (size_t j = 0; j < overflow[p].size(); j++) {
+				const uint32_t i = overflow[p][j];
+				insert(hv[i], int(i + 1));
+			}
+		}
 	}
 	/*
-		log_P(xP)
-		find range which has same hash of xP in kcv_,
-		and detect it
+		check whether xP == count P
+		return 1 if xP == count P, -1 if xP == -count P, 0 otherwise
 	*/
-	int basicLog(G xP, bool *pok = 0) const
+	int check(const G& xP, int count) const
+	{
+		G T;
+		mulByWindowMethod(T, count);
+		return I::isEqualOrMinus(T, xP);
+	}
+	// return c if xP = cP for an entry of b, 0 otherwise
+	int findInBucket(const KeyCountBucket& b, uint32_t key, const G& xP) const
+	{
+		for (size_t i = 0; i < KeyCountBucket::N; i++) {
+			const int count = b.kc[i].count;
+			if (count == 0 || b.kc[i].key != key) continue;
+			int v = check(xP, count);
+			if (v) return v * count;
+		}
+		return 0;
+	}
+	int basicLogCuckoo(const G& xP, bool *pok) const
+	{
+		if (bucketNum_ > 0) {
+			const uint64_t h = I::getHash64(xP);
+			const uint32_t key = uint32_t(h >> 32);
+			const size_t idx1 = getBucketIdx(h);
+			const size_t idx2 = getAltBucketIdx(idx1, key);
+			int c = findInBucket(bucket_[idx1], key, xP);
+			if (c) return c;
+			if (idx2 != idx1) {
+				c = findInBucket(bucket_[idx2], key, xP);
+				if (c) return c;
+			}
+		}
+		if (pok) {
+			*pok = false;
+			return 0;
+		}
+		throw cybozu::Exception("HashTable:basicLog:not found");
+	}
+	int basicLogSortedVec(const G& xP, bool *pok) const
 	{
-		if (pok) *pok = true;
-		if (I::isZero(xP)) return 0;
 		typedef KeyCountVec::const_iterator Iter;
 		KeyCount kc;
-		I::normalize(xP);
 		kc.key = I::getHash(xP);
 		kc.count = 0;
 		std::pair<Iter, Iter> p = std::equal_range(kcv_.begin(), kcv_.end(), kc);
@@ -212,6 +730,129 @@ public:
 		}
 		throw cybozu::Exception("HashTable:basicLog:not found");
 	}
+public:
+	HashTable()
+		: map_(0)
+		, bucket_(0)
+		, bucketNum_(0)
+		, hashSize_(0)
+		, tryNum_(local::defaultTryNum)
+		, progressFunc_(0)
+		, progressArg_(0)
+	{
+	}
+	/*
+		a copy of a mapped table has its own buckets in bucketVec_
+	*/
+	HashTable(const HashTable& rhs)
+		: map_(0)
+		, bucket_(0)
+		, bucketNum_(0)
+		, hashSize_(0)
+		, tryNum_(local::defaultTryNum)
+		, progressFunc_(0)
+		, progressArg_(0)
+	{
+		*this = rhs;
+	}
+	HashTable& operator=(const HashTable& rhs)
+	{
+		if (this == &rhs) return *this;
+		KeyCountVec kcv(rhs.kcv_);
+		BucketVec bucketVec(rhs.bucket_, rhs.bucket_ + rhs.bucketNum_);
+		clearTable();
+		kcv_.swap(kcv);
+		bucketVec_.swap(bucketVec);
+		if (!bucketVec_.empty()) setBucket(&bucketVec_[0], bucketVec_.size());
+		hashSize_ = rhs.hashSize_;
+		P_ = rhs.P_;
+		wm_ = rhs.wm_;
+		nextP_ = rhs.nextP_;
+		nextNegP_ = rhs.nextNegP_;
+		tryNum_ = rhs.tryNum_;
+		progressFunc_ = rhs.progressFunc_;
+		progressArg_ = rhs.progressArg_;
+		return *this;
+	}
+	~HashTable()
+	{
+		delete map_;
+	}
+	bool operator==(const HashTable& rhs) const
+	{
+		if (hashSize_ != rhs.hashSize_) return false;
+		if (kcv_.size() != rhs.kcv_.size()) return false;
+		for (size_t i = 0; i < kcv_.size(); i++) {
+			if (!kcv_[i].isSame(rhs.kcv_[i])) return false;
+		}
+		if (bucketNum_ != rhs.bucketNum_) return false;
+		for (size_t i = 0; i < bucketNum_; i++) {
+			if (!bucket_[i].isSame(rhs.bucket_[i])) return false;
+		}
+		return P_ == rhs.P_ && nextP_ == rhs.nextP_;
+	}
+	bool operator!=(const HashTable& rhs) const { return !operator==(rhs); }
+	/*
+		compute log_P(xP) for |x| <= hashSize * tryNum
+		make the table with cpuN threads if MCL_USE_OMP is defined
+		the num of thread is automatically detected if cpuN = 0
+	*/
+	void init(const G& P, size_t hashSize, size_t tryNum, size_t cpuN)
+	{
+		clearTable();
+		setTryNum(tryNum);
+		if (hashSize == 0) return;
+		if (hashSize >= 0x80000000u) throw cybozu::Exception("HashTable:init:hashSize is too large");
+		P_ = P;
+		hashSize_ = hashSize;
+		setWindowMethod();
+		std::vector<uint64_t> hv;
+		makeHashVec(hv, cpuN);
+		bucketVec_.resize(getBucketNum(hashSize));
+		setBucket(&bucketVec_[0], bucketVec_.size());
+		try {
+			insertHashVec(hv, cpuN);
+		} catch (...) {
+			clearTable();
+			throw;
+		}
+		setNextP();
+	}
+	void init(const G& P, size_t hashSize)
+	{
+		init(P, hashSize, tryNum_, 0);
+	}
+	void init(const G& P, size_t hashSize, size_t tryNum)
+	{
+		init(P, hashSize, tryNum, 0);
+	}
+	/*
+		f(arg, done, total) is called in init whenever a block of entries is made
+		(in a critical section if MCL_USE_OMP is defined)
+		f = 0 disables it
+	*/
+	void setProgressFunc(ProgressFunc f, void *arg = 0)
+	{
+		progressFunc_ = f;
+		progressArg_ = arg;
+	}
+	void setTryNum(size_t tryNum)
+	{
+		this->tryNum_ = tryNum;
+	}
+	/*
+		log_P(xP)
+		find the entries which have the same hash of xP
+		and detect it
+	*/
+	int basicLog(G xP, bool *pok = 0) const
+	{
+		if (pok) *pok = true;
+		if (I::isZero(xP)) return 0;
+		I::normalize(xP);
+		if (kcv_.empty()) return basicLogCuckoo(xP, pok);
+		return basicLogSortedVec(xP, pok);
+	}
 	/*
 		compute log_P(xP)
 		call basicLog at most 2 * tryNum
@@ -227,7 +868,7 @@ public:
 		G posP = xP, negP = xP;
 		int64_t posCenter = 0;
 		int64_t negCenter = 0;
-		int64_t next = (int64_t)kcv_.size() * 2 + 1;
+		int64_t next = (int64_t)hashSize_ * 2 + 1;
 		for (size_t i = 1; i < tryNum_; i++) {
 			I::add(posP, posP, nextNegP_);
 			posCenter += next;
@@ -250,17 +891,112 @@ public:
 		}
 		throw cybozu::Exception("HashTable:log:not found:tryNum") << tryNum_;
 	}
+	/*
+		m[i] = log_P(xPv[i]) for i in [0, n)
+		the same as log for each element but
+		all points are normalized by one inversion at each step
+		and only unresolved points go to the next giant step
+		if pok is not null then *pok = false if some element is not found
+		(m[i] = 0 for such an element)
+	*/
+	void logVec(int64_t *m, const G *xPv, size_t n, bool *pok = 0) const
+	{
+		if (pok) *pok = true;
+		if (n == 0) return;
+		/*
+			v[0, k) : posP of unresolved elements
+			v[k, 2k) : negP of unresolved elements
+			idx[j] : index of v[j] in xPv
+		*/
+		std::vector<G> v(xPv, xPv + n);
+		std::vector<size_t> idx(n);
+		I::normalizeVec(&v[0], n);
+		size_t k = 0;
+		for (size_t i = 0; i < n; i++) {
+			bool ok;
+			int c = basicLog(v[i], &ok);
+			if (ok) {
+				m[i] = c;
+				continue;
+			}
+			m[i] = 0;
+			v[k] = v[i];
+			idx[k] = i;
+			k++;
+		}
+		if (k > 0) {
+			v.resize(k * 2);
+			for (size_t j = 0; j < k; j++) {
+				v[k + j] = v[j];
+			}
+		}
+		const int64_t next = (int64_t)hashSize_ * 2 + 1;
+		int64_t center = 0;
+		for (size_t i = 1; i < tryNum_ && k > 0; i++) {
+			center += next;
+			for (size_t j = 0; j < k; j++) {
+				I::add(v[j], v[j], nextNegP_);
+				I::add(v[k + j], v[k + j], nextP_);
+			}
+			I::normalizeVec(&v[0], k * 2);
+			size_t newK = 0;
+			for (size_t j = 0; j < k; j++) {
+				bool ok;
+				int c = basicLog(v[j], &ok);
+				if (ok) {
+					m[idx[j]] = center + c;
+					continue;
+				}
+				c = basicLog(v[k + j], &ok);
+				if (ok) {
+					m[idx[j]] = -center + c;
+					continue;
+				}
+				v[newK] = v[j];
+				v[k + newK] = v[k + j];
+				idx[newK] = idx[j];
+				newK++;
+			}
+			// move negP to v[newK, 2 * newK)
+			for (size_t j = 0; j < newK; j++) {
+				v[newK + j] = v[k + j];
+			}
+			k = newK;
+		}
+		if (k == 0) return;
+		if (pok) {
+			*pok = false;
+			return;
+		}
+		throw cybozu::Exception("HashTable:logVec:not found:tryNum") << tryNum_;
+	}
 	/*
 		remark
 		tryNum is not saved.
+		a table loaded from the old format is saved in the old format
+		format
+		old : curveType, GtoChar, kcv_.size(), kcv_, P_
+		new : curveType, versionMarker, version, GtoChar, hashSize_, bucketNum_, buckets, P_
 	*/
 	template<class OutputStream>
 	void save(OutputStream& os) const
 	{
 		cybozu::save(os, getCurveParam().curveType);
+		if (!kcv_.empty()) {
+			cybozu::writeChar(os, GtoChar<G>());
+			cybozu::save(os, kcv_.size());
+			cybozu::write(os, &kcv_[0], sizeof(kcv_[0]) * kcv_.size());
+			P_.save(os);
+			return;
+		}
+		cybozu::writeChar(os, versionMarker);
+		cybozu::writeChar(os, char(version));
 		cybozu::writeChar(os, GtoChar<G>());
-		cybozu::save(os, kcv_.size());
-		cybozu::write(os, &kcv_[0], sizeof(kcv_[0]) * kcv_.size());
+		cybozu::save(os, hashSize_);
+		cybozu::save(os, bucketNum_);
+		if (bucketNum_ > 0) {
+			cybozu::write(os, bucket_, sizeof(bucket_[0]) * bucketNum_);
+		}
 		P_.save(os);
 	}
 	size_t save(void *buf, size_t maxBufSize) const
@@ -269,9 +1005,28 @@ public:
 		save(os);
 		return os.getPos();
 	}
+private:
+	/*
+		read n elements into v by blocks
+		so that a broken n allocates no more memory than the stream has
+	*/
+	template<class T, class InputStream>
+	static void readVec(std::vector<T>& v, size_t n, InputStream& is)
+	{
+		const size_t blockN = local::loadBlockSize / sizeof(T);
+		v.clear();
+		while (v.size() < n) {
+			const size_t pos = v.size();
+			const size_t m = fp::min_(n - pos, blockN);
+			v.resize(pos + m);
+			cybozu::read(&v[pos], sizeof(T) * m, is);
+		}
+	}
+public:
 	/*
 		remark
 		tryNum is not set
+		throw exception if the stream is broken and then the current table is not changed
 	*/
 	template<class InputStream>
 	void load(InputStream& is)
@@ -280,14 +1035,35 @@ public:
 		cybozu::load(curveType, is);
 		if (curveType != getCurveParam().curveType) throw cybozu::Exception("HashTable:bad curveType") << curveType;
 		char c = 0;
-		if (!cybozu::readChar(&c, is) || c != GtoChar<G>()) throw cybozu::Exception("HashTable:bad c") << (int)c;
-		size_t kcvSize;
-		cybozu::load(kcvSize, is);
-		kcv_.resize(kcvSize);
-		cybozu::read(&kcv_[0], sizeof(kcv_[0]) * kcvSize, is);
-		P_.load(is);
-		I::mul(nextP_, P_, (kcvSize * 2) + 1);
-		I::neg(nextNegP_, nextP_);
+		if (!cybozu::readChar(&c, is)) throw cybozu::Exception("HashTable:can't read c");
+		KeyCountVec kcv;
+		BucketVec bucketVec;
+		size_t hashSize;
+		if (c != versionMarker) {
+			// old format
+			if (c != GtoChar<G>()) throw cybozu::Exception("HashTable:bad c") << (int)c;
+			cybozu::load(hashSize, is);
+			if (hashSize >= 0x80000000u) throw cybozu::Exception("HashTable:bad size") << hashSize;
+			readVec(kcv, hashSize, is);
+		} else {
+			char v = 0;
+			if (!cybozu::readChar(&v, is) || uint8_t(v) != version) throw cybozu::Exception("HashTable:bad version") << (int)v;
+			if (!cybozu::readChar(&c, is) || c != GtoChar<G>()) throw cybozu::Exception("HashTable:bad c") << (int)c;
+			size_t bucketNum;
+			cybozu::load(hashSize, is);
+			cybozu::load(bucketNum, is);
+			if (hashSize >= 0x80000000u || bucketNum != getBucketNum(hashSize)) throw cybozu::Exception("HashTable:bad bucketNum") << hashSize << bucketNum;
+			readVec(bucketVec, bucketNum, is);
+		}
+		G P;
+		P.load(is);
+		clearTable();
+		kcv_.swap(kcv);
+		bucketVec_.swap(bucketVec);
+		if (!bucketVec_.empty()) setBucket(&bucketVec_[0], bucketVec_.size());
+		hashSize_ = hashSize;
+		P_ = P;
+		setNextP();
 		setWindowMethod();
 	}
 	size_t load(const void *buf, size_t bufSize)
@@ -296,6 +1072,68 @@ public:
 		load(is);
 		return is.getPos();
 	}
+	/*
+		save the table in the format of mapFile
+		HashTableFileHeader + buckets
+		a table loaded from the old format can't be saved
+	*/
+	void saveMapFile(std::ostream& os) const
+	{
+		if (!kcv_.empty()) throw cybozu::Exception("HashTable:saveMapFile:old format");
+		HashTableFileHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, hashTableFileMagic, sizeof(header.magic));
+		header.curveType = uint32_t(getCurveParam().curveType);
+		header.group = uint32_t(GtoChar<G>());
+		header.bucketSize = uint32_t(sizeof(KeyCountBucket));
+		header.version = version;
+		header.hashSize = hashSize_;
+		header.bucketNum = bucketNum_;
+		header.hashOfP = getHashOfPoint(P_);
+		cybozu::write(os, &header, sizeof(header));
+		if (bucketNum_ > 0) {
+			cybozu::write(os, bucket_, sizeof(bucket_[0]) * bucketNum_);
+		}
+	}
+	void saveMapFile(const std::string& fileName) const
+	{
+		// check it before the file is truncated
+		if (!kcv_.empty()) throw cybozu::Exception("HashTable:saveMapFile:old format") << fileName;
+		std::ofstream ofs(fileName.c_str(), std::ios::binary);
+		if (!ofs) throw cybozu::Exception("HashTable:saveMapFile:can't open") << fileName;
+		saveMapFile(ofs);
+		if (!ofs.flush()) throw cybozu::Exception("HashTable:saveMapFile:can't write") << fileName;
+	}
+	/*
+		map fileName made by saveMapFile and use the buckets in place
+		the mapping is read only and shared with other processes
+		P must be the same point used to make the table
+		throw exception if the header is broken or does not match P
+		and then the current table is not changed
+		remark
+		tryNum is not set
+	*/
+	void mapFile(const std::string& fileName, const G& P)
+	{
+		cybozu::Mmap *map = new cybozu::Mmap(fileName);
+		const HashTableFileHeader *header;
+		try {
+			header = verifyMapFile(*map, fileName, P);
+		} catch (...) {
+			delete map;
+			throw;
+		}
+		clearTable();
+		map_ = map;
+		P_ = P;
+		hashSize_ = size_t(header->hashSize);
+		if (hashSize_ > 0) {
+			setBucket((const KeyCountBucket*)(map->get() + sizeof(HashTableFileHeader)), size_t(header->bucketNum));
+		}
+		setNextP();
+		setWindowMethod();
+	}
+	bool isMapped() const { return map_ != 0; }
 	const mcl::fp::WindowMethod<I>& getWM() const { return wm_; }
 	/*
 		mul(x, P, y);
@@ -305,7 +1143,7 @@ public:
 	{
 		wm_.mul(static_cast<I&>(x), y);
 	}
-	size_t getTableSize() const { return kcv_.size(); }
+	size_t getTableSize() const { return hashSize_; }
 };
 
 template<class G>
@@ -465,6 +1303,73 @@ struct SHET {
 			G::neg(y.S_, x.S_);
 			G::neg(y.T_, x.T_);
 		}
+		/*
+			z = sum_{i=0}^{n-1} c[i]
+			c[i] are normalized by blocks and added in the affine coordinates
+		*/
+		static void sumVec(CipherTextAT& z, const CipherTextAT *c, size_t n)
+		{
+			const size_t N = local::sumVecBlockSize;
+			std::vector<G> buf(fp::min_(n, N) * 2);
+			G S, T;
+			S.clear();
+			T.clear();
+			while (n > 0) {
+				const size_t doneN = fp::min_(n, N);
+				G *bS = &buf[0];
+				G *bT = &buf[doneN];
+				for (size_t i = 0; i < doneN; i++) {
+					bS[i] = c[i].S_;
+					bT[i] = c[i].T_;
+				}
+				G::normalizeVec(bS, bS, doneN * 2);
+				G t;
+				local::sumNormalizedVec(t, bS, doneN);
+				S += t;
+				local::sumNormalizedVec(t, bT, doneN);
+				T += t;
+				c += doneN;
+				n -= doneN;
+			}
+			z.S_ = S;
+			z.T_ = T;
+		}
+		/*
+			multi thread version of sumVec
+			the num of thread is automatically detected if cpuN = 0
+		*/
+		static void sumVecMT(CipherTextAT& z, const CipherTextAT *c, size_t n, size_t cpuN = 0)
+		{
+			local::sumVecMT(z, c, n, cpuN);
+		}
+		/*
+			z = sum_{i=0}^{n-1} w[i] c[i]
+			INT = int64_t or Fr
+			each of S and T is computed by G::mulVec unless all w[i] are small
+		*/
+		template<class INT>
+		static void innerProduct(CipherTextAT& z, const CipherTextAT *c, const INT *w, size_t n)
+		{
+			if (n == 0 || local::isSmallVec(w, n)) {
+				CipherTextAT s, t;
+				s.clear();
+				for (size_t i = 0; i < n; i++) {
+					mul(t, c[i], w[i]);
+					add(s, s, t);
+				}
+				z = s;
+				return;
+			}
+			std::vector<G> buf(n * 2);
+			std::vector<Fr> wv(n);
+			for (size_t i = 0; i < n; i++) {
+				buf[i] = c[i].S_;
+				buf[n + i] = c[i].T_;
+				wv[i] = w[i];
+			}
+			G::mulVec(z.S_, &buf[0], &wv[0], n);
+			G::mulVec(z.T_, &buf[n], &wv[0], n);
+		}
 		void add(const CipherTextAT& c) { add(*this, *this, c); }
 		void sub(const CipherTextAT& c) { sub(*this, *this, c); }
 		template<class InputStream>
@@ -730,6 +1635,22 @@ public:
 	{
 		ePQhashTbl_.init(ePQ_, hashSize);
 	}
+	/*
+		use the table in fileName made by HashTable::saveMapFile without copying
+		the mapped area is shared with other processes
+	*/
+	static void mapTableForG1DLP(const std::string& fileName)
+	{
+		PhashTbl_.mapFile(fileName, P_);
+	}
+	static void mapTableForG2DLP(const std::string& fileName)
+	{
+		QhashTbl_.mapFile(fileName, Q_);
+	}
+	static void mapTableForGTDLP(const std::string& fileName)
+	{
+		ePQhashTbl_.mapFile(fileName, ePQ_);
+	}
 	/*
 		set range for G1/G2/GT DLP
 		decode message m for |m| <= hasSize * tryNum
@@ -778,6 +1699,37 @@ public:
 			v *= u;
 			v *= c.g_[0];
 		}
+		/*
+			R[i] = S[i] - x T[i] = m[i] P for c[i] = (S[i], T[i])
+		*/
+		template<class G>
+		static void getMPVec(G *R, const CipherTextAT<G> *c, size_t n, const Fr& x)
+		{
+			std::vector<Fr> xVec(n, x);
+			for (size_t i = 0; i < n; i++) {
+				R[i] = c[i].T_;
+			}
+			G::mulEach(R, &xVec[0], n);
+			for (size_t i = 0; i < n; i++) {
+				G::sub(R[i], c[i].S_, R[i]);
+			}
+		}
+		void decViaGTVec(int64_t *m, const G1 *R, size_t n, bool *pok) const
+		{
+			std::vector<GT> v(n);
+			for (size_t i = 0; i < n; i++) {
+				pairing(v[i], R[i], Q_);
+			}
+			ePQhashTbl_.logVec(m, &v[0], n, pok);
+		}
+		void decViaGTVec(int64_t *m, const G2 *R, size_t n, bool *pok) const
+		{
+			std::vector<GT> v(n);
+			for (size_t i = 0; i < n; i++) {
+				pairing(v[i], P_, R[i]);
+			}
+			ePQhashTbl_.logVec(m, &v[0], n, pok);
+		}
 	public:
 		void setByCSPRNG(fp::RandGen rg = fp::RandGen())
 		{
@@ -868,6 +1820,50 @@ public:
 				return dec(c.a_, pok);
 			}
 		}
+		/*
+			decode c[i] and set m[i] for i in [0, n)
+			if pok is not null then *pok = false if some c[i] can't be decoded
+		*/
+		void decVec(int64_t *m, const CipherTextG1 *c, size_t n, bool *pok = 0) const
+		{
+			if (n == 0) {
+				if (pok) *pok = true;
+				return;
+			}
+			std::vector<G1> R(n);
+			getMPVec(&R[0], c, n, x_);
+			if (useDecG1ViaGT_) {
+				decViaGTVec(m, &R[0], n, pok);
+				return;
+			}
+			PhashTbl_.logVec(m, &R[0], n, pok);
+		}
+		void decVec(int64_t *m, const CipherTextG2 *c, size_t n, bool *pok = 0) const
+		{
+			if (n == 0) {
+				if (pok) *pok = true;
+				return;
+			}
+			std::vector<G2> R(n);
+			getMPVec(&R[0], c, n, y_);
+			if (useDecG2ViaGT_) {
+				decViaGTVec(m, &R[0], n, pok);
+				return;
+			}
+			QhashTbl_.logVec(m, &R[0], n, pok);
+		}
+		void decVec(int64_t *m, const CipherTextGT *c, size_t n, bool *pok = 0) const
+		{
+			if (n == 0) {
+				if (pok) *pok = true;
+				return;
+			}
+			std::vector<GT> v(n);
+			for (size_t i = 0; i < n; i++) {
+				getPowOfePQ(v[i], c[i]);
+			}
+			ePQhashTbl_.logVec(m, &v[0], n, pok);
+		}
 		bool isZero(const CipherTextG1& c) const
 		{
 			return c.isZero(x_);
@@ -1048,6 +2044,77 @@ private:
 		Pmul.mul(static_cast<I&>(C), m);
 		S += C;
 	}
+	// y[i * yn, (i + 1) * yn) = r[i]
+	static void getUnitArrayVec(std::vector<Unit>& y, size_t& yn, const Fr *r, size_t n)
+	{
+		yn = Fr::getOp().N;
+		y.resize(yn * n);
+		for (size_t i = 0; i < n; i++) {
+			r[i].getUnitArray(&y[yn * i]);
+		}
+	}
+	// out[i] = r[i] xP
+	template<class G>
+	static void mulBaseVec(G *out, const G& xP, const Fr *r, size_t n)
+	{
+		for (size_t i = 0; i < n; i++) {
+			out[i] = xP;
+		}
+		G::mulEach(out, r, n);
+		G::normalizeVec(out, out, n);
+	}
+	// out[i] = r[i] xP where xPmul is the window table of xP
+	template<class G, class I>
+	static void mulBaseVec(G *out, const mcl::fp::WindowMethod<I>& xPmul, const Fr *r, size_t n)
+	{
+		std::vector<Unit> y;
+		size_t yn;
+		getUnitArrayVec(y, yn, r, n);
+		for (size_t i = 0; i < n; i++) {
+			out[i].clear();
+		}
+		local::addMulVecByWindowMethod(out, xPmul, &y[0], yn, 0, n);
+	}
+	// P[i] += m[i] B where Bmul is the window table of B
+	template<class G, class I>
+	static void addMulVecInt(G *P, const mcl::fp::WindowMethod<I>& Bmul, const int64_t *m, size_t n)
+	{
+		const size_t yn = 64 / UnitBitSize;
+		std::vector<Unit> y(yn * n);
+		std::vector<uint8_t> neg(n);
+		for (size_t i = 0; i < n; i++) {
+			const uint64_t a = fp::abs_(m[i]);
+#if MCL_SIZEOF_UNIT == 8
+			y[i] = a;
+#else
+			y[i * 2] = uint32_t(a);
+			y[i * 2 + 1] = uint32_t(a >> 32);
+#endif
+			neg[i] = m[i] < 0;
+		}
+		local::addMulVecByWindowMethod(P, Bmul, &y[0], yn, &neg[0], n);
+	}
+	/*
+		ElGamalEnc for n messages
+		(S[i], T[i]) = (m[i] P + r[i] xP, r[i] P)
+		r[i] are read at once and S[i], T[i] are normalized
+		XP is G (xP itself) or WindowMethod (the table of xP)
+	*/
+	template<class G, class I, class XP>
+	static void ElGamalEncVec(G *S, G *T, const int64_t *m, size_t n, const mcl::fp::WindowMethod<I>& Pmul, const XP& xPmul)
+	{
+		std::vector<Fr> r(n);
+		local::setRandVec(&r[0], n);
+		std::vector<Unit> y;
+		size_t yn;
+		getUnitArrayVec(y, yn, &r[0], n);
+		for (size_t i = 0; i < n; i++) {
+			T[i].clear();
+		}
+		local::addMulVecByWindowMethod(T, Pmul, &y[0], yn, 0, n);
+		mulBaseVec(S, xPmul, &r[0], n);
+		addMulVecInt(S, Pmul, m, n);
+	}
 	/*
 		https://github.com/herumi/mcl/blob/master/misc/she/nizkp.pdf
 
@@ -1411,6 +2478,23 @@ private:
 		{
 			static_cast<const T&>(*this).encGT(c, m);
 		}
+		/*
+			c[i] = Enc(m[i]) for i = 0, ..., n-1
+			the random values are read at once and
+			the scalar multiplications share the inversions
+		*/
+		void encVec(CipherTextG1 *c, const int64_t *m, size_t n) const
+		{
+			static_cast<const T&>(*this).encG1Vec(c, m, n);
+		}
+		void encVec(CipherTextG2 *c, const int64_t *m, size_t n) const
+		{
+			static_cast<const T&>(*this).encG2Vec(c, m, n);
+		}
+		void encVec(CipherTextGT *c, const int64_t *m, size_t n) const
+		{
+			static_cast<const T&>(*this).encGTVec(c, m, n);
+		}
 		template<class INT>
 		void enc(CipherText& c, const INT& m, bool multiplied = false) const
 		{
@@ -1518,6 +2602,25 @@ public:
 			const MulG<G2> yQmul(yQ_);
 			ElGamalEnc(c.S_, c.T_, m, QhashTbl_.getWM(), yQmul);
 		}
+		template<class G, class I, class XP>
+		static void encVecT(CipherTextAT<G> *c, const int64_t *m, size_t n, const mcl::fp::WindowMethod<I>& Pmul, const XP& xPmul)
+		{
+			if (n == 0) return;
+			std::vector<G> S(n), T(n);
+			ElGamalEncVec(&S[0], &T[0], m, n, Pmul, xPmul);
+			for (size_t i = 0; i < n; i++) {
+				c[i].S_ = S[i];
+				c[i].T_ = T[i];
+			}
+		}
+		void encG1Vec(CipherTextG1 *c, const int64_t *m, size_t n) const
+		{
+			encVecT(c, m, n, PhashTbl_.getWM(), xP_);
+		}
+		void encG2Vec(CipherTextG2 *c, const int64_t *m, size_t n) const
+		{
+			encVecT(c, m, n, QhashTbl_.getWM(), yQ_);
+		}
 public:
 		void getAuxiliaryForZkpDecGT(AuxiliaryForZkpDecGT& aux) const
 		{
@@ -1688,6 +2791,41 @@ public:
 			GT::pow(c.g_[3], ePQ_, rc);
 #endif
 		}
+		void encGTVec(CipherTextGT *c, const int64_t *m, size_t n) const
+		{
+			if (n == 0) return;
+			/*
+				the same as encGT
+				A[i] = ra[i] xP + m[i] P, B[i] = rb[i] P - rc[i] xP
+				s[i] = e(A[i], Q)e(B[i], yQ)
+			*/
+			std::vector<Fr> r(n * 3);
+			local::setRandVec(&r[0], n * 3);
+			const Fr *ra = &r[0];
+			const Fr *rc = &r[n];
+			const Fr *rb = &r[n * 2];
+			std::vector<G1> AB(n * 2);
+			G1 *A = &AB[0];
+			G1 *B = &AB[n];
+			mulBaseVec(A, xP_, ra, n * 2);
+			addMulVecInt(A, PhashTbl_.getWM(), m, n);
+			for (size_t i = 0; i < n; i++) {
+				G1::neg(B[i], B[i]);
+			}
+			std::vector<Unit> y;
+			size_t yn;
+			getUnitArrayVec(y, yn, rb, n);
+			local::addMulVecByWindowMethod(B, PhashTbl_.getWM(), &y[0], yn, 0, n);
+			std::vector<Fp6> yQcoeff;
+			precomputeG2(yQcoeff, yQ_);
+			for (size_t i = 0; i < n; i++) {
+				precomputedMillerLoop2(c[i].g_[0], A[i], Qcoeff_, B[i], yQcoeff);
+				finalExp(c[i].g_[0], c[i].g_[0]);
+				ePQhashTbl_.mulByWindowMethod(c[i].g_[1], rb[i]);
+				ePQhashTbl_.mulByWindowMethod(c[i].g_[2], ra[i]);
+				ePQhashTbl_.mulByWindowMethod(c[i].g_[3], rc[i]);
+			}
+		}
 	public:
 		template<class InputStream>
 		void load(bool *pb, InputStream& is, int ioMode = IoSerialize)
@@ -1767,6 +2905,14 @@ public:
 		{
 			ElGamalEnc(c.S_, c.T_, m, QhashTbl_.getWM(), yQwm_);
 		}
+		void encG1Vec(CipherTextG1 *c, const int64_t *m, size_t n) const
+		{
+			PublicKey::encVecT(c, m, n, PhashTbl_.getWM(), xPwm_);
+		}
+		void encG2Vec(CipherTextG2 *c, const int64_t *m, size_t n) const
+		{
+			PublicKey::encVecT(c, m, n, QhashTbl_.getWM(), yQwm_);
+		}
 		template<class INT>
 		void encGT(CipherTextGT& c, const INT& m) const
 		{
@@ -1787,6 +2933,26 @@ public:
 			rb -= ra;
 			ePQhashTbl_.mulByWindowMethod(c.g_[3], rb);
 		}
+		void encGTVec(CipherTextGT *c, const int64_t *m, size_t n) const
+		{
+			if (n == 0) return;
+			std::vector<Fr> r(n * 3);
+			local::setRandVec(&r[0], n * 3);
+			for (size_t i = 0; i < n; i++) {
+				const Fr& ra = r[i * 3];
+				Fr& rb = r[i * 3 + 1];
+				const Fr& rc = r[i * 3 + 2];
+				GT t;
+				ePQhashTbl_.mulByWindowMethod(c[i].g_[0], m[i]);
+				mulByWindowMethod(t, exyPQwm_, ra);
+				c[i].g_[0] *= t;
+				mulByWindowMethod(c[i].g_[1], exPQwm_, rb);
+				mulByWindowMethod(c[i].g_[2], eyPQwm_, rc);
+				rb += rc;
+				rb -= ra;
+				ePQhashTbl_.mulByWindowMethod(c[i].g_[3], rb);
+			}
+		}
 	public:
 		void init(const PublicKey& pub)
 		{
@@ -2039,6 +3205,57 @@ public:
 		{
 			mul(z, x.c1_, y.c2_);
 		}
+		/*
+			z = sum_{i=0}^{n-1} x[i] * y[i]
+			each element of z is the product of n Miller loops computed by millerLoopVec,
+			then finalExp is called only four times
+		*/
+		static void mulVec(CipherTextGT& z, const CipherTextG1 *x, const CipherTextG2 *y, size_t n)
+		{
+			mulVecMT(z, x, y, n, 1);
+		}
+		/*
+			multi thread version of mulVec
+			the num of thread is automatically detected if cpuN = 0
+			millerLoopVecMT is used for each element of z
+		*/
+		static void mulVecMT(CipherTextGT& z, const CipherTextG1 *x, const CipherTextG2 *y, size_t n, size_t cpuN = 0)
+		{
+			const size_t N = local::mulVecBlockSize;
+			std::vector<G1> P(fp::min_(n, N) * 2);
+			std::vector<G2> Q(fp::min_(n, N) * 2);
+			GT g[4];
+			for (int j = 0; j < 4; j++) {
+				g[j] = 1;
+			}
+			while (n > 0) {
+				const size_t doneN = fp::min_(n, N);
+				G1 *S1 = &P[0];
+				G1 *T1 = &P[doneN];
+				G2 *S2 = &Q[0];
+				G2 *T2 = &Q[doneN];
+				for (size_t i = 0; i < doneN; i++) {
+					S1[i] = x[i].S_;
+					T1[i] = x[i].T_;
+					S2[i] = y[i].S_;
+					T2[i] = y[i].T_;
+				}
+				/*
+					(S1, T1) * (S2, T2) = (ML(S1, S2), ML(S1, T2), ML(T1, S2), ML(T1, T2))
+				*/
+				const G1 *Pv[4] = { S1, S1, T1, T1 };
+				const G2 *Qv[4] = { S2, T2, S2, T2 };
+				for (int j = 0; j < 4; j++) {
+					GT t;
+					millerLoopVecMT(t, Pv[j], Qv[j], doneN, cpuN);
+					g[j] *= t;
+				}
+				x += doneN;
+				y += doneN;
+				n -= doneN;
+			}
+			finalExp4(z.g_, g);
+		}
 		template<class INT>
 		static void mul(CipherTextGT& z, const CipherTextGT& x, const INT& y)
 		{
@@ -2046,6 +3263,56 @@ public:
 				GT::pow(z.g_[i], x.g_[i], y);
 			}
 		}
+		/*
+			z = sum_{i=0}^{n-1} c[i]
+		*/
+		static void sumVec(CipherTextGT& z, const CipherTextGT *c, size_t n)
+		{
+			CipherTextGT t;
+			t.clear();
+			for (size_t i = 0; i < n; i++) {
+				add(t, t, c[i]);
+			}
+			z = t;
+		}
+		/*
+			multi thread version of sumVec
+			the num of thread is automatically detected if cpuN = 0
+		*/
+		static void sumVecMT(CipherTextGT& z, const CipherTextGT *c, size_t n, size_t cpuN = 0)
+		{
+			local::sumVecMT(z, c, n, cpuN);
+		}
+		/*
+			z = sum_{i=0}^{n-1} w[i] c[i]
+			INT = int64_t or Fr
+			each of g_[0..3] is computed by GT::powVec unless all w[i] are small
+		*/
+		template<class INT>
+		static void innerProduct(CipherTextGT& z, const CipherTextGT *c, const INT *w, size_t n)
+		{
+			if (n == 0 || local::isSmallVec(w, n)) {
+				CipherTextGT s, t;
+				s.clear();
+				for (size_t i = 0; i < n; i++) {
+					mul(t, c[i], w[i]);
+					add(s, s, t);
+				}
+				z = s;
+				return;
+			}
+			std::vector<GT> buf(n);
+			std::vector<Fr> wv(n);
+			for (size_t i = 0; i < n; i++) {
+				wv[i] = w[i];
+			}
+			for (int j = 0; j < 4; j++) {
+				for (size_t i = 0; i < n; i++) {
+					buf[i] = c[i].g_[j];
+				}
+				GT::powVec(z.g_[j], &buf[0], &wv[0], n);
+			}
+		}
 		void add(const CipherTextGT& c) { add(*this, *this, c); }
 		void sub(const CipherTextGT& c) { sub(*this, *this, c); }
 		template<class InputStream>
@@ -2291,6 +3558,9 @@ inline void setRangeForG1DLP(size_t hashSize) { SHE::setRangeForG1DLP(hashSize);
 inline void setRangeForG2DLP(size_t hashSize) { SHE::setRangeForG2DLP(hashSize); }
 inline void setRangeForGTDLP(size_t hashSize) { SHE::setRangeForGTDLP(hashSize); }
 inline void setRangeForDLP(size_t hashSize) { SHE::setRangeForDLP(hashSize); }
+inline void mapTableForG1DLP(const std::string& fileName) { SHE::mapTableForG1DLP(fileName); }
+inline void mapTableForG2DLP(const std::string& fileName) { SHE::mapTableForG2DLP(fileName); }
+inline void mapTableForGTDLP(const std::string& fileName) { SHE::mapTableForGTDLP(fileName); }
 inline void setTryNum(size_t tryNum) { SHE::setTryNum(tryNum); }
 inline void useDecG1ViaGT(bool use = true) { SHE::useDecG1ViaGT(use); }
 inline void useDecG2ViaGT(bool use = true) { SHE::useDecG2ViaGT(use); }
@@ -0,0 +1,102 @@
+/*
+	compare the radix-2 NTT (_ntt) and the four-step NTT (ntt) for Fr
+	compare _ntt and inttEc for G1 with -g1
+	make -j bin/ntt_bench.exe
+	bin/ntt_bench.exe -minb 10 -b 24
+	bin/ntt_bench.exe -g1 -minb 8 -b 12
+	make clean && make MCL_USE_OMP=1 -j bin/ntt_bench.exe CFLAGS_USER=-DCYBOZU_BENCH_USE_GETTIMEOFDAY
+*/
+#include <cybozu/benchmark.hpp>
+#include <mcl/bls12_381.hpp>
+#include <mcl/ntt.hpp>
+#include <cybozu/xorshift.hpp>
+#include <cybozu/option.hpp>
+
+using namespace mcl::bls12;
+
+void benchG1(int minb, int maxb, int C)
+{
+	const size_t maxN = size_t(1) << maxb;
+	std::vector<G1> in(maxN), x(maxN), y(maxN);
+	hashAndMapToG1(in[0], "abc", 3);
+	for (size_t i = 1; i < maxN; i++) {
+		G1::dbl(in[i], in[i - 1]);
+	}
+	mcl::Ntt<Fr> ntt;
+	for (int b = minb; b <= maxb; b++) {
+		const size_t n = size_t(1) << b;
+		ntt.init(n);
+		const int c = C > 0 ? C : 1;
+		printf("n=2^%d\n", b);
+		std::copy(in.begin(), in.begin() + n, x.begin());
+		std::copy(in.begin(), in.begin() + n, y.begin());
+		CYBOZU_BENCH_C("radix-2", c, ntt._ntt, x.data(), ntt.getWs(), true);
+		CYBOZU_BENCH_C("inttEc ", c, ntt.inttEc, y.data());
+		if (c == 1 && x != y) puts("inttEc err");
+		fflush(stdout);
+	}
+}
+
+int main(int argc, char *argv[])
+	try
+{
+	cybozu::Option opt;
+	int minb, maxb;
+	int C;
+	bool g1;
+	std::string curveName;
+	opt.appendOpt(&maxb, 24, "b", ": max n = 1<<b");
+	opt.appendOpt(&minb, 10, "minb", ": start from n=1<<(min b)");
+	opt.appendOpt(&C, 0, "c", ": count of loop (0 : auto)");
+	opt.appendBoolOpt(&g1, "g1", ": benchmark for G1");
+	opt.appendOpt(&curveName, "bls12-381", "curve", "bls12-381, bls12-377, snark1");
+	opt.appendHelp("h", ": show this message");
+	if (!opt.parse(argc, argv)) {
+		opt.usage();
+		return 1;
+	}
+	if (curveName == "bls12-381") {
+		initPairing(mcl::BLS12_381);
+	} else
+	if (curveName == "bls12-377") {
+		initPairing(mcl::BLS12_377);
+	} else
+	if (curveName == "snark1") {
+		initPairing(mcl::BN_SNARK1);
+	} else
+	{
+		printf("not supported curveName=%s\n", curveName.c_str());
+		return 1;
+	}
+	printf("curve=%s\n", curveName.c_str());
+	if (g1) {
+		benchG1(minb, maxb, C);
+		return 0;
+	}
+	const size_t maxN = size_t(1) << maxb;
+	cybozu::XorShift rg;
+	std::vector<Fr> in(maxN), x(maxN), y(maxN);
+	for (size_t i = 0; i < maxN; i++) {
+		in[i].setByCSPRNG(rg);
+	}
+	mcl::Ntt<Fr> ntt;
+	for (int b = minb; b <= maxb; b++) {
+		const size_t n = size_t(1) << b;
+		if (!ntt.init(n)) {
+			printf("err init n=%zd\n", n);
+			return 1;
+		}
+		const int c = C > 0 ? C : (b < 16 ? 100 : b < 20 ? 10 : 1);
+		printf("n=2^%d\n", b);
+		std::copy(in.begin(), in.begin() + n, x.begin());
+		std::copy(in.begin(), in.begin() + n, y.begin());
+		CYBOZU_BENCH_C("radix-2  ", c, ntt._ntt, x.data(), ntt.getWs(), false);
+		CYBOZU_BENCH_C("four-step", c, ntt.ntt, y.data());
+		if (x != y) puts("ntt err");
+		CYBOZU_BENCH_C("intt     ", c, ntt.intt, y.data());
+		fflush(stdout);
+	}
+} catch (std::exception& e) {
+	printf("err %s\n", e.what());
+	return 1;
+}
@@ -0,0 +1,105 @@
+/*
+	benchmark of the DLP table of she
+	compare the cuckoo hash table made by HashTable::init
+	and the table of the old format (sorted vector of 32-bit hash)
+	make -j bin/she_dlp_bench.exe
+	bin/she_dlp_bench.exe -b 20 -gtb 16
+	make clean && make MCL_USE_OMP=1 -j bin/she_dlp_bench.exe CFLAGS_USER=-DCYBOZU_BENCH_USE_GETTIMEOFDAY
+*/
+#include <cybozu/benchmark.hpp>
+#include <cybozu/xorshift.hpp>
+#include <cybozu/option.hpp>
+#include <mcl/she.hpp>
+#include <sstream>
+
+using namespace mcl::she;
+
+// the old format of HashTable::save
+template<class G, bool isEC>
+void saveOldHashTable(std::ostream& os, const G& P, int hashSize)
+{
+	typedef mcl::she::local::InterfaceForHashTable<G, isEC> I;
+	std::vector<mcl::she::local::KeyCount> kcv(hashSize);
+	G xP;
+	I::clear(xP);
+	for (int i = 1; i <= hashSize; i++) {
+		I::add(xP, xP, P);
+		I::normalize(xP);
+		kcv[i - 1].key = I::getHash(xP);
+		kcv[i - 1].count = i;
+	}
+	std::stable_sort(kcv.begin(), kcv.end());
+	cybozu::save(os, getCurveParam().curveType);
+	cybozu::writeChar(os, mcl::she::local::GtoChar<G>());
+	cybozu::save(os, kcv.size());
+	cybozu::write(os, &kcv[0], sizeof(kcv[0]) * kcv.size());
+	P.save(os);
+}
+
+template<class G, bool isEC>
+void initHashTable(mcl::she::local::HashTable<G, isEC>& hashTbl, const G& P, int hashSize)
+{
+	hashTbl.init(P, hashSize);
+}
+
+template<class G, bool isEC>
+void initOldHashTable(mcl::she::local::HashTable<G, isEC>& hashTbl, const G& P, int hashSize)
+{
+	std::stringstream ss;
+	saveOldHashTable<G, isEC>(ss, P, hashSize);
+	hashTbl.load(ss);
+}
+
+template<class G, bool isEC>
+void basicLogLoop(const mcl::she::local::HashTable<G, isEC>& hashTbl, const std::vector<G>& xPv)
+{
+	for (size_t i = 0; i < xPv.size(); i++) {
+		hashTbl.basicLog(xPv[i]);
+	}
+}
+
+template<class G, bool isEC>
+void bench(const char *name, const G& P, int bit, int n)
+{
+	typedef mcl::she::local::InterfaceForHashTable<G, isEC> I;
+	const int hashSize = 1 << bit;
+	printf("%s hashSize=2^%d\n", name, bit);
+	mcl::she::local::HashTable<G, isEC> hashTbl, oldTbl;
+	CYBOZU_BENCH_C("init     ", 1, initHashTable, hashTbl, P, hashSize);
+	CYBOZU_BENCH_C("init(old)", 1, initOldHashTable, oldTbl, P, hashSize);
+	cybozu::XorShift rg;
+	std::vector<G> xPv(n);
+	for (int i = 0; i < n; i++) {
+		I::mul(xPv[i], P, int(rg.get32() % hashSize) + 1);
+		I::normalize(xPv[i]);
+	}
+	CYBOZU_BENCH_C("basicLog     ", 1, basicLogLoop, hashTbl, xPv);
+	CYBOZU_BENCH_C("basicLog(old)", 1, basicLogLoop, oldTbl, xPv);
+}
+
+int main(int argc, char *argv[])
+	try
+{
+	cybozu::Option opt;
+	int bit, gtBit, n;
+	opt.appendOpt(&bit, 20, "b", ": hashSize = 1<<b for G1");
+	opt.appendOpt(&gtBit, 16, "gtb", ": hashSize = 1<<gtb for GT");
+	opt.appendOpt(&n, 1024, "n", ": num of basicLog");
+	opt.appendHelp("h", ": show this message");
+	if (!opt.parse(argc, argv)) {
+		opt.usage();
+		return 1;
+	}
+	SHE::init(mcl::BLS12_381);
+	G1 P;
+	hashAndMapToG1(P, "abc");
+	G2 Q;
+	hashAndMapToG2(Q, "abc");
+	GT g;
+	pairing(g, P, Q);
+	bench<G1, true>("G1", P, bit, n);
+	bench<GT, false>("GT", g, gtBit, n);
+} catch (std::exception& e) {
+	printf("err %s\n", e.what());
+	return 1;
+}
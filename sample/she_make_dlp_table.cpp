@@ -13,20 +13,25 @@ struct Param {
 	int group;
 	std::string path;
 	bool g1only;
+	bool mapFile;
 };
 
 template<class HashTable, class G>
 void makeTable(const Param& param, const char *groupStr, HashTable& hashTbl, const G& P)
 {
 	char baseName[32];
-	CYBOZU_SNPRINTF(baseName, sizeof(baseName), "she-dlp-%d-%d-%s.bin", param.curveType, param.hashBitSize, groupStr);
+	CYBOZU_SNPRINTF(baseName, sizeof(baseName), "she-dlp-%d-%d-%s.%s", param.curveType, param.hashBitSize, groupStr, param.mapFile ? "map" : "bin");
 	const std::string fileName = param.path + baseName;
 	printf("file=%s\n", fileName.c_str());
-	std::ofstream ofs(fileName.c_str(), std::ios::binary);
 
 	const size_t hashSize = 1u << param.hashBitSize;
 	hashTbl.init(P, hashSize);
-	hashTbl.save(ofs);
+	if (param.mapFile) {
+		hashTbl.saveMapFile(fileName);
+	} else {
+		std::ofstream ofs(fileName.c_str(), std::ios::binary);
+		hashTbl.save(ofs);
+	}
 }
 
 void run(const Param& param)
@@ -62,6 +67,7 @@ int main(int argc, char *argv[])
 	opt.appendOpt(&param.group, 3, "g", ": group(1:G1, 2:G2, 3:GT");
 	opt.appendOpt(&param.path, "./", "path", ": path to table");
 	opt.appendBoolOpt(&param.g1only, "g1only", ": g1only");
+	opt.appendBoolOpt(&param.mapFile, "map", ": make a file for mapTableFor*DLP");
 	opt.appendHelp("h");
 	if (opt.parse(argc, argv)) {
 		run(param);
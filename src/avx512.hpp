@@ -158,6 +158,11 @@ inline Vec vmovdqu64(const Vmask& v, const void *base)
 	return _mm512_maskz_loadu_epi64(v, base);
 }
 
+inline void vmovdqu64(void *base, const Vec& v)
+{
+	_mm512_storeu_epi64(base, v);
+}
+
 inline void vpscatterqq(void *base, const Vec& idx, const Vec& v)
 {
 	const int scale = 8;
@@ -36,6 +36,12 @@ uint32_t initBint()
 	if (cpu.has(Cpu::tAVX512_IFMA)) {
 		type |= tAVX512_IFMA;
 	}
+	if (cpu.has(Cpu::tAVX2)) {
+		type |= tAVX2;
+	}
+	if (cpu.has(Cpu::tSHA | Cpu::tSSE41)) {
+		type |= tSHA;
+	}
 	const char *env = 0;
 	const char *key = "MCL_CPU";
 #ifdef _WIN32
@@ -53,7 +59,11 @@ uint32_t initBint()
 		if (strcmp(env, "noadx") == 0) {
 			type = 0;
 		} else if (strcmp(env, "noifma") == 0) {
-			type &= tAVX512_IFMA;
+			type &= ~tAVX512_IFMA;
+		} else if (strcmp(env, "noavx2") == 0) {
+			type &= ~(tAVX512_IFMA | tAVX2);
+		} else if (strcmp(env, "nosha") == 0) {
+			type &= ~tSHA;
 		}
 	}
 #if MCL_BINT_ASM_X64 == 1
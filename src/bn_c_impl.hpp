@@ -14,6 +14,65 @@ int setStr(T *x, const char *buf, mclSize bufSize, int ioMode)
 	return n > 0 ? 0 : -1;
 }
 
+// convert bool to int by each block because ok is int[n]
+template<class G>
+mclSize deserializeVec(G *x, int *ok, const void *buf, mclSize bufSize, mclSize n, mclSize cpuN)
+{
+	if (ok == 0) return deserializeVec(x, buf, bufSize, n, 0, cpuN);
+	const size_t N = 1024;
+	bool okVec[N];
+	const size_t size = G::getSerializedByteSize();
+	const char *src = (const char*)buf;
+	size_t okN = 0;
+	while (n > 0) {
+		const size_t m = fp::min_<size_t>(n, N);
+		const size_t readSize = fp::min_<size_t>(bufSize, size * m);
+		okN += deserializeVec(x, src, readSize, m, okVec, cpuN);
+		for (size_t i = 0; i < m; i++) {
+			ok[i] = okVec[i];
+		}
+		x += m;
+		ok += m;
+		src += readSize;
+		bufSize -= readSize;
+		n -= m;
+	}
+	return okN;
+}
+
+// mv[j] = msgVec + msgSize * (i + j), sv[j] = msgSize for j < m
+static void setFixedSizeMsg(const void **mv, size_t *sv, const void *msgVec, size_t msgSize, size_t i, size_t m)
+{
+	const char *msg = (const char*)msgVec;
+	for (size_t j = 0; j < m; j++) {
+		mv[j] = msg + msgSize * (i + j);
+		sv[j] = msgSize;
+	}
+}
+
+static void hashAndMapToGVec(G1 *x, const void *const *mv, const size_t *sv, size_t n, size_t cpuN)
+{
+	hashAndMapToG1Vec(x, mv, sv, n, cpuN);
+}
+
+static void hashAndMapToGVec(G2 *x, const void *const *mv, const size_t *sv, size_t n, size_t cpuN)
+{
+	hashAndMapToG2Vec(x, mv, sv, n, cpuN);
+}
+
+template<class G>
+void hashAndMapToVec(G *x, const void *msgVec, mclSize msgSize, mclSize n, mclSize cpuN)
+{
+	const size_t N = 1024;
+	const void *mv[N];
+	size_t sv[N];
+	for (size_t i = 0; i < n; i += N) {
+		const size_t m = fp::min_<size_t>(n - i, N);
+		setFixedSizeMsg(mv, sv, msgVec, msgSize, i, m);
+		hashAndMapToGVec(x + i, mv, sv, m, cpuN);
+	}
+}
+
 #ifdef __EMSCRIPTEN__
 // use these functions forcibly
 extern "C" MCL_DLL_API void *mclBnMalloc(size_t n)
@@ -362,6 +421,10 @@ int mclBnG1_isValidOrder(const mclBnG1 *x)
 {
 	return cast(x)->isValidOrder();
 }
+mclSize mclBnG1_isValidOrderVec(const mclBnG1 *x, mclSize n, mclSize cpuN)
+{
+	return isValidOrderVec(cast(x), n, cpuN);
+}
 
 int mclBnG1_hashAndMapTo(mclBnG1 *x, const void *buf, mclSize bufSize)
 {
@@ -373,6 +436,11 @@ int mclBnG1_hashAndMapToWithDst(mclBnG1 *x, const void *buf, mclSize bufSize, co
 	hashAndMapToG1(*cast(x), buf, bufSize, dst, dstSize);
 	return 0;
 }
+int mclBnG1_hashAndMapToVec(mclBnG1 *x, const void *msgVec, mclSize msgSize, mclSize n, mclSize cpuN)
+{
+	hashAndMapToVec(cast(x), msgVec, msgSize, n, cpuN);
+	return 0;
+}
 
 mclSize mclBnG1_getStr(char *buf, mclSize maxBufSize, const mclBnG1 *x, int ioMode)
 {
@@ -429,6 +497,16 @@ mclSize mclBnG2_deserialize(mclBnG2 *x, const void *buf, mclSize bufSize)
 	return (mclSize)cast(x)->deserialize(buf, bufSize);
 }
 
+mclSize mclBnG1_deserializeVec(mclBnG1 *x, int *ok, const void *buf, mclSize bufSize, mclSize n, mclSize cpuN)
+{
+	return deserializeVec(cast(x), ok, buf, bufSize, n, cpuN);
+}
+
+mclSize mclBnG2_deserializeVec(mclBnG2 *x, int *ok, const void *buf, mclSize bufSize, mclSize n, mclSize cpuN)
+{
+	return deserializeVec(cast(x), ok, buf, bufSize, n, cpuN);
+}
+
 // return 1 if true
 int mclBnG2_isValid(const mclBnG2 *x)
 {
@@ -446,6 +524,10 @@ int mclBnG2_isValidOrder(const mclBnG2 *x)
 {
 	return cast(x)->isValidOrder();
 }
+mclSize mclBnG2_isValidOrderVec(const mclBnG2 *x, mclSize n, mclSize cpuN)
+{
+	return isValidOrderVec(cast(x), n, cpuN);
+}
 
 int mclBnG2_hashAndMapTo(mclBnG2 *x, const void *buf, mclSize bufSize)
 {
@@ -457,6 +539,11 @@ int mclBnG2_hashAndMapToWithDst(mclBnG2 *x, const void *buf, mclSize bufSize, co
 	hashAndMapToG2(*cast(x), buf, bufSize, dst, dstSize);
 	return 0;
 }
+int mclBnG2_hashAndMapToVec(mclBnG2 *x, const void *msgVec, mclSize msgSize, mclSize n, mclSize cpuN)
+{
+	hashAndMapToVec(cast(x), msgVec, msgSize, n, cpuN);
+	return 0;
+}
 
 mclSize mclBnG2_getStr(char *buf, mclSize maxBufSize, const mclBnG2 *x, int ioMode)
 {
@@ -605,6 +692,47 @@ void mclBnGT_powVec(mclBnGT *z, const mclBnGT *x, const mclBnFr *y, mclSize n)
 {
 	GT::powVec(*cast(z), cast(x), cast(y), n);
 }
+/*
+	c = 0 is not accepted because the default c depends on n
+	and mulVecFixedBase with another n would use a wrong table
+*/
+static bool isValidMulVecWindowSize(mclSize c)
+{
+	return 1 <= c && c <= 20;
+}
+mclSize mclBn_getMulVecFixedBaseWindowSize(mclSize n)
+{
+	return getMulVecFixedBaseWindowSize(n);
+}
+mclSize mclBn_getPrecomputedMulVecSize(mclSize n, mclSize c)
+{
+	if (!isValidMulVecWindowSize(c)) return 0;
+	return getPrecomputedMulVecSize(n, c);
+}
+int mclBnG1_precomputeMulVec(mclBnG1 *tbl, const mclBnG1 *x, mclSize n, mclSize c)
+{
+	if (!isValidMulVecWindowSize(c)) return -1;
+	precomputeMulVec(cast(tbl), cast(x), n, c);
+	return 0;
+}
+int mclBnG2_precomputeMulVec(mclBnG2 *tbl, const mclBnG2 *x, mclSize n, mclSize c)
+{
+	if (!isValidMulVecWindowSize(c)) return -1;
+	precomputeMulVec(cast(tbl), cast(x), n, c);
+	return 0;
+}
+int mclBnG1_mulVecFixedBase(mclBnG1 *z, const mclBnG1 *tbl, const mclBnFr *y, mclSize m, mclSize c)
+{
+	if (!isValidMulVecWindowSize(c)) return -1;
+	mulVecFixedBase(*cast(z), cast(tbl), cast(y), m, c);
+	return 0;
+}
+int mclBnG2_mulVecFixedBase(mclBnG2 *z, const mclBnG2 *tbl, const mclBnFr *y, mclSize m, mclSize c)
+{
+	if (!isValidMulVecWindowSize(c)) return -1;
+	mulVecFixedBase(*cast(z), cast(tbl), cast(y), m, c);
+	return 0;
+}
 void mclBnG1_mulEach(mclBnG1 *x, const mclBnFr *y, mclSize n)
 {
 	G1::mulEach(cast(x), cast(y), n);
@@ -638,6 +766,20 @@ void mclBnG2_mulVecMT(mclBnG2 *z, mclBnG2 *x, const mclBnFr *y, mclSize n, mclSi
 {
 	G2::mulVecMT(*cast(z), cast(x), cast(y), n, cpuN);
 }
+int mclBn_verifyBatchG1(const mclBnG1 *sig, const mclBnG2 *pub, const void *msgVec, mclSize msgSize, mclSize n, const mclBnG2 *Q, mclSize cpuN)
+{
+	if (n == 0) return 0;
+	// verify each block of N messages (one finalExp per block)
+	const size_t N = 1024;
+	const void *mv[N];
+	size_t sv[N];
+	for (size_t i = 0; i < n; i += N) {
+		const size_t m = fp::min_<size_t>(n - i, N);
+		setFixedSizeMsg(mv, sv, msgVec, msgSize, i, m);
+		if (!verifyBatchG1(cast(sig) + i, cast(pub) + i, mv, sv, m, *cast(Q), cpuN)) return 0;
+	}
+	return 1;
+}
 int mclBn_getUint64NumToPrecompute(void)
 {
 	return int(getPrecomputedQcoeffSize() * sizeof(Fp6) / sizeof(uint64_t));
@@ -895,7 +1037,7 @@ int mclBnFp_powArray(mclBnFp *z, const mclBnFp *x, const uint8_t *y, mclSize ySi
 
 mclSize mclBnFr_invVec(mclBnFr *y, const mclBnFr *x, mclSize n)
 {
-	return mcl::invVec(cast(y), cast(x), n);
+	return Fr::invVec(cast(y), cast(x), n);
 }
 
 mclSize mclBnFp_invVec(mclBnFp *y, const mclBnFp *x, mclSize n)
@@ -24,6 +24,9 @@
 #include <cybozu/itoa.hpp>
 #include <mcl/randgen.hpp>
 #include "llvm_proto.hpp"
+#ifdef MCL_SHA256_X64
+#include "sha256_x64.hpp"
+#endif
 
 #ifdef _MSC_VER
 	#pragma warning(push)
@@ -192,6 +195,176 @@ void expand_message_xmd(uint8_t out[], size_t outSize, const void *msg, size_t m
 	}
 }
 
+#ifdef MCL_SHA256_X64
+namespace sha256_mb {
+
+static const uint32_t g_iv[8] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+/*
+	SHA-256 of msg | suffix whose first prefixSize bytes (a multiple of 64) are already compressed into h
+	the full blocks of msg are read in place and the rest is padded in tail
+*/
+struct Job {
+	uint32_t h[8];
+	const uint8_t *msg;
+	size_t fullN;
+	size_t tailN;
+	uint8_t tail[64 * 6];
+	// suffixSize <= 2 + 1 + 255 + 1
+	void init(const uint32_t h0[8], size_t prefixSize, const void *_msg, size_t msgSize, const uint8_t *suffix, size_t suffixSize)
+	{
+		memcpy(h, h0, sizeof(h));
+		msg = (const uint8_t*)_msg;
+		fullN = msgSize / 64;
+		const size_t rem = msgSize % 64;
+		if (rem > 0) memcpy(tail, msg + fullN * 64, rem);
+		if (suffixSize > 0) memcpy(tail + rem, suffix, suffixSize);
+		size_t pos = rem + suffixSize;
+		tail[pos++] = 0x80;
+		tailN = (pos + 8 + 63) / 64;
+		memset(tail + pos, 0, tailN * 64 - 8 - pos);
+		cybozu::Set64bitAsBE(tail + tailN * 64 - 8, (prefixSize + msgSize + suffixSize) * 8);
+	}
+	size_t blockN() const { return fullN + tailN; }
+	const uint8_t *getBlock(size_t i) const { return i < fullN ? msg + i * 64 : tail + (i - fullN) * 64; }
+	void getDigest(uint8_t md[32]) const
+	{
+		for (size_t i = 0; i < 8; i++) {
+			cybozu::Set32bitAsBE(md + i * 4, h[i]);
+		}
+	}
+};
+
+// return true if hashJobs is available
+inline bool isAvailable()
+{
+	return (mcl::bint::g_cpuType & (mcl::bint::tSHA | mcl::bint::tAVX2)) != 0;
+}
+
+// compute jobs[0:n] for n <= 8
+inline void hashJobs(Job *jobs, size_t n)
+{
+	assert(n <= 8);
+	if (mcl::bint::g_cpuType & mcl::bint::tSHA) {
+		for (size_t i = 0; i < n; i++) {
+			Job& job = jobs[i];
+			mcl::sha256::compressSHANI(job.h, job.msg, job.fullN);
+			mcl::sha256::compressSHANI(job.h, job.tail, job.tailN);
+		}
+		return;
+	}
+	static const uint8_t dummy[64] = {};
+	uint32_t h[64];
+	const uint8_t *buf[8];
+	size_t maxN = 0;
+	for (size_t j = 0; j < 8; j++) {
+		for (size_t i = 0; i < 8; i++) {
+			h[i * 8 + j] = j < n ? jobs[j].h[i] : 0;
+		}
+		if (j < n) maxN = fp::max_(maxN, jobs[j].blockN());
+	}
+	for (size_t k = 0; k < maxN; k++) {
+		uint32_t mask = 0;
+		for (size_t j = 0; j < 8; j++) {
+			if (j < n && k < jobs[j].blockN()) {
+				buf[j] = jobs[j].getBlock(k);
+				mask |= 1u << j;
+			} else {
+				buf[j] = dummy;
+			}
+		}
+		mcl::sha256::compressAVX2x8(h, buf, mask);
+	}
+	for (size_t j = 0; j < n; j++) {
+		for (size_t i = 0; i < 8; i++) {
+			jobs[j].h[i] = h[i * 8 + j];
+		}
+	}
+}
+
+/*
+	b_0 = H(Z_pad | msg | BE(outSize, 2) | BE(0, 1) | DST | BE(dstSize, 1))
+	b_1 = H(b_0 | BE(1, 1) | DST | BE(dstSize, 1))
+	b_i = H((b_0 ^ b_{i-1}) | BE(i, 1) | DST | BE(dstSize, 1)) for i > 1
+	compute b_0 of N messages at once and then b_i of them at once
+*/
+inline void expand_message_xmd_vec(uint8_t *out, size_t outSize, const void *const *msgVec, const size_t *msgSizeVec, size_t n, const void *dst, size_t dstSize)
+{
+	const size_t mdSize = 32;
+	assert((outSize % mdSize) == 0 && 0 < outSize && outSize <= 256);
+	const size_t ell = outSize / mdSize;
+	uint8_t largeDst[mdSize];
+	if (dstSize > 255) {
+		cybozu::Sha256 h;
+		h.update("H2C-OVERSIZE-DST-", 17);
+		h.digest(largeDst, mdSize, dst, dstSize);
+		dst = largeDst;
+		dstSize = mdSize;
+	}
+	// the state after Z_pad (a zero block) is common to all messages
+	uint32_t zPadState[8];
+	{
+		static const uint8_t Z_pad[64] = {};
+		Job job;
+		job.init(g_iv, 0, Z_pad, sizeof(Z_pad), 0, 0);
+		job.tailN = 0; // skip the padding
+		hashJobs(&job, 1);
+		memcpy(zPadState, job.h, sizeof(zPadState));
+	}
+	uint8_t suffix[2 + 1 + 255 + 1];
+	cybozu::Set16bitAsBE(suffix, uint16_t(outSize));
+	memcpy(suffix + 3, dst, dstSize);
+	suffix[3 + dstSize] = uint8_t(dstSize);
+	const size_t N = 8;
+	Job jobs[N];
+	uint8_t b0[N][mdSize];
+	uint8_t x[N][mdSize];
+	for (size_t i = 0; i < n; i += N) {
+		const size_t m = fp::min_(n - i, N);
+		suffix[2] = 0;
+		for (size_t j = 0; j < m; j++) {
+			jobs[j].init(zPadState, 64, msgVec[i + j], msgSizeVec[i + j], suffix, 2 + 1 + dstSize + 1);
+		}
+		hashJobs(jobs, m);
+		for (size_t j = 0; j < m; j++) {
+			jobs[j].getDigest(b0[j]);
+			memcpy(x[j], b0[j], mdSize);
+		}
+		for (size_t k = 0; k < ell; k++) {
+			suffix[2] = uint8_t(k + 1);
+			for (size_t j = 0; j < m; j++) {
+				jobs[j].init(g_iv, 0, x[j], mdSize, suffix + 2, 1 + dstSize + 1);
+			}
+			hashJobs(jobs, m);
+			for (size_t j = 0; j < m; j++) {
+				uint8_t *bk = out + (i + j) * outSize + k * mdSize;
+				jobs[j].getDigest(bk);
+				for (size_t t = 0; t < mdSize; t++) {
+					x[j][t] = b0[j][t] ^ bk[t];
+				}
+			}
+		}
+	}
+}
+
+} // mcl::fp::sha256_mb
+#endif
+
+void expand_message_xmd_vec(uint8_t *out, size_t outSize, const void *const *msgVec, const size_t *msgSizeVec, size_t n, const void *dst, size_t dstSize)
+{
+#ifdef MCL_SHA256_X64
+	if (sha256_mb::isAvailable()) {
+		sha256_mb::expand_message_xmd_vec(out, outSize, msgVec, msgSizeVec, n, dst, dstSize);
+		return;
+	}
+#endif
+	for (size_t i = 0; i < n; i++) {
+		expand_message_xmd(out + i * outSize, outSize, msgVec[i], msgSizeVec[i], dst, dstSize);
+	}
+}
+
 /*
 	inv(xR) = (1/x)R^-1 -toMont-> 1/x -toMont-> (1/x)R
 */
@@ -613,6 +786,9 @@ void initForSecp256k1()
 	typedef GLV1T<G1> GLV1;
 	GLV1::initForSecp256k1();
 	G1::setMulVecGLV(mcl::ec::mulVecGLVT<GLV1, G1>);
+#ifdef MCL_USE_OMP
+	G1::setMulVecGLVMT(mcl::ec::mulVecGLVMT<GLV1, G1>);
+#endif
 }
 
 } // mcl
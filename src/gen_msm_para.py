@@ -38,6 +38,14 @@ def expandN3(name, vx, vy, vz, n=1):
     print(('\t' + f'{hex(vz[i])}, '*n*8).strip())
   print('};')
 
+# concat arrays (e.g. FpM2 = (a, b), EcM2 = (x.a, x.b, y.a, y.b, z.a, z.b))
+def expandList(name, vs):
+  print(f'static const CYBOZU_ALIGN(64) uint64_t {name}_[] = {{')
+  for v in vs:
+    for i in range(len(v)):
+      print(('\t' + f'{hex(v[i])}, '*8).strip())
+  print('};')
+
 def putCode(curve, mont):
   p = curve.p
   if (p+1)%4 == 0:
@@ -78,12 +86,33 @@ def putCode(curve, mont):
     expandN3('g_zeroJacobi', toArray(0), toArray(0), toArray(0), n)
     expandN3('g_zeroProj', toArray(0), toArray(1), toArray(0), n)
 
+  # for FpM2/EcM2 (G2)
+  zero = toArray(0)
+  expandList('g_one2', [toArray(mont.R), zero]) # FpM2::one()
+  expandList('g_zeroJacobi2', [zero]*6)
+  expandList('g_zeroProj2', [zero, zero, toArray(1), zero, zero, zero])
+
   print(f'''
 struct G {{
 	static const Vec& mask() {{ return *(const Vec*)g_mask_; }}
 	static const Vec& rp() {{ return *(const Vec*)g_rp_; }}
 	static const Vec* ap() {{ return (const Vec*)g_ap_; }}
 }};
+''')
+
+  # for FrM (Fr = Z/rZ with the same Montgomery form R = 2^256 as Fr)
+  r = curve.r
+  frMont = Montgomery(r)
+  print(f'static const size_t g_frN = {frMont.N};')
+  expand('g_frRp', frMont.rp)
+  expandN('g_frAp', frMont.toArray(r))
+  expandN('g_frR', frMont.toArray(2**256 % r)) # FrM::one()
+  print(f'''
+struct GFr {{
+	static const Vec& mask() {{ return *(const Vec*)g_mask_; }}
+	static const Vec& rp() {{ return *(const Vec*)g_frRp_; }}
+	static const Vec* ap() {{ return (const Vec*)g_frAp_; }}
+}};
 ''')
 
 def main():
@@ -2,6 +2,8 @@
 
 namespace mcl {
 
+class Fp2;
+
 namespace ec {
 
 inline size_t ilog2(size_t n)
@@ -116,8 +118,6 @@ inline void optimizedSplitRawForBLS12_377(Unit *a, Unit *b, const Unit *x)
 	}
 }
 
-#ifndef MCL_GLV_ONLY_FUNC
-
 #ifndef MCL_MAX_N_TO_USE_STACK_FOR_MUL_VEC
 	// use (1 << glvGetBucketSize(n)) * sizeof(G) bytes stack + alpha
 	// about 18KiB (G1) or 36KiB (G2) for n = 1024
@@ -215,9 +215,319 @@ main:
 #endif
 	return n;
 }
+#ifndef MCL_MIN_N_TO_USE_AFFINE_FOR_MUL_VEC
+	// use mulVecAffine if n >= this value
+	#define MCL_MIN_N_TO_USE_AFFINE_FOR_MUL_VEC 2048
+#endif
+#ifndef MCL_MIN_N_TO_USE_AFFINE_FOR_MUL_VEC_G2
+	// the same for the curves over Fp2 such as G2
+	#define MCL_MIN_N_TO_USE_AFFINE_FOR_MUL_VEC_G2 2048
+#endif
+
+/*
+	add xVec[i] to the buckets tbl[v] in affine coordinates
+	the additions in a batch share one inversion by Montgomery's trick
+	P + Q costs about 6M (3M for the inversion and 2M + 1S) while a mixed Jacobi addition costs about 11M
+	a bucket is used at most once in a batch
+*/
+template<class G>
+struct MulVecAffineBatch {
+	typedef typename G::Fp F;
+	static const size_t batchN = 512;
+	G *tbl;
+	const G *xVec;
+	F *d; // denominators of lambda
+	F *t; // work area for invVecWork
+	uint32_t *bucketIdx;
+	uint32_t *pointIdx;
+	uint32_t *stamp; // stamp[v] == cur if tbl[v] is used in the current batch
+	uint32_t cur;
+	size_t m; // the num of additions in the current batch
+	// byte size of the work area for tblN buckets
+	static size_t getWorkSize(size_t tblN)
+	{
+		return sizeof(F) * batchN * 2 + sizeof(uint32_t) * (batchN * 2 + tblN);
+	}
+	MulVecAffineBatch(G *tbl, const G *xVec, size_t tblN, void *work)
+		: tbl(tbl), xVec(xVec), cur(1), m(0)
+	{
+		d = (F*)work;
+		t = d + batchN;
+		bucketIdx = (uint32_t*)(t + batchN);
+		pointIdx = bucketIdx + batchN;
+		stamp = pointIdx + batchN;
+		for (size_t i = 0; i < tblN; i++) {
+			stamp[i] = 0;
+		}
+	}
+	/*
+		tbl[v] += xVec[i] (tbl[v] and xVec[i] are normalized)
+		return false if tbl[v] is already used in the current batch
+	*/
+	bool add(size_t v, size_t i)
+	{
+		if (stamp[v] == cur) return false;
+		G& R = tbl[v];
+		const G& P = xVec[i];
+		if (R.isZero()) {
+			R = P;
+			return true;
+		}
+		if (R.x == P.x) {
+			if (R.y != P.y) {
+				R.clear();
+				return true;
+			}
+			// lambda = (3x^2 + a) / 2y
+			F::add(d[m], R.y, R.y);
+		} else {
+			// lambda = (y2 - y1) / (x2 - x1)
+			F::sub(d[m], P.x, R.x);
+		}
+		stamp[v] = cur;
+		bucketIdx[m] = uint32_t(v);
+		pointIdx[m] = uint32_t(i);
+		m++;
+		if (m == batchN) flush();
+		return true;
+	}
+	void flush()
+	{
+		if (m == 0) return;
+		mcl::local::invVecWork(d, d, m, t);
+		for (size_t k = 0; k < m; k++) {
+			G& R = tbl[bucketIdx[k]];
+			const G& P = xVec[pointIdx[k]];
+			F L, x3, y3;
+			if (R.x == P.x) {
+				F::sqr(x3, R.x);
+				F::add(L, x3, x3);
+				L += x3;
+				if (!G::a_.isZero()) L += G::a_;
+			} else {
+				F::sub(L, P.y, R.y);
+			}
+			L *= d[k];
+			F::sqr(x3, L);
+			x3 -= R.x;
+			x3 -= P.x;
+			F::sub(y3, R.x, x3);
+			y3 *= L;
+			F::sub(R.y, y3, R.y);
+			R.x = x3;
+		}
+		m = 0;
+		cur++;
+	}
+};
+
+// the w bits of yVec[i] starting at the pos-th bit
+struct MulVecDigit {
+	const Unit *yVec;
+	size_t yUnitSize;
+	size_t next;
+	size_t pos;
+	Unit mask;
+	MulVecDigit(const Unit *yVec, size_t yUnitSize, size_t next, size_t pos, Unit mask)
+		: yVec(yVec), yUnitSize(yUnitSize), next(next), pos(pos), mask(mask)
+	{
+	}
+	Unit operator()(size_t i) const
+	{
+		return fp::getUnitAt(yVec + next * i, yUnitSize, pos) & mask;
+	}
+};
+
+/*
+	tbl[v-1] += xVec[i] for v = getDigit(i) by MulVecAffineBatch
+	queue : work area of n elements
+	@note xVec should be normalized
+*/
+template<class G, class GetDigit>
+void mulVecAddTableAffine(G *tbl, size_t tblN, MulVecAffineBatch<G>& batch, uint32_t *queue, const G *xVec, const GetDigit& getDigit, size_t n)
+{
+	// use Jacobi additions for the rest if a batch has fewer additions than this value
+	const size_t minBatchN = 32;
+	for (size_t i = 0; i < tblN; i++) {
+		tbl[i].clear();
+	}
+	size_t queueN = 0;
+	for (size_t i = 0; i < n; i++) {
+		Unit v = getDigit(i);
+		if (v == 0 || xVec[i].isZero()) continue;
+		if (!batch.add(v - 1, i)) queue[queueN++] = uint32_t(i);
+	}
+	// retry the additions to the buckets used twice in a batch
+	for (;;) {
+		batch.flush();
+		if (queueN < minBatchN) break;
+		size_t remain = 0;
+		for (size_t j = 0; j < queueN; j++) {
+			const uint32_t i = queue[j];
+			if (!batch.add(getDigit(i) - 1, i)) queue[remain++] = i;
+		}
+		if (queueN - remain < minBatchN) {
+			batch.flush();
+			queueN = remain;
+			break;
+		}
+		queueN = remain;
+	}
+	for (size_t j = 0; j < queueN; j++) {
+		const uint32_t i = queue[j];
+		tbl[getDigit(i) - 1] += xVec[i];
+	}
+}
+
+// win (+)= sum_{i=0}^{tblN-1} (i+1) tbl[i]
+template<class G>
+void mulVecSumTable(G& win, const G *tbl, size_t tblN, bool first)
+{
+	G sum = tbl[tblN - 1];
+	if (first) {
+		win = sum;
+	} else {
+		win += sum;
+	}
+	for (size_t i = 1; i < tblN; i++) {
+		sum += tbl[tblN - 1 - i];
+		win += sum;
+	}
+}
+
+// same as mulVecUpdateTable but tbl[] are updated by MulVecAffineBatch
+template<class G>
+void mulVecUpdateTableAffine(G& win, G *tbl, size_t tblN, MulVecAffineBatch<G>& batch, uint32_t *queue, const G *xVec, const Unit *yVec, size_t yUnitSize, size_t next, size_t pos, size_t n, bool first)
+{
+	mulVecAddTableAffine(tbl, tblN, batch, queue, xVec, MulVecDigit(yVec, yUnitSize, next, pos, tblN), n);
+	mulVecSumTable(win, tbl, tblN, first);
+}
+
+/*
+	z = sum_{i=0}^{n-1} xVec[i] * yVec[i] with buckets in affine coordinates
+	return false if malloc fails
+	@note xVec may be normlized
+	fast for large n
+*/
+template<class G>
+bool mulVecAffine(G& z, G *xVec, const Unit *yVec, size_t yUnitSize, size_t next, size_t n, size_t b, bool doNormalize)
+{
+	typedef MulVecAffineBatch<G> Batch;
+	if (b == 0) b = glvGetBucketSize(n);
+	const size_t tblN = (size_t(1) << b) - 1;
+	const size_t maxBitSize = sizeof(Unit) * yUnitSize * 8;
+	const size_t winN = (maxBitSize + b-1) / b;
+
+	const size_t workSize = Batch::getWorkSize(tblN);
+	G *tbl = (G*)malloc(sizeof(G) * tblN + workSize + sizeof(uint32_t) * n);
+	if (tbl == 0) return false;
+	Batch batch(tbl, xVec, tblN, tbl + tblN);
+	uint32_t *queue = (uint32_t*)((char*)(tbl + tblN) + workSize);
+
+	if (doNormalize) G::normalizeVec(xVec, xVec, n);
+
+	mulVecUpdateTableAffine(z, tbl, tblN, batch, queue, xVec, yVec, yUnitSize, next, b * (winN-1), n, true);
+	for (size_t w = 1; w < winN; w++) {
+		for (size_t i = 0; i < b; i++) {
+			G::dbl(z, z);
+		}
+		mulVecUpdateTableAffine(z, tbl, tblN, batch, queue, xVec, yVec, yUnitSize, next, b * (winN-1-w), n, false);
+	}
+	free(tbl);
+	return true;
+}
+
+/*
+	tbl[i * winN + k] = 2^(c k) xVec[i] (normalized) for i < n, k < winN
+*/
+template<class G>
+void mulVecFixedBasePrecompute(G *tbl, const G *xVec, size_t n, size_t c, size_t winN)
+{
+	for (size_t i = 0; i < n; i++) {
+		G t = xVec[i];
+		for (size_t k = 0; k < winN; k++) {
+			tbl[i * winN + k] = t;
+			if (k == winN - 1) break;
+			for (size_t j = 0; j < c; j++) {
+				G::dbl(t, t);
+			}
+		}
+	}
+	G::normalizeVec(tbl, tbl, n * winN);
+}
+
+// the c bits of yVec[i / winN] starting at the (c * (i % winN))-th bit
+struct MulVecFixedBaseDigit {
+	const Unit *yVec;
+	size_t yUnitSize;
+	size_t c;
+	size_t winN;
+	Unit mask;
+	MulVecFixedBaseDigit(const Unit *yVec, size_t yUnitSize, size_t c, size_t winN)
+		: yVec(yVec), yUnitSize(yUnitSize), c(c), winN(winN), mask((Unit(1) << c) - 1)
+	{
+	}
+	Unit operator()(size_t i) const
+	{
+		const size_t q = i / winN;
+		const size_t r = i % winN;
+		return fp::getUnitAt(yVec + yUnitSize * q, yUnitSize, c * r) & mask;
+	}
+};
+
+/*
+	z = sum_{i=0}^{n-1} xVec[i] * yVec[i] with tbl made by mulVecFixedBasePrecompute
+	all windows are added to the same buckets, so no doubling is necessary
+	yVec[i] means yVec[i*yUnitSize:(i+1)*yUnitSize]
+	return false if malloc fails
+*/
+template<class G>
+bool mulVecFixedBase(G& z, const G *tbl, size_t c, size_t winN, const Unit *yVec, size_t yUnitSize, size_t n)
+{
+	typedef MulVecAffineBatch<G> Batch;
+	const size_t tblN = (size_t(1) << c) - 1;
+	const size_t workSize = Batch::getWorkSize(tblN);
+	G *buckets = (G*)malloc(sizeof(G) * tblN + workSize + sizeof(uint32_t) * n * winN);
+	if (buckets == 0) return false;
+	Batch batch(buckets, tbl, tblN, buckets + tblN);
+	uint32_t *queue = (uint32_t*)((char*)(buckets + tblN) + workSize);
+	mulVecAddTableAffine(buckets, tblN, batch, queue, tbl, MulVecFixedBaseDigit(yVec, yUnitSize, c, winN), n * winN);
+	mulVecSumTable(z, buckets, tblN, true);
+	free(buckets);
+	return true;
+}
+
+// mulVecAffine is available only for elliptic curves
+template<class G>
+struct MulVecAffineT {
+	static bool mulVec(G&, G *, const Unit *, size_t, size_t, size_t, size_t, bool) { return false; }
+};
+
+template<class Fp>
+struct MulVecAffineMinN {
+	static const size_t value = MCL_MIN_N_TO_USE_AFFINE_FOR_MUL_VEC;
+};
+
+template<>
+struct MulVecAffineMinN<mcl::Fp2> {
+	static const size_t value = MCL_MIN_N_TO_USE_AFFINE_FOR_MUL_VEC_G2;
+};
+
+template<class Fp>
+struct MulVecAffineT<EcT<Fp> > {
+	static bool mulVec(EcT<Fp>& z, EcT<Fp> *xVec, const Unit *yVec, size_t yUnitSize, size_t next, size_t n, size_t b, bool doNormalize)
+	{
+		if (n < MulVecAffineMinN<Fp>::value) return false;
+		return mulVecAffine(z, xVec, yVec, yUnitSize, next, n, b, doNormalize);
+	}
+};
+
 template<class G>
 void mulVecLong(G& z, G *xVec, const Unit *yVec, size_t yUnitSize, size_t next, size_t n, size_t b, bool doNormalize)
 {
+#ifndef MCL_DONT_USE_MALLOC
+	if (MulVecAffineT<G>::mulVec(z, xVec, yVec, yUnitSize, next, n, b, doNormalize)) return;
+#endif
 	size_t done = mulVecCore(z, xVec, yVec, yUnitSize, next, n, b, doNormalize);
 	if (done == n) return;
 	do {
@@ -230,32 +540,127 @@ void mulVecLong(G& z, G *xVec, const Unit *yVec, size_t yUnitSize, size_t next,
 	} while (done < n);
 }
 
-// for n >= 128
+#ifdef MCL_USE_OMP
+/*
+	tbl[v-lo] += xVec[i] for v = digit[i] in [lo, hi)
+	win = lo tbl[0] + (lo+1) tbl[1] + ... + (hi-1) tbl[hi-lo-1]
+*/
+template<class G>
+void mulVecUpdateTableRange(G& win, G *tbl, size_t lo, size_t hi, const G *xVec, const uint32_t *digit, size_t n)
+{
+	const size_t tblSize = hi - lo;
+	for (size_t i = 0; i < tblSize; i++) {
+		tbl[i].clear();
+	}
+	for (size_t i = 0; i < n; i++) {
+		size_t v = digit[i];
+		if (lo <= v && v < hi) {
+			tbl[v - lo] += xVec[i];
+		}
+	}
+	G sum = tbl[tblSize - 1];
+	win = sum;
+	for (size_t i = 1; i < tblSize; i++) {
+		sum += tbl[tblSize - 1 - i];
+		win += sum;
+	}
+	// win = sum_i (i+1) tbl[i], so add (lo-1) sum_i tbl[i]
+	if (lo > 1) {
+		G t;
+		Unit c = lo - 1;
+		G::mulArray(t, sum, &c, 1);
+		win += t;
+	}
+}
+
+/*
+	multi thread version of mulVecCore
+	the tasks are pairs of (window, range of buckets) instead of ranges of xVec,
+	so the doublings are not duplicated and each bucket sees all n points.
+	return false if malloc fails
+	@note xVec should be normalized
+*/
+template<class G>
+bool mulVecCoreMT(G& z, const G *xVec, const Unit *yVec, size_t yUnitSize, size_t next, size_t n, size_t b, size_t cpuN)
+{
+	if (b == 0) b = glvGetBucketSize(n);
+	const size_t tblN = (size_t(1) << b) - 1;
+	const size_t maxBitSize = sizeof(Unit) * yUnitSize * 8;
+	const size_t winN = (maxBitSize + b-1) / b;
+	/*
+		a task handles tblN/rangeN buckets of a window and reads xVec sparsely,
+		so choose small rangeN minimizing the load ceil(winN * rangeN / cpuN) / rangeN
+	*/
+	const size_t minRangeN = (cpuN + winN - 1) / winN;
+	size_t rangeN = minRangeN;
+	for (size_t r = minRangeN + 1; r <= minRangeN * 4; r++) {
+		// ceil(winN * r / cpuN) / r < ceil(winN * rangeN / cpuN) / rangeN
+		if (((winN * r + cpuN - 1) / cpuN) * rangeN < ((winN * rangeN + cpuN - 1) / cpuN) * r) {
+			rangeN = r;
+		}
+	}
+	if (rangeN > tblN) rangeN = tblN;
+	const size_t rangeSize = (tblN + rangeN - 1) / rangeN;
+	rangeN = (tblN + rangeSize - 1) / rangeSize;
+	const size_t taskN = winN * rangeN;
+
+	G *tbl = (G*)malloc(sizeof(G) * (rangeSize * cpuN + taskN) + sizeof(uint32_t) * winN * n);
+	if (tbl == 0) return false;
+	G *wins = tbl + rangeSize * cpuN;
+	uint32_t *digits = (uint32_t*)(wins + taskN);
+
+	#pragma omp parallel for num_threads(int(cpuN))
+	for (size_t i = 0; i < n; i++) {
+		for (size_t w = 0; w < winN; w++) {
+			digits[w * n + i] = uint32_t(fp::getUnitAt(yVec + next * i, yUnitSize, b * w) & tblN);
+		}
+	}
+	#pragma omp parallel for schedule(dynamic) num_threads(int(cpuN))
+	for (size_t i = 0; i < taskN; i++) {
+		const size_t w = i / rangeN;
+		const size_t lo = (i % rangeN) * rangeSize + 1;
+		const size_t hi = fp::min_(lo + rangeSize, tblN + 1);
+		G *threadTbl = tbl + rangeSize * omp_get_thread_num();
+		mulVecUpdateTableRange(wins[i], threadTbl, lo, hi, xVec, digits + w * n, n);
+	}
+	z.clear();
+	for (size_t w = 0; w < winN; w++) {
+		for (size_t i = 0; i < b; i++) {
+			G::dbl(z, z);
+		}
+		const G *win = wins + (winN - 1 - w) * rangeN;
+		for (size_t i = 0; i < rangeN; i++) {
+			z += win[i];
+		}
+	}
+	free(tbl);
+	return true;
+}
+#endif
+
+#ifndef MCL_GLV_ONLY_FUNC
+
+/*
+	split yVec[i] = sum_j u[j] L^j for i in [begin, end)
+	tbl[j * n + i] = sign(u[j]) L^j xVec[i]
+	yp[(j * n + i) * next] = |u[j]|
+	@note tbl[0, n) is normalized xVec
+*/
 template<class GLV, class G>
-bool mulVecGLVlarge(G& z, const G *xVec, const void *yVec, size_t n, size_t bucket)
+void mulVecGLVsplit(G *tbl, Unit *yp, const void *yVec, size_t n, size_t begin, size_t end)
 {
 	const int splitN = GLV::splitN;
-	assert(n > 0);
 	typedef Fr F;
 	fp::getMpzAtType getMpzAt = fp::getMpzAtT<F>;
-	typedef mcl::Unit Unit;
 	const size_t next = F::getUnitSize();
 	mpz_class u[splitN], y;
 
-	const size_t tblByteSize = sizeof(G) * splitN * n;
-	const size_t ypByteSize = sizeof(Unit) * next * splitN * n;
-	G *tbl = (G*)malloc(tblByteSize + ypByteSize);
-	if (tbl == 0) return false;
-
-	Unit *yp = (Unit *)(tbl + splitN * n);
-
-	G::normalizeVec(tbl, xVec, n);
 	for (int i = 1; i < splitN; i++) {
-		for (size_t j = 0; j < n; j++) {
+		for (size_t j = begin; j < end; j++) {
 			GLV::mulLambda(tbl[i * n + j], tbl[(i - 1) * n + j]);
 		}
 	}
-	for (size_t i = 0; i < n; i++) {
+	for (size_t i = begin; i < end; i++) {
 		getMpzAt(y, yVec, i);
 		GLV::split(u, y);
 		for (size_t j = 0; j < splitN; j++) {
@@ -269,11 +674,71 @@ bool mulVecGLVlarge(G& z, const G *xVec, const void *yVec, size_t n, size_t buck
 			assert(b); (void)b;
 		}
 	}
+}
+
+// for n >= 128
+template<class GLV, class G>
+bool mulVecGLVlarge(G& z, const G *xVec, const void *yVec, size_t n, size_t bucket)
+{
+	const int splitN = GLV::splitN;
+	assert(n > 0);
+	typedef Fr F;
+	typedef mcl::Unit Unit;
+	const size_t next = F::getUnitSize();
+
+	const size_t tblByteSize = sizeof(G) * splitN * n;
+	const size_t ypByteSize = sizeof(Unit) * next * splitN * n;
+	G *tbl = (G*)malloc(tblByteSize + ypByteSize);
+	if (tbl == 0) return false;
+
+	Unit *yp = (Unit *)(tbl + splitN * n);
+
+	G::normalizeVec(tbl, xVec, n);
+	mulVecGLVsplit<GLV, G>(tbl, yp, yVec, n, 0, n);
 	mulVecLong(z, tbl, yp, next, next, n * splitN, false, bucket);
 	free(tbl);
 	return true;
 }
 
+#ifdef MCL_USE_OMP
+// multi thread version of mulVecGLVlarge
+template<class GLV, class G>
+bool mulVecGLVMT(G& z, const G *xVec, const void *yVec, size_t n, size_t cpuN)
+{
+	if (n < 128 || cpuN <= 1) return false;
+	const int splitN = GLV::splitN;
+	typedef Fr F;
+	typedef mcl::Unit Unit;
+	const size_t next = F::getUnitSize();
+
+	const size_t tblByteSize = sizeof(G) * splitN * n;
+	const size_t ypByteSize = sizeof(Unit) * next * splitN * n;
+	G *tbl = (G*)malloc(tblByteSize + ypByteSize);
+	if (tbl == 0) return false;
+
+	Unit *yp = (Unit *)(tbl + splitN * n);
+
+	G::normalizeVec(tbl, xVec, n);
+	const size_t q = n / cpuN;
+	const size_t r = n % cpuN;
+	#pragma omp parallel for num_threads(int(cpuN))
+	for (size_t i = 0; i < cpuN; i++) {
+		size_t begin = q * i + fp::min_(i, r);
+		mulVecGLVsplit<GLV, G>(tbl, yp, yVec, n, begin, begin + q + (i < r));
+	}
+	// skip the windows of zero
+	size_t yUnitSize = 1;
+	for (size_t i = 0; i < n * splitN; i++) {
+		yUnitSize = fp::max_(yUnitSize, bint::getRealSize(yp + i * next, next));
+	}
+	if (!mulVecCoreMT(z, tbl, yp, yUnitSize, next, n * splitN, 0, cpuN)) {
+		mulVecLong(z, tbl, yp, next, next, n * splitN, 0, false);
+	}
+	free(tbl);
+	return true;
+}
+#endif
+
 /*
 	z += xVec[i] * yVec[i] for i = 0, ..., min(N, n)
 	splitN = 2(G1) or 4(G2)
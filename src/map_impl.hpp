@@ -1,5 +1,9 @@
 #pragma once
 
+#ifdef MCL_USE_OMP
+#include <omp.h>
+#endif
+
 namespace mcl {
 
 struct MapTo {
@@ -11,18 +15,30 @@ struct MapTo {
 	Fp c1_; // sqrt(-3)
 	Fp c2_; // (-1 + sqrt(-3)) / 2
 	mpz_class z_;
+	mpz_class absZ_;
 	mpz_class z2_;
 	mpz_class cofactor_;
 	int type_;
 	int curveType_;
 	int mapToMode_;
 	MapTo_WB19 mapTo_WB19_;
+	/*
+		Q[i] = mulByCofactorBLS12fast(P[i]) for i < n (n % 8 == 0)
+		set by initPairing if AVX-512 IFMA is available
+	*/
+	typedef void (*MulByCofactorVec)(G2 *Q, const G2 *P, size_t n);
+	MulByCofactorVec mulByCofactorVecOpti_;
 	MapTo()
 		: type_(0)
 		, curveType_(0)
 		, mapToMode_(MCL_MAP_TO_MODE_ORIGINAL)
+		, mulByCofactorVecOpti_(0)
 	{
 	}
+	void setMulByCofactorVecOpti(MulByCofactorVec f)
+	{
+		mulByCofactorVecOpti_ = f;
+	}
 
 	int legendre(bool *pb, const Fp& x) const
 	{
@@ -161,6 +177,7 @@ struct MapTo {
 	void initBLS12(const mpz_class& z, int curveType)
 	{
 		z_ = z;
+		absZ_ = gmp::abs(z);
 		if (curveType == MCL_BLS12_381) {
 			const char *z2 = "396c8c005555e1560000000055555555";
 			const char *cofactor = "396c8c005555e1568c00aaab0000aaab";
@@ -354,6 +371,84 @@ MCL_DLL_API void hashAndMapToG2(G2& P, const void *buf, size_t bufSize, const ch
 {
 	mapTo.mapTo_WB19_.msgToG2(P, buf, bufSize, dst, dstSize);
 }
+namespace local {
+
+struct HashAndMapToG1 {
+	typedef G1 G;
+	static const size_t mdSize = 128;
+	static bool useXmd() { return getMapToMode() == MCL_MAP_TO_MODE_HASH_TO_CURVE_07; }
+	static const MapTo_WB19::Dst& getDst() { return mapTo.mapTo_WB19_.dstG1; }
+	static void mdToVec(G1 *P, const uint8_t *md, size_t n) { mapTo.mapTo_WB19_.mdToG1Vec(P, md, n); }
+	static void hashAndMapTo(G1& P, const void *buf, size_t bufSize) { hashAndMapToG1(P, buf, bufSize); }
+};
+
+struct HashAndMapToG2 {
+	typedef G2 G;
+	static const size_t mdSize = 256;
+	static bool useXmd()
+	{
+		int mode = getMapToMode();
+		return mode == MCL_MAP_TO_MODE_WB19 || mode >= MCL_MAP_TO_MODE_HASH_TO_CURVE_06;
+	}
+	static const MapTo_WB19::Dst& getDst() { return mapTo.mapTo_WB19_.dstG2; }
+	static void mdToVec(G2 *P, const uint8_t *md, size_t n) { mapTo.mapTo_WB19_.mdToG2Vec(P, md, n); }
+	static void hashAndMapTo(G2& P, const void *buf, size_t bufSize) { hashAndMapToG2(P, buf, bufSize); }
+};
+
+/*
+	P[begin:end] = hashAndMapTo(msgVec[begin:end])
+	expand_message_xmd of N messages are computed at once by expand_message_xmd_vec
+	and mapped by mdToG1Vec/mdToG2Vec
+*/
+template<class T>
+void hashAndMapToVecRange(typename T::G *P, const void *const *msgVec, const size_t *msgSizeVec, size_t begin, size_t end)
+{
+	if (!T::useXmd()) {
+		for (size_t i = begin; i < end; i++) {
+			T::hashAndMapTo(P[i], msgVec[i], msgSizeVec[i]);
+		}
+		return;
+	}
+	const MapTo_WB19::Dst& dst = T::getDst();
+	const size_t N = 16;
+	uint8_t md[N * T::mdSize];
+	for (size_t i = begin; i < end; i += N) {
+		const size_t m = fp::min_(end - i, N);
+		fp::expand_message_xmd_vec(md, T::mdSize, msgVec + i, msgSizeVec + i, m, dst.dst, dst.len);
+		T::mdToVec(P + i, md, m);
+	}
+}
+
+template<class T>
+void hashAndMapToVecT(typename T::G *P, const void *const *msgVec, const size_t *msgSizeVec, size_t n, size_t cpuN)
+{
+#ifdef MCL_USE_OMP
+	if (cpuN == 0) cpuN = omp_get_num_procs();
+	const size_t blockSize = 64;
+	const size_t blockN = (n + blockSize - 1) / blockSize;
+	#pragma omp parallel for num_threads(int(cpuN))
+	for (int i = 0; i < int(blockN); i++) {
+		const size_t begin = i * blockSize;
+		hashAndMapToVecRange<T>(P, msgVec, msgSizeVec, begin, fp::min_(begin + blockSize, n));
+	}
+#else
+	(void)cpuN;
+	hashAndMapToVecRange<T>(P, msgVec, msgSizeVec, 0, n);
+#endif
+}
+
+} // mcl::local
+
+MCL_DLL_API void hashAndMapToG1Vec(G1 *P, const void *const *msgVec, const size_t *msgSizeVec, size_t n, size_t cpuN)
+{
+	local::hashAndMapToVecT<local::HashAndMapToG1>(P, msgVec, msgSizeVec, n, cpuN);
+}
+
+MCL_DLL_API void hashAndMapToG2Vec(G2 *P, const void *const *msgVec, const size_t *msgSizeVec, size_t n, size_t cpuN)
+{
+	local::hashAndMapToVecT<local::HashAndMapToG2>(P, msgVec, msgSizeVec, n, cpuN);
+}
+
 // set the default dst for G1
 // return 0 if success else -1
 MCL_DLL_API bool setDstG1(const char *dst, size_t dstSize)
@@ -368,21 +463,35 @@ MCL_DLL_API bool setDstG2(const char *dst, size_t dstSize)
 }
 
 /*
-	z2 = (z^2-1)/3, c2 = (-1 + sqrt(-3))/2
-	P = (x, y), T1 = (c2 x, y), T0 = (c2^2 x, y)
-	z2(2 T0 - P - T1) == T1
+	Q = |z| P by the binary method because |z| is sparse
+	P should be normalized to use mixed additions
+*/
+template<class G>
+void mulByAbsZ(G& Q, const G& P)
+{
+	const mpz_class& absZ = mapTo.absZ_;
+	G T = P;
+	for (size_t i = gmp::getBitSize(absZ) - 1; i > 0; i--) {
+		G::dbl(T, T);
+		if (gmp::testBit(absZ, i - 1)) T += P;
+	}
+	Q = T;
+}
+
+/*
+	M. Scott, A note on group membership tests for G1, G2 and GT on BLS pairing-friendly curves
+	https://eprint.iacr.org/2021/1130
+	c2 = (-1 + sqrt(-3))/2
+	P = (x, y) is in G1 iff (c2 x, y) == -z^2 P
 */
 MCL_DLL_API bool isValidOrderBLS12(const G1& P)
 {
 	G1 T0, T1;
-	T1 = P;
-	T1.x *= mapTo.c2_;
-	T0 = T1;
+	mulByAbsZ(T0, P);
+	mulByAbsZ(T1, T0); // z^2 P
+	T0 = P;
 	T0.x *= mapTo.c2_;
-	G1::dbl(T0, T0);
-	T0 -= P;
-	T0 -= T1;
-	G1::mulGeneric(T0, T0, mapTo.z2_);
+	G1::neg(T0, T0);
 	return T0 == T1;
 }
 
@@ -391,4 +500,54 @@ void mulByCofactorBLS12fast(mcl::G2& Q, const mcl::G2& P)
 	mapTo.mulByCofactorBLS12fast(Q, P);
 }
 
+/*
+	Q = zP for normalized P (see mulByAbsZ)
+*/
+inline void mulByZ(G2& Q, const G2& P)
+{
+	mulByAbsZ(Q, P);
+	if (mapTo.z_ < 0) G2::neg(Q, Q);
+}
+
+/*
+	the same as mulByCofactorBLS12fast for n points
+	each step is applied to all points so that the points are normalized at once
+	before the multiplications by z (to use mixed additions) and at the end
+*/
+MCL_DLL_API void mulByCofactorBLS12fastVec(G2 *Q, const G2 *P, size_t n)
+{
+	if (mapTo.mulByCofactorVecOpti_) {
+		const size_t n8 = n & ~size_t(7);
+		if (n8 > 0) {
+			mapTo.mulByCofactorVecOpti_(Q, P, n8);
+			G2::normalizeVec(Q, Q, n8);
+			Q += n8;
+			P += n8;
+			n -= n8;
+		}
+	}
+	const size_t N = 32;
+	G2 A[N], T0[N];
+	for (size_t i = 0; i < n; i += N) {
+		const size_t m = fp::min_(n - i, N);
+		G2::normalizeVec(A, P + i, m);
+		for (size_t j = 0; j < m; j++) {
+			mulByZ(T0[j], A[j]);
+			T0[j] -= A[j]; // (z-1)P
+		}
+		G2::normalizeVec(T0, T0, m);
+		for (size_t j = 0; j < m; j++) {
+			G2 T1, T2;
+			mulByZ(T1, T0[j]);
+			T1 -= A[j]; // (z(z-1)-1)P
+			Frobenius(T2, T0[j]);
+			T1 += T2;
+			G2::dbl(T2, A[j]);
+			Frobenius2(T2, T2);
+			G2::add(Q[i + j], T1, T2);
+		}
+		G2::normalizeVec(Q + i, Q + i, m);
+	}
+}
+
 } // mcl
@@ -10,6 +10,7 @@
 namespace mcl {
 
 void mulByCofactorBLS12fast(G2& Q, const G2& P);
+MCL_DLL_API void mulByCofactorBLS12fastVec(G2 *Q, const G2 *P, size_t n);
 
 // y^2 = x^3 + 4(1 + i)
 template<class F>
@@ -70,7 +71,28 @@ struct MapTo_WB19 {
 	Fp g1ynum[16];
 	Fp g1yden[16];
 	mpz_class g1cofactor;
+	mpz_class g1sqrtConst; // (p - 3) / 4
 	int g1Z;
+	/*
+		y[i] = x[i]^e for i < n (n % 8 == 0)
+		set by initPairing if AVX-512 IFMA is available
+	*/
+	typedef void (*PowVecFp)(Fp *y, const Fp *x, size_t n, const Unit *e, size_t en);
+	typedef void (*PowVecFp2)(Fp2 *y, const Fp2 *x, size_t n, const Unit *e, size_t en);
+	PowVecFp powVecFp_;
+	PowVecFp2 powVecFp2_;
+	// max num of points processed at once by FpToG1Vec and Fp2ToG2Vec
+	static const size_t maxVecN = 16;
+	MapTo_WB19()
+		: powVecFp_(0)
+		, powVecFp2_(0)
+	{
+	}
+	void setPowVecOpti(PowVecFp f, PowVecFp2 f2)
+	{
+		powVecFp_ = f;
+		powVecFp2_ = f2;
+	}
 	void init()
 	{
 		bool b;
@@ -129,6 +151,7 @@ struct MapTo_WB19 {
 			g1Z = 11;
 			gmp::setStr(&b, g1cofactor, "d201000000010001", 16);
 			assert(b); (void)b;
+			g1sqrtConst = (Fp::getOp().mp - 3) / 4;
 		}
 		init_iso11();
 		const char *dst = "BLS_SIG_BLS12381G1_XMD:SHA-256_SSWU_RO_POP_";
@@ -317,6 +340,11 @@ struct MapTo_WB19 {
 	void iso11(G1& Q, E1& P) const
 	{
 		ec::normalizeJacobi(P);
+		iso11Normalized(Q, P);
+	}
+	// P must be normalized
+	void iso11Normalized(G1& Q, const E1& P) const
+	{
 		Fp xn, xd, yn, yd;
 		xn = evalPoly2(P.x, g1xnum);
 		xd = evalPoly2(P.x, g1xden);
@@ -359,15 +387,17 @@ struct MapTo_WB19 {
 		bool sign1 = isNegSign(x.b);
 		return sign0 || (zero0 & sign1);
 	}
-	// https://tools.ietf.org/html/draft-irtf-cfrg-hash-to-curve-07#appendix-D.3.5
-	void sswuG1(Fp& xn, Fp& xd, Fp& y, const Fp& u) const
+	/*
+		https://tools.ietf.org/html/draft-irtf-cfrg-hash-to-curve-07#appendix-D.3.5
+		sswuG1 = sswuG1Pre + (y = y^c1) + sswuG1Post
+		the exponentiation is shared by sswuG1Vec
+	*/
+	void sswuG1Pre(Fp& xn, Fp& xd, Fp& y, Fp& t2, Fp& t3, const Fp& u) const
 	{
 		const Fp& A = E1::a_;
 		const Fp& B = E1::b_;
-		const Fp& c1 = g1c1;
-		const Fp& c2 = g1c2;
 		const int Z = g1Z;
-		Fp u2, u2Z, t, t2, t3;
+		Fp u2, u2Z, t;
 
 		Fp::sqr(u2, u);
 		Fp::mulUnit(u2Z, u2, Z);
@@ -393,13 +423,20 @@ struct MapTo_WB19 {
 		Fp::sqr(y, t2);
 		Fp::mul(t, t3, t2);
 		y *= t;
-		Fp::pow(y, y, c1);
+	}
+	void sswuG1Post(Fp& xn, Fp& y, const Fp& t2, const Fp& t3, const Fp& u) const
+	{
+		Fp t;
+		Fp::mul(t, t3, t2);
 		y *= t;
 		Fp::sqr(t, y);
 		t *= t2;
 		if (t != t3) {
+			Fp u2, u2Z;
+			Fp::sqr(u2, u);
+			Fp::mulUnit(u2Z, u2, g1Z);
 			xn *= u2Z;
-			y *= c2;
+			y *= g1c2;
 			y *= u2;
 			y *= u;
 		}
@@ -407,28 +444,103 @@ struct MapTo_WB19 {
 			Fp::neg(y, y);
 		}
 	}
-	void sswuG1(E1& pt, const Fp& u) const
+	void sswuG1(Fp& xn, Fp& xd, Fp& y, const Fp& u) const
 	{
-		Fp xn, y;
-		Fp& xd = pt.z;
-		sswuG1(xn, xd, y, u);
+		Fp t2, t3;
+		sswuG1Pre(xn, xd, y, t2, t3, u);
+		Fp::pow(y, y, g1c1);
+		sswuG1Post(xn, y, t2, t3, u);
+	}
+	// pt.z = xd
+	void setJacobi(E1& pt, const Fp& xn, const Fp& y) const
+	{
+		const Fp& xd = pt.z;
 		Fp::mul(pt.x, xn, xd);
 		Fp::sqr(pt.y, xd);
 		pt.y *= xd;
 		pt.y *= y;
 	}
-	// https://github.com/algorand/bls_sigs_ref
-	void sswuG2(E2& P, const Fp2& t) const
+	void sswuG1(E1& pt, const Fp& u) const
 	{
-		Fp2 t2, t2xi;
+		Fp xn, y;
+		sswuG1(xn, pt.z, y, u);
+		setJacobi(pt, xn, y);
+	}
+	/*
+		y[i] = x[i]^e for i < n
+		use powVec for 8 elements at once if available
+	*/
+	template<class F, class PowVec>
+	static void powVecT(F *y, const F *x, size_t n, const mpz_class& e, PowVec powVec)
+	{
+		const size_t m = 8;
+		size_t done = 0;
+		if (powVec) {
+			const Unit *ep = gmp::getUnit(e);
+			const size_t en = gmp::getUnitSize(e);
+			done = n & ~(m - 1);
+			if (done > 0) powVec(y, x, done, ep, en);
+			// the remaining elements are computed in a padded vector if they are not few
+			if (n - done >= m / 2) {
+				F t[m];
+				for (size_t i = 0; i < m; i++) {
+					t[i] = x[done + (i < n - done ? i : 0)];
+				}
+				powVec(t, t, m, ep, en);
+				for (size_t i = done; i < n; i++) {
+					y[i] = t[i - done];
+				}
+				return;
+			}
+		}
+		for (size_t i = done; i < n; i++) {
+			F::pow(y[i], x[i], e);
+		}
+	}
+	// P[i] = sswuG1(u[i]) for i < n <= maxVecN * 2
+	void sswuG1Vec(E1 *P, const Fp *u, size_t n) const
+	{
+		assert(n <= maxVecN * 2);
+		Fp xn[maxVecN * 2], y[maxVecN * 2], t2[maxVecN * 2], t3[maxVecN * 2];
+		for (size_t i = 0; i < n; i++) {
+			sswuG1Pre(xn[i], P[i].z, y[i], t2[i], t3[i], u[i]);
+		}
+		powVecT(y, y, n, g1sqrtConst, powVecFp_);
+		for (size_t i = 0; i < n; i++) {
+			sswuG1Post(xn[i], y[i], t2[i], t3[i], u[i]);
+			setJacobi(P[i], xn[i], y[i]);
+		}
+	}
+	// intermediate values of sswuG2 used after the exponentiation
+	struct SswuG2Work {
+		Fp2 t2, t2xi, den2;
+		Fp2 x0_num, x0_den, x0_den3;
+		Fp2 gx0_num, gx0_den;
+		Fp2 tmp2;
+	};
+	/*
+		https://github.com/algorand/bls_sigs_ref
+		sswuG2 = sswuG2Pre + (candi = candi^sqrtConst) + sswuG2Post
+		the exponentiation is shared by sswuG2Vec
+	*/
+	void sswuG2Pre(Fp2& candi, SswuG2Work& w, const Fp2& t) const
+	{
+		Fp2& t2 = w.t2;
+		Fp2& t2xi = w.t2xi;
+		Fp2& den2 = w.den2;
+		Fp2& x0_num = w.x0_num;
+		Fp2& x0_den = w.x0_den;
+		Fp2& x0_den3 = w.x0_den3;
+		Fp2& gx0_num = w.gx0_num;
+		Fp2& gx0_den = w.gx0_den;
+		Fp2& tmp2 = w.tmp2;
 		Fp2::sqr(t2, t);
-		Fp2 den, den2;
+		Fp2 den;
 		mul_xi(t2xi, t2);
 		den = t2xi;
 		Fp2::sqr(den2, den);
 		// (t^2 * xi)^2 + (t^2 * xi)
 		den += den2;
-		Fp2 x0_num, x0_den;
 		Fp2::add(x0_num, den, 1);
 		x0_num *= E2::b_;
 		if (den.isZero()) {
@@ -436,13 +548,13 @@ struct MapTo_WB19 {
 		} else {
 			Fp2::mul(x0_den, -E2::a_, den);
 		}
-		Fp2 x0_den2, x0_den3, gx0_den, gx0_num;
+		Fp2 x0_den2;
 		Fp2::sqr(x0_den2, x0_den);
 		Fp2::mul(x0_den3, x0_den2, x0_den);
 		gx0_den = x0_den3;
 
 		Fp2::mul(gx0_num, E2::b_, gx0_den);
-		Fp2 tmp, tmp1, tmp2;
+		Fp2 tmp, tmp1;
 		Fp2::mul(tmp, E2::a_, x0_num);
 		tmp *= x0_den2;
 		gx0_num += tmp;
@@ -457,9 +569,14 @@ struct MapTo_WB19 {
 		Fp2::mul(tmp2, gx0_num, tmp1);
 		tmp1 *= tmp2;
 		tmp1 *= gx0_den;
-		Fp2 candi;
-		Fp2::pow(candi, tmp1, sqrtConst);
-		candi *= tmp2;
+		candi = tmp1;
+	}
+	void sswuG2Post(E2& P, Fp2& candi, const SswuG2Work& w, const Fp2& t) const
+	{
+		const Fp2& gx0_num = w.gx0_num;
+		const Fp2& gx0_den = w.gx0_den;
+		Fp2 tmp;
+		candi *= w.tmp2;
 		bool isNegT = isNegSign(t);
 		for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(root4); i++) {
 			Fp2::mul(P.y, candi, root4[i]);
@@ -469,19 +586,19 @@ struct MapTo_WB19 {
 				if (isNegSign(P.y) != isNegT) {
 					Fp2::neg(P.y, P.y);
 				}
-				Fp2::mul(P.x, x0_num, x0_den);
-				P.y *= x0_den3;
-				P.z = x0_den;
+				Fp2::mul(P.x, w.x0_num, w.x0_den);
+				P.y *= w.x0_den3;
+				P.z = w.x0_den;
 				return;
 			}
 		}
 		Fp2 x1_num, x1_den, gx1_num, gx1_den;
-		Fp2::mul(x1_num, t2xi, x0_num);
-		x1_den = x0_den;
-		Fp2::mul(gx1_num, den2, t2xi);
+		Fp2::mul(x1_num, w.t2xi, w.x0_num);
+		x1_den = w.x0_den;
+		Fp2::mul(gx1_num, w.den2, w.t2xi);
 		gx1_num *= gx0_num;
 		gx1_den = gx0_den;
-		candi *= t2;
+		candi *= w.t2;
 		candi *= t;
 		for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(etas); i++) {
 			Fp2::mul(P.y, candi, etas[i]);
@@ -501,6 +618,28 @@ struct MapTo_WB19 {
 		}
 		assert(0);
 	}
+	void sswuG2(E2& P, const Fp2& t) const
+	{
+		Fp2 candi;
+		SswuG2Work w;
+		sswuG2Pre(candi, w, t);
+		Fp2::pow(candi, candi, sqrtConst);
+		sswuG2Post(P, candi, w, t);
+	}
+	// P[i] = sswuG2(t[i]) for i < n <= maxVecN * 2
+	void sswuG2Vec(E2 *P, const Fp2 *t, size_t n) const
+	{
+		assert(n <= maxVecN * 2);
+		Fp2 candi[maxVecN * 2];
+		SswuG2Work w[maxVecN * 2];
+		for (size_t i = 0; i < n; i++) {
+			sswuG2Pre(candi[i], w[i], t[i]);
+		}
+		powVecT(candi, candi, n, sqrtConst, powVecFp2_);
+		for (size_t i = 0; i < n; i++) {
+			sswuG2Post(P[i], candi[i], w[i], t[i]);
+		}
+	}
 	template<class T>
 	void put(const T& P) const
 	{
@@ -525,6 +664,11 @@ struct MapTo_WB19 {
 	{
 		uint8_t md[256];
 		fp::expand_message_xmd(md, sizeof(md), msg, msgSize, dst, dstSize);
+		mdToFp2(out, md);
+	}
+	// md = expand_message_xmd(msg) of 256 bytes
+	void mdToFp2(Fp2 out[2], const uint8_t md[256]) const
+	{
 		Fp *x = out[0].getFp0();
 		for (size_t i = 0; i < 4; i++) {
 			bool b;
@@ -540,7 +684,52 @@ struct MapTo_WB19 {
 	}
 	void msgToG2(G2& out, const void *msg, size_t msgSize) const
 	{
-		msgToG2(out, msg, msgSize, dstG2.dst, dstG1.len);
+		msgToG2(out, msg, msgSize, dstG2.dst, dstG2.len);
+	}
+	void mdToG2(G2& out, const uint8_t md[256]) const
+	{
+		Fp2 t[2];
+		mdToFp2(t, md);
+		Fp2ToG2(out, t[0], &t[1]);
+	}
+	/*
+		out[i] = Fp2ToG2(t[i * 2], &t[i * 2 + 1]) for i < n
+		the exponentiations in sswuG2 and the cofactor clearing are computed at once
+	*/
+	void Fp2ToG2Vec(G2 *out, const Fp2 *t, size_t n) const
+	{
+		E2 P[maxVecN * 2];
+		for (size_t i = 0; i < n; i += maxVecN) {
+			const size_t m = fp::min_(n - i, maxVecN);
+			sswuG2Vec(P, t + i * 2, m * 2);
+			for (size_t j = 0; j < m; j++) {
+				ec::addJacobi(P[j], P[j * 2], P[j * 2 + 1]);
+				iso3(out[i + j], P[j]);
+			}
+			mulByCofactorBLS12fastVec(out + i, out + i, m);
+		}
+	}
+	// out[i] = mdToG2(md + 256 * i) for i < n
+	void mdToG2Vec(G2 *out, const uint8_t *md, size_t n) const
+	{
+		Fp2 t[maxVecN * 2];
+		for (size_t i = 0; i < n; i += maxVecN) {
+			const size_t m = fp::min_(n - i, maxVecN);
+			for (size_t j = 0; j < m; j++) {
+				mdToFp2(t + j * 2, md + (i + j) * 256);
+			}
+			Fp2ToG2Vec(out + i, t, m);
+		}
+	}
+	/*
+		P[i] *= g1cofactor for i < n
+		P[i] may not be in G1, so GLV (mulEach) must not be used
+	*/
+	void mulByG1cofactorVec(G1 *P, size_t n) const
+	{
+		for (size_t i = 0; i < n; i++) {
+			G1::mulGeneric(P[i], P[i], g1cofactor);
+		}
 	}
 	void FpToG1(G1& out, const Fp& u0, const Fp *u1 = 0) const
 	{
@@ -558,14 +747,61 @@ struct MapTo_WB19 {
 	{
 		uint8_t md[128];
 		fp::expand_message_xmd(md, sizeof(md), msg, msgSize, dst, dstSize);
-		Fp u[2];
+		mdToG1(out, md);
+	}
+	// md = expand_message_xmd(msg) of 128 bytes
+	void mdToFp(Fp u[2], const uint8_t md[128]) const
+	{
 		for (size_t i = 0; i < 2; i++) {
 			bool b;
 			u[i].setBigEndianMod(&b, &md[64 * i], 64);
 			assert(b); (void)b;
 		}
+	}
+	void mdToG1(G1& out, const uint8_t md[128]) const
+	{
+		Fp u[2];
+		mdToFp(u, md);
 		FpToG1(out, u[0], &u[1]);
 	}
+	/*
+		out[i] = FpToG1(u[i * 2], &u[i * 2 + 1]) for i < n
+		the exponentiations in sswuG1 are computed at once
+		and the inversions in iso11 are shared by Montgomery's trick
+	*/
+	void FpToG1Vec(G1 *out, const Fp *u, size_t n) const
+	{
+		E1 P[maxVecN * 2];
+		Fp inv[maxVecN];
+		for (size_t i = 0; i < n; i += maxVecN) {
+			const size_t m = fp::min_(n - i, maxVecN);
+			sswuG1Vec(P, u + i * 2, m * 2);
+			for (size_t j = 0; j < m; j++) {
+				ec::addJacobi(P[j], P[j * 2], P[j * 2 + 1]);
+				inv[j] = P[j].z;
+			}
+			invVec(inv, inv, m);
+			for (size_t j = 0; j < m; j++) {
+				if (!(P[j].z.isZero() || P[j].z.isOne())) {
+					ec::local::_normalizeJacobi(P[j], P[j], inv[j]);
+				}
+				iso11Normalized(out[i + j], P[j]);
+			}
+			mulByG1cofactorVec(out + i, m);
+		}
+	}
+	// out[i] = mdToG1(md + 128 * i) for i < n
+	void mdToG1Vec(G1 *out, const uint8_t *md, size_t n) const
+	{
+		Fp u[maxVecN * 2];
+		for (size_t i = 0; i < n; i += maxVecN) {
+			const size_t m = fp::min_(n - i, maxVecN);
+			for (size_t j = 0; j < m; j++) {
+				mdToFp(u + j * 2, md + (i + j) * 128);
+			}
+			FpToG1Vec(out + i, u, m);
+		}
+	}
 
 	void msgToG1(G1& out, const void *msg, size_t msgSize) const
 	{
@@ -16,6 +16,19 @@ namespace msm {
 bool initMsm(const mcl::CurveParam& cp);
 void mulVecAVX512(G1& P, G1 *x, const Fr *y, size_t n, size_t b);
 void mulEachAVX512(G1 *x, const Fr *y, size_t n);
+void mulVecAVX512G2(G2& P, G2 *x, const Fr *y, size_t n, size_t b);
+void mulEachAVX512G2(G2 *x, const Fr *y, size_t n);
+// z[i] = x[i]^y for i < n (n % 8 == 0)
+void powVecAVX512(Fp *z, const Fp *x, size_t n, const Unit *y, size_t yn);
+void powVecAVX512Fp2(Fp2 *z, const Fp2 *x, size_t n, const Unit *y, size_t yn);
+// z[i] = x[i] op y[i] for i < n (n % 8 == 0)
+void mulVecFrAVX512(Fr *z, const Fr *x, const Fr *y, size_t n);
+void addVecFrAVX512(Fr *z, const Fr *x, const Fr *y, size_t n);
+void subVecFrAVX512(Fr *z, const Fr *x, const Fr *y, size_t n);
+// y[i] = 1/x[i] (0 if x[i] = 0) for i < n (n % 8 == 0)
+void invVecFrAVX512(Fr *y, const Fr *x, size_t n);
+// Q[i] = mulByCofactorBLS12fast(P[i]) for i < n (n % 8 == 0)
+void mulByCofactorBLS12fastAVX512(G2 *Q, const G2 *P, size_t n);
 
 } // mcl::msm
 #endif
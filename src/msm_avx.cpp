@@ -63,6 +63,10 @@ struct G1A {
 	uint64_t v[6*3];
 };
 
+struct G2A {
+	uint64_t v[6*2*3];
+};
+
 static const size_t S = sizeof(Unit)*8-1; // 63
 static const size_t W = 52;
 static const size_t N = 8; // = ceil(384/52)
@@ -591,6 +595,34 @@ inline void cvtFromG1Ax(VecA *y, const Unit *x)
 	split52bit(y, t);
 }
 
+/*
+	G2(=6U x 2 x 3) x 8 => 8Ux8x2x3
+*/
+static CYBOZU_ALIGN(64) uint64_t g_pickUpEc2[] = {
+	36*0, 36*1, 36*2, 36*3, 36*4, 36*5, 36*6, 36*7,
+};
+static const Vec& v_pickUpEc2 = *(const Vec*)g_pickUpEc2;
+
+// convert G2.x.a (, x.b, y.a, ...) to Vec
+inline void cvtFromG2Ax(Vec *y, const Unit *x)
+{
+	Vec t[6];
+	for (int i = 0; i < 6; i++) {
+		t[i] = vpgatherqq(v_pickUpEc2, x+i);
+	}
+	split52bit(y, t);
+}
+
+// convert Vec to G2.x.a (, x.b, y.a, ...)
+inline void cvtToG2Ax(Unit *y, const Vec *x)
+{
+	Vec t[6];
+	concat52bit(t, x);
+	for (size_t i = 0; i < 6; i++) {
+		vpscatterqq(y+i, v_pickUpEc2, t[i]);
+	}
+}
+
 // EcM(=8Ux8x3) => G1(=6U x 3) x 8
 // convert Vec to G1.x
 inline void cvtToG1Ax(Unit *y, const Vec *x)
@@ -803,6 +835,264 @@ struct FpM : FpMT<FpM, Vmask, Vec> {
 #endif
 };
 
+/*
+	FrM : 8 lanes of Fr (256-bit) with N = 5 limbs of 52 bits
+	FrM uses the same Montgomery form R = 2^256 as Fr, so no conversion is needed
+*/
+namespace fr {
+
+static const size_t N = g_frN; // = ceil(255/52)
+static const size_t lastW = 256 - W * (N - 1); // = 48
+typedef GFr G;
+
+inline void vaddPre(Vec *z, const Vec *x, const Vec *y)
+{
+	Vec t = vpaddq(x[0], y[0]);
+	Vec c = vpsrlq(t, W);
+	z[0] = vpandq(t, G::mask());
+	for (size_t i = 1; i < N-1; i++) {
+		t = vpaddq(x[i], y[i]);
+		t = vpaddq(t, c);
+		c = vpsrlq(t, W);
+		z[i] = vpandq(t, G::mask());
+	}
+	t = vpaddq(x[N-1], y[N-1]);
+	z[N-1] = vpaddq(t, c);
+}
+
+inline Vmask vsubPre(Vec *z, const Vec *x, const Vec *y)
+{
+	Vec t = vpsubq(x[0], y[0]);
+	Vec c = vpsrlq(t, S);
+	z[0] = vpandq(t, G::mask());
+	for (size_t i = 1; i < N; i++) {
+		t = vpsubq(x[i], y[i]);
+		t = vpsubq(t, c);
+		c = vpsrlq(t, S);
+		z[i] = vpandq(t, G::mask());
+	}
+	return vpcmpneqq(c, vzero());
+}
+
+inline void uvselect(Vec *z, const Vmask& c, const Vec *a, const Vec *b)
+{
+	for (size_t i = 0; i < N; i++) {
+		z[i] = vselect(c, a[i], b[i]);
+	}
+}
+
+inline void vadd(Vec *z, const Vec *x, const Vec *y)
+{
+	Vec sN[N], tN[N];
+	vaddPre(sN, x, y);
+	Vmask c = vsubPre(tN, sN, G::ap());
+	uvselect(z, c, sN, tN);
+}
+
+inline void vsub(Vec *z, const Vec *x, const Vec *y)
+{
+	Vec sN[N], tN[N];
+	Vmask c = vsubPre(sN, x, y);
+	vaddPre(tN, sN, G::ap());
+	tN[N-1] = vpandq(tN[N-1], G::mask());
+	uvselect(z, c, tN, sN);
+}
+
+inline void vmulUnit(Vec *z, const Vec *x, const Vec& y)
+{
+	Vec H;
+	z[0] = vmulL(x[0], y);
+	H = vmulH(x[0], y);
+	for (size_t i = 1; i < N; i++) {
+		z[i] = vmulL(x[i], y, H);
+		H = vmulH(x[i], y);
+	}
+	z[N] = H;
+}
+
+inline Vec vmulUnitAdd(Vec *z, const Vec *x, const Vec& y)
+{
+	Vec H;
+	Vec v = x[0];
+	z[0] = vmulL(v, y, z[0]);
+	H = vmulH(v, y, z[1]);
+	for (size_t i = 1; i < N-1; i++) {
+		v = x[i];
+		z[i] = vmulL(v, y, H);
+		H = vmulH(v, y, z[i+1]);
+	}
+	v = x[N-1];
+	z[N-1] = vmulL(v, y, H);
+	H = vmulH(v, y);
+	return H;
+}
+
+/*
+	z = xy/2^256 mod r
+	the same as ::vmul except that the last step of the reduction is by 2^lastW
+*/
+template<class U>
+inline void vmul(Vec *z, const Vec *x, const U *y)
+{
+	const Vec lastMask = vpbroadcastq(getMask(lastW));
+	Vec t[N*2], q;
+	vmulUnit(t, x, broadcast<Vec>(y[0]));
+	q = vmulL(t[0], G::rp());
+	t[N] = vpaddq(t[N], vmulUnitAdd(t, G::ap(), q));
+	for (size_t i = 1; i < N; i++) {
+		t[N+i] = vmulUnitAdd(t+i, x, broadcast<Vec>(y[i]));
+		t[i] = vpaddq(t[i], vpsrlq(t[i-1], W));
+		q = vmulL(t[i], G::rp());
+		if (i == N-1) q = vpandq(q, lastMask);
+		t[N+i] = vpaddq(t[N+i], vmulUnitAdd(t+i, G::ap(), q));
+	}
+	for (size_t i = N; i < N*2; i++) {
+		t[i] = vpaddq(t[i], vpsrlq(t[i-1], W));
+		t[i-1] = vpandq(t[i-1], G::mask());
+	}
+	// the lower lastW bits of t[N-1] are zero
+	Vec s[N];
+	for (size_t i = 0; i < N-1; i++) {
+		s[i] = vporq(vpsrlq(t[N-1+i], lastW), vpandq(vpsllq(t[N+i], W-lastW), G::mask()));
+	}
+	s[N-1] = vporq(vpsrlq(t[N*2-2], lastW), vpsllq(t[N*2-1], W-lastW));
+	Vmask c = vsubPre(z, s, G::ap());
+	uvselect(z, c, s, z);
+}
+
+/*
+	 |64   |64   |64   |64   |
+	x|52:12|40:24|28:36|16:48|
+	y|52|52   |52   |52   |48|
+*/
+inline void split52bit4(Vec y[5], const Vec x[4])
+{
+	const Vec& m = G::mask();
+	// and(or(A, B), C) = andCorAB = 0xa8
+	const uint8_t imm = 0xA8;
+	y[0] = vpandq(x[0], m);
+	y[1] = vpternlogq<imm>(vpsrlq(x[0], 52), vpsllq(x[1], 12), m);
+	y[2] = vpternlogq<imm>(vpsrlq(x[1], 40), vpsllq(x[2], 24), m);
+	y[3] = vpternlogq<imm>(vpsrlq(x[2], 28), vpsllq(x[3], 36), m);
+	y[4] = vpsrlq(x[3], 16);
+}
+
+inline void concat52bit4(Vec y[4], const Vec x[5])
+{
+	y[0] = vporq(x[0], vpsllq(x[1], 52));
+	y[1] = vporq(vpsrlq(x[1], 12), vpsllq(x[2], 40));
+	y[2] = vporq(vpsrlq(x[2], 24), vpsllq(x[3], 28));
+	y[3] = vporq(vpsrlq(x[3], 36), vpsllq(x[4], 16));
+}
+
+static const CYBOZU_ALIGN(64) uint64_t g_pickUpFr[16] = {
+	0, 4, 8, 12, 1, 5, 9, 13,
+	2, 6, 10, 14, 3, 7, 11, 15,
+};
+
+/*
+	Fr(=4U) x 8 => 4U x 8
+	y[j] has the j-th Unit of each Fr
+	use permutations of four loads instead of gathers
+*/
+inline void cvt4Ux8toVec(Vec y[4], const Unit x[4*8])
+{
+	const Vec idx0 = vmovdqu64(g_pickUpFr);
+	const Vec idx1 = vmovdqu64(g_pickUpFr + 8);
+	Vec a[4], b[4];
+	for (size_t i = 0; i < 4; i++) {
+		a[i] = vmovdqu64(x + i * 8);
+	}
+	// b[0] = (x[0..3][0], x[0..3][1]), b[1] = (x[0..3][2], x[0..3][3])
+	b[0] = vperm2tq(a[0], idx0, a[1]);
+	b[1] = vperm2tq(a[0], idx1, a[1]);
+	b[2] = vperm2tq(a[2], idx0, a[3]);
+	b[3] = vperm2tq(a[2], idx1, a[3]);
+	y[0] = vshuffi64x2<0x44>(b[0], b[2]);
+	y[1] = vshuffi64x2<0xee>(b[0], b[2]);
+	y[2] = vshuffi64x2<0x44>(b[1], b[3]);
+	y[3] = vshuffi64x2<0xee>(b[1], b[3]);
+}
+
+// inverse of cvt4Ux8toVec
+inline void cvtVecto4Ux8(Unit y[4*8], const Vec x[4])
+{
+	const Vec idx0 = vmovdqu64(g_pickUpFr);
+	const Vec idx1 = vmovdqu64(g_pickUpFr + 8);
+	Vec a[4];
+	a[0] = vshuffi64x2<0x44>(x[0], x[1]);
+	a[1] = vshuffi64x2<0x44>(x[2], x[3]);
+	a[2] = vshuffi64x2<0xee>(x[0], x[1]);
+	a[3] = vshuffi64x2<0xee>(x[2], x[3]);
+	vmovdqu64(y + 0 * 8, vperm2tq(a[0], idx0, a[1]));
+	vmovdqu64(y + 1 * 8, vperm2tq(a[0], idx1, a[1]));
+	vmovdqu64(y + 2 * 8, vperm2tq(a[2], idx0, a[3]));
+	vmovdqu64(y + 3 * 8, vperm2tq(a[2], idx1, a[3]));
+}
+
+} // fr
+
+struct FrM {
+	Vec v[fr::N];
+	static const FrM& zero() { return *(const FrM*)g_zero_; }
+	static const FrM& one() { return *(const FrM*)g_frR_; }
+	static void add(FrM& z, const FrM& x, const FrM& y)
+	{
+		fr::vadd(z.v, x.v, y.v);
+	}
+	static void sub(FrM& z, const FrM& x, const FrM& y)
+	{
+		fr::vsub(z.v, x.v, y.v);
+	}
+	static void mul(FrM& z, const FrM& x, const FrM& y)
+	{
+		fr::vmul(z.v, x.v, y.v);
+	}
+	static void mul(FrM& z, const FrM& x, const uint64_t y[fr::N])
+	{
+		fr::vmul(z.v, x.v, y);
+	}
+	static void sqr(FrM& z, const FrM& x)
+	{
+		mul(z, x, x);
+	}
+	Vmask isZero() const
+	{
+		Vec t = v[0];
+		for (size_t i = 1; i < fr::N; i++) {
+			t = vporq(t, v[i]);
+		}
+		return vpcmpeqq(t, vzero());
+	}
+	// condition set (set x if c)
+	void cset(const Vmask& c, const FrM& x)
+	{
+		for (size_t i = 0; i < fr::N; i++) {
+			v[i] = vselect(c, x.v[i], v[i]);
+		}
+	}
+	void setFrA(const FrA v[M])
+	{
+		Vec t[4];
+		fr::cvt4Ux8toVec(t, v[0].v);
+		fr::split52bit4(this->v, t);
+	}
+	void getFrA(FrA v[M]) const
+	{
+		Vec t[4];
+		fr::concat52bit4(t, this->v);
+		fr::cvtVecto4Ux8(v[0].v, t);
+	}
+	static void inv(FrM& z, const FrM& x)
+	{
+		CYBOZU_ALIGN(64) FrA v[M];
+		mcl::Fr* vv = (mcl::Fr*)v;
+		x.getFrA(v);
+		mcl::invVec<mcl::Fr>(vv, vv, M, M);
+		z.setFrA(v);
+	}
+};
+
 // set y = 1 if isProj
 template<class E>
 inline void normalizeJacobiVec(E *P, size_t n, bool isProj = false)
@@ -1334,8 +1624,8 @@ inline size_t glvGetBucketSizeAVX512(size_t n)
 	return ret;
 }
 // xVec[n], yVec[n * maxBitSize/64]
-template<class G=EcM, class V=Vec, bool mixed = false>
-inline void mulVecAVX512_inner(G1A& P, const G *xVec, const V *yVec, size_t n, size_t maxBitSize, size_t b)
+template<class G=EcM, class V=Vec, bool mixed = false, class A=G1A>
+inline void mulVecAVX512_inner(A& P, const G *xVec, const V *yVec, size_t n, size_t maxBitSize, size_t b)
 {
 	if (b == 0) b = glvGetBucketSizeAVX512(n);
 	size_t tblN = size_t(1) << b;
@@ -1495,6 +1785,297 @@ const FpMA& EcMA::b3_ = *(const FpMA*)g_b3A_;
 const EcMA& EcMA::zeroProj_ = *(const EcMA*)g_zeroProjA_;
 const EcMA& EcMA::zeroJacobi_ = *(const EcMA*)g_zeroJacobiA_;
 
+/*
+	FpM2 = FpM[i]/(i^2 + 1) (BLS12-381)
+	(a, b) represents a + b i in each lane
+*/
+struct FpM2 {
+	typedef Vmask VM;
+	typedef Vec V;
+	FpM a, b;
+	// tag to multiply by b3 = 3 * 4(1 + i) of the twisted curve
+	struct MulB3 {};
+	static const FpM2& zero() { return *(const FpM2*)g_zeroJacobi2_; }
+	static const FpM2& one() { return *(const FpM2*)g_one2_; }
+	static void add(FpM2& z, const FpM2& x, const FpM2& y)
+	{
+		FpM::add(z.a, x.a, y.a);
+		FpM::add(z.b, x.b, y.b);
+	}
+	static void mul2(FpM2& z, const FpM2& x)
+	{
+		add(z, x, x);
+	}
+	static void sub(FpM2& z, const FpM2& x, const FpM2& y)
+	{
+		FpM::sub(z.a, x.a, y.a);
+		FpM::sub(z.b, x.b, y.b);
+	}
+	static void neg(FpM2& z, const FpM2& x)
+	{
+		FpM::neg(z.a, x.a);
+		FpM::neg(z.b, x.b);
+	}
+	FpM2 neg() const
+	{
+		FpM2 t;
+		neg(t, *this);
+		return t;
+	}
+	// (a + bi)(c + di) = (ac - bd) + ((a + b)(c + d) - ac - bd)i
+	static void mul(FpM2& z, const FpM2& x, const FpM2& y)
+	{
+		FpM t1, t2, ac, bd;
+		FpM::add(t1, x.a, x.b);
+		FpM::add(t2, y.a, y.b);
+		FpM::mul(t1, t1, t2);
+		FpM::mul(ac, x.a, y.a);
+		FpM::mul(bd, x.b, y.b);
+		FpM::sub(z.a, ac, bd);
+		FpM::sub(t1, t1, ac);
+		FpM::sub(z.b, t1, bd);
+	}
+	static void mul(FpM2& z, const FpM2& x, const uint64_t y[N])
+	{
+		FpM::mul(z.a, x.a, y);
+		FpM::mul(z.b, x.b, y);
+	}
+	// 12(1 + i)(a + bi) = 12((a - b) + (a + b)i)
+	static void mul(FpM2& z, const FpM2& x, const MulB3&)
+	{
+		FpM t;
+		FpM::sub(t, x.a, x.b);
+		FpM::add(z.b, x.a, x.b);
+		z.a = t;
+		mcl::ec::local::mul12(z);
+	}
+	// (a + bi)^2 = (a + b)(a - b) + 2abi
+	static void sqr(FpM2& z, const FpM2& x)
+	{
+		FpM t1, t2;
+		FpM::add(t1, x.a, x.b);
+		FpM::sub(t2, x.a, x.b);
+		FpM::mul(z.b, x.a, x.b);
+		FpM::mul2(z.b, z.b);
+		FpM::mul(z.a, t1, t2);
+	}
+	// 1/(a + bi) = (a - bi)/(a^2 + b^2)
+	static void inv(FpM2& z, const FpM2& x)
+	{
+		FpM t1, t2;
+		FpM::sqr(t1, x.a);
+		FpM::sqr(t2, x.b);
+		FpM::add(t1, t1, t2);
+		FpM::inv(t1, t1);
+		FpM::mul(z.a, x.a, t1);
+		FpM::mul(t1, x.b, t1);
+		FpM::neg(z.b, t1);
+	}
+	// (a + bi)^p = a - bi
+	static void Frobenius(FpM2& z, const FpM2& x)
+	{
+		z.a = x.a;
+		FpM::neg(z.b, x.b);
+	}
+	VM isEqualAll(const FpM2& rhs) const
+	{
+		return kandb(a.isEqualAll(rhs.a), b.isEqualAll(rhs.b));
+	}
+	VM isZero() const
+	{
+		return kandb(a.isZero(), b.isZero());
+	}
+	void cset(const VM& c, const FpM2& x)
+	{
+		a.cset(c, x.a);
+		b.cset(c, x.b);
+	}
+	// return c ? x : y;
+	static FpM2 select(const VM& c, const FpM2& x, const FpM2& y)
+	{
+		FpM2 d;
+		d.a = FpM::select(c, x.a, y.a);
+		d.b = FpM::select(c, x.b, y.b);
+		return d;
+	}
+	// set the same x in all lanes
+	void setFp2(const mcl::Fp2& x)
+	{
+		CYBOZU_ALIGN(64) FpA va[M], vb[M];
+		for (size_t i = 0; i < M; i++) {
+			mcl::bint::copyT<6>(va[i].v, x.a.getUnit());
+			mcl::bint::copyT<6>(vb[i].v, x.b.getUnit());
+		}
+		a.setFpA(va);
+		b.setFpA(vb);
+	}
+};
+
+static const Unit g_absZ = 0xd201000000010000; // |z| of BLS12-381
+
+/*
+	E' : y^2 = x^3 + 4(1 + i) on Fp2
+	only for BLS12-381 (not registered in init if MCL_MSM_BLS12_377 is defined)
+*/
+struct EcM2 : EcMT<EcM2, FpM2> {
+	static const int specialB_ = mcl::ec::local::GenericB;
+	static const FpM2::MulB3 b3_;
+	static const EcM2 &zeroProj_;
+	static const EcM2 &zeroJacobi_;
+	// Frobenius(x, y) = (conj(x) g2, conj(y) g3), set by initMsm
+	static FpM2 g2_;
+	static FpM2 g3_;
+	template<bool isNormalized = false>
+	void setG2A(const G2A v[M], bool JacobiToProj = true)
+	{
+		cvtFromG2Ax(x.a.v, v[0].v+0*6);
+		cvtFromG2Ax(x.b.v, v[0].v+1*6);
+		cvtFromG2Ax(y.a.v, v[0].v+2*6);
+		cvtFromG2Ax(y.b.v, v[0].v+3*6);
+		cvtFromG2Ax(z.a.v, v[0].v+4*6);
+		cvtFromG2Ax(z.b.v, v[0].v+5*6);
+
+		FpM2::mul(x, x, g_m64to52u_);
+		FpM2::mul(y, y, g_m64to52u_);
+		FpM2::mul(z, z, g_m64to52u_);
+
+		if (JacobiToProj) {
+			if (!isNormalized) mcl::ec::JacobiToProj(*this, *this);
+			y = FpM2::select(z.isZero(), FpM2::one(), y);
+		}
+	}
+	void getG2A(G2A v[M], bool ProjToJacobi = true) const
+	{
+		EcM2 T = *this;
+		if (ProjToJacobi) mcl::ec::ProjToJacobi(T, T);
+
+		FpM2::mul(T.x, T.x, g_m52to64u_);
+		FpM2::mul(T.y, T.y, g_m52to64u_);
+		FpM2::mul(T.z, T.z, g_m52to64u_);
+
+		cvtToG2Ax(v[0].v+0*6, T.x.a.v);
+		cvtToG2Ax(v[0].v+1*6, T.x.b.v);
+		cvtToG2Ax(v[0].v+2*6, T.y.a.v);
+		cvtToG2Ax(v[0].v+3*6, T.y.b.v);
+		cvtToG2Ax(v[0].v+4*6, T.z.a.v);
+		cvtToG2Ax(v[0].v+5*6, T.z.b.v);
+	}
+	void gather(const EcM2 *tbl, Vec idx)
+	{
+		const Vec factor = vpbroadcastq(6 * sizeof(Vec));
+		idx = vmulL(idx, factor, FpM::offset());
+		for (size_t i = 0; i < N; i++) {
+			x.a.v[i] = vpgatherqq(idx, &tbl[0].x.a.v[i]);
+			x.b.v[i] = vpgatherqq(idx, &tbl[0].x.b.v[i]);
+			y.a.v[i] = vpgatherqq(idx, &tbl[0].y.a.v[i]);
+			y.b.v[i] = vpgatherqq(idx, &tbl[0].y.b.v[i]);
+			z.a.v[i] = vpgatherqq(idx, &tbl[0].z.a.v[i]);
+			z.b.v[i] = vpgatherqq(idx, &tbl[0].z.b.v[i]);
+		}
+	}
+	void scatter(EcM2 *tbl, Vec idx) const
+	{
+		const Vec factor = vpbroadcastq(6 * sizeof(Vec));
+		idx = vmulL(idx, factor, FpM::offset());
+		for (size_t i = 0; i < N; i++) {
+			vpscatterqq(&tbl[0].x.a.v[i], idx, x.a.v[i]);
+			vpscatterqq(&tbl[0].x.b.v[i], idx, x.b.v[i]);
+			vpscatterqq(&tbl[0].y.a.v[i], idx, y.a.v[i]);
+			vpscatterqq(&tbl[0].y.b.v[i], idx, y.b.v[i]);
+			vpscatterqq(&tbl[0].z.a.v[i], idx, z.a.v[i]);
+			vpscatterqq(&tbl[0].z.b.v[i], idx, z.b.v[i]);
+		}
+	}
+	// same as Frobenius(G2&, const G2&) in pairing_impl.hpp
+	static void Frobenius(EcM2& Q, const EcM2& P)
+	{
+		FpM2::Frobenius(Q.x, P.x);
+		FpM2::Frobenius(Q.y, P.y);
+		FpM2::Frobenius(Q.z, P.z);
+		FpM2::mul(Q.x, Q.x, g2_);
+		FpM2::mul(Q.y, Q.y, g3_);
+	}
+	/*
+		Frob(P) = zP and z < 0
+		tbl[i] = (-Frob)^i(P)
+	*/
+	static void makeFrobTable(EcM2 *tbl, size_t d, size_t n)
+	{
+		for (size_t i = 1; i < 4; i++) {
+			for (size_t j = 0; j < n; j++) {
+				Frobenius(tbl[i*d+j], tbl[(i-1)*d+j]);
+				neg(tbl[i*d+j], tbl[i*d+j]);
+			}
+		}
+	}
+	// Q[k] = P[k] * y[k*M+i] for lane i
+	template<bool isProj=true, bool mixed=false>
+	static void mulGLV(EcM2 *Q, const EcM2 *P, const FrA *y, size_t n)
+	{
+		assert(n > 0);
+		const size_t w = 5;
+		const size_t tblN = (1<<(w-1))+1; // [0, 2^(w-1)]
+		// tbls[(i*n+k)*tblN+j] = (-Frob)^i(j P[k])
+		EcM2 *tbls = (EcM2*)Xbyak::AlignedMalloc(sizeof(EcM2) * tblN * n * 4, 64);
+		for (size_t k = 0; k < n; k++) {
+			makeTable<isProj, mixed>(tbls + tblN*k, tblN, P[k]);
+		}
+		if (!isProj && mixed) normalizeJacobiVec<EcM2>(tbls, tblN*n);
+		makeFrobTable(tbls, tblN*n, tblN*n);
+
+		for (size_t k = 0; k < n; k++) {
+			Vec a[4][2];
+			Unit *pa = (Unit*)a;
+			for (size_t i = 0; i < M; i++) {
+				Unit buf[4];
+				mcl::Fr::getOp().fromMont(buf, y[k*M+i].v);
+				for (size_t j = 0; j < 4; j++) {
+					pa[j*2*M+i] = mcl::bint::divUnit(buf, buf, 4, g_absZ);
+					pa[(j*2+1)*M+i] = 0;
+				}
+			}
+			const size_t bitLen = 64;
+			const size_t nw = (bitLen + w-1)/w;
+			Vec idxTbl[4][nw];
+			Vmask negTbl[4][nw];
+			for (size_t j = 0; j < 4; j++) {
+				makeNAFtbl<bitLen, w>(idxTbl[j], negTbl[j], a[j]);
+			}
+			for (size_t i = 0; i < nw; i++) {
+				if (i > 0) for (size_t j = 0; j < w; j++) dbl<isProj>(Q[k], Q[k]);
+				const size_t pos = nw-1-i;
+				for (size_t j = 0; j < 4; j++) {
+					EcM2 t;
+					t.gather(tbls + (j*n+k)*tblN, idxTbl[j][pos]);
+					t.y = FpM2::select(negTbl[j][pos], t.y.neg(), t.y);
+					if (i == 0 && j == 0) {
+						Q[k] = t;
+					} else {
+						add<isProj, mixed>(Q[k], Q[k], t);
+					}
+				}
+			}
+		}
+		Xbyak::AlignedFree(tbls);
+	}
+};
+
+const FpM2::MulB3 EcM2::b3_ = FpM2::MulB3();
+const EcM2& EcM2::zeroProj_ = *(const EcM2*)g_zeroProj2_;
+const EcM2& EcM2::zeroJacobi_ = *(const EcM2*)g_zeroJacobi2_;
+FpM2 EcM2::g2_;
+FpM2 EcM2::g3_;
+
+inline void reduceSum(G2A& Q, const EcM2& P)
+{
+	G2A z[M];
+	P.getG2A(z);
+	Q = z[0];
+	for (size_t i = 1; i < M; i++) {
+		mcl::G2::add((mcl::G2&)Q, (const mcl::G2&)Q, (const mcl::G2&)z[i]);
+	}
+}
+
 #define USE_GLV
 
 template<class G=EcM, class V=Vec>
@@ -1620,6 +2201,292 @@ void mulEachAVX512(G1 *_x, const Fr *_y, size_t n)
 	}
 }
 
+void mulVecAVX512G2(G2& _P, G2 *_x, const Fr *_y, size_t n, size_t b = 0)
+{
+	G2A& P = *(G2A*)&_P;
+	const G2A *x = (const G2A*)_x;
+	const FrA *y = (const FrA*)_y;
+	const size_t d = n/M;
+	const size_t e = 4; // x = u[0] + u[1] z + u[2] z^2 + u[3] z^3
+	const bool mixed = true;
+
+	EcM2 *xVec = (EcM2*)Xbyak::AlignedMalloc(sizeof(EcM2) * d * e, 64);
+	Vec *yVec = (Vec*)Xbyak::AlignedMalloc(sizeof(Vec) * d * e, 64);
+
+	for (size_t i = 0; i < d; i++) {
+		xVec[i].setG2A<mixed>(x+i*M);
+	}
+	normalizeJacobiVec(xVec, d, true);
+	EcM2::makeFrobTable(xVec, d, d);
+
+	Unit *const py = (Unit*)yVec;
+	for (size_t i = 0; i < d; i++) {
+		for (size_t j = 0; j < M; j++) {
+			Unit ya[4];
+			mcl::Fr::getOp().fromMont(ya, y[i*M+j].v);
+			for (size_t k = 0; k < e; k++) {
+				py[(k*d+i)*M+j] = mcl::bint::divUnit(ya, ya, 4, g_absZ);
+			}
+		}
+	}
+	mulVecAVX512_inner<EcM2, Vec, mixed>(P, xVec, yVec, d * e, 64, b);
+
+	Xbyak::AlignedFree(yVec);
+	Xbyak::AlignedFree(xVec);
+
+	for (size_t i = d*M; i < n; i++) {
+		G2 Q;
+		G2::mul(Q, _x[i], _y[i]);
+		G2::add(_P, _P, Q);
+	}
+}
+
+void mulEachAVX512G2(G2 *_x, const Fr *_y, size_t n)
+{
+	assert(n % M == 0);
+	const size_t d = n / M;
+	const bool isProj = false;
+	const bool mixed = true;
+	G2A *x = (G2A*)_x;
+	const FrA *y = (const FrA*)_y;
+	if (!isProj && mixed) ec::normalizeVec(_x, _x, n);
+	const size_t u = 4;
+	EcM2 P[u];
+	for (size_t i = 0; i < d; i += u) {
+		const size_t un = fp::min_(u, d - i);
+		for (size_t k = 0; k < un; k++) {
+			P[k].setG2A(x+k*M, isProj);
+		}
+		EcM2::mulGLV<isProj, mixed>(P, P, y, un);
+		for (size_t k = 0; k < un; k++) {
+			P[k].getG2A(x+k*M, isProj);
+		}
+		x += M*un;
+		y += M*un;
+	}
+}
+
+// Q = |z| P by the binary method (the same schedule for all lanes)
+inline void mulByAbsZ(EcM2& Q, const EcM2& P)
+{
+	EcM2 T = P;
+	for (int i = 62; i >= 0; i--) {
+		EcM2::dbl(T, T);
+		if ((g_absZ >> i) & 1) EcM2::add(T, T, P);
+	}
+	Q = T;
+}
+
+/*
+	Q[i] = mulByCofactorBLS12fast(P[i]) for i < n (n % 8 == 0)
+	Q = (z(z-1)-1)P + Frob((z-1)P) + Frob^2(2P) where z = -|z|
+	Q[i] are not normalized
+*/
+void mulByCofactorBLS12fastAVX512(G2 *Q, const G2 *P, size_t n)
+{
+	assert(n % M == 0);
+	const G2A *x = (const G2A*)P;
+	G2A *y = (G2A*)Q;
+	for (size_t i = 0; i < n; i += M) {
+		EcM2 A, T0, T1, T2;
+		A.setG2A(x + i);
+		mulByAbsZ(T0, A);
+		EcM2::add(T0, T0, A);
+		EcM2::neg(T0, T0); // (z-1)P
+		mulByAbsZ(T1, T0);
+		EcM2::add(T1, T1, A);
+		EcM2::neg(T1, T1); // (z(z-1)-1)P
+		EcM2::Frobenius(T0, T0);
+		EcM2::add(T0, T0, T1);
+		EcM2::dbl(T2, A);
+		EcM2::Frobenius(T2, T2);
+		EcM2::Frobenius(T2, T2);
+		EcM2::add(T0, T0, T2);
+		T0.getG2A(y + i);
+	}
+}
+
+/*
+	z = x^y where y[0:yn] is the same for all lanes
+	fixed window method (w = 4) without gather
+*/
+template<class T>
+void powSameExp(T& z, const T& x, const Unit *y, size_t yn)
+{
+	const int w = 4;
+	const size_t tblN = size_t(1) << w;
+	const size_t bitLen = sizeof(Unit)*8;
+	T tbl[tblN];
+	tbl[0] = T::one();
+	tbl[1] = x;
+	for (size_t i = 2; i < tblN; i++) {
+		T::mul(tbl[i], tbl[i-1], x);
+	}
+	z = tbl[0];
+	bool first = true;
+	for (size_t i = 0; i < yn; i++) {
+		const Unit v = y[yn-1-i];
+		for (size_t j = 0; j < bitLen / w; j++) {
+			const size_t idx = size_t(v >> (bitLen-w-j*w)) & (tblN-1);
+			if (first) {
+				if (idx == 0) continue;
+				z = tbl[idx];
+				first = false;
+				continue;
+			}
+			for (int k = 0; k < w; k++) T::sqr(z, z);
+			if (idx) T::mul(z, z, tbl[idx]);
+		}
+	}
+}
+
+void powVecAVX512(Fp *z, const Fp *x, size_t n, const Unit *y, size_t yn)
+{
+	assert(n % M == 0);
+	CYBOZU_ALIGN(64) FpA v[M];
+	FpM t;
+	for (size_t i = 0; i < n; i += M) {
+		for (size_t j = 0; j < M; j++) {
+			mcl::bint::copyT<6>(v[j].v, x[i+j].getUnit());
+		}
+		t.setFpA(v);
+		powSameExp(t, t, y, yn);
+		t.getFpA(v);
+		for (size_t j = 0; j < M; j++) {
+			mcl::bint::copyT<6>((Unit*)&z[i+j], v[j].v);
+		}
+	}
+}
+
+void powVecAVX512Fp2(Fp2 *z, const Fp2 *x, size_t n, const Unit *y, size_t yn)
+{
+	assert(n % M == 0);
+	CYBOZU_ALIGN(64) FpA va[M], vb[M];
+	FpM2 t;
+	for (size_t i = 0; i < n; i += M) {
+		for (size_t j = 0; j < M; j++) {
+			mcl::bint::copyT<6>(va[j].v, x[i+j].a.getUnit());
+			mcl::bint::copyT<6>(vb[j].v, x[i+j].b.getUnit());
+		}
+		t.a.setFpA(va);
+		t.b.setFpA(vb);
+		powSameExp(t, t, y, yn);
+		t.a.getFpA(va);
+		t.b.getFpA(vb);
+		for (size_t j = 0; j < M; j++) {
+			mcl::bint::copyT<6>((Unit*)&z[i+j].a, va[j].v);
+			mcl::bint::copyT<6>((Unit*)&z[i+j].b, vb[j].v);
+		}
+	}
+}
+
+/*
+	z[i] = f(x[i], y[i]) for i < n (n % 8 == 0)
+	u FrMs are processed at once to hide the latency of f
+*/
+template<void f(FrM&, const FrM&, const FrM&), size_t u = 4>
+inline void opVecFr(Fr *_z, const Fr *_x, const Fr *_y, size_t n)
+{
+	assert(n % M == 0);
+	FrA *z = (FrA*)_z;
+	const FrA *x = (const FrA*)_x;
+	const FrA *y = (const FrA*)_y;
+	FrM a[u], b[u];
+	size_t i = 0;
+	for (; i + M * u <= n; i += M * u) {
+		for (size_t k = 0; k < u; k++) {
+			a[k].setFrA(x + i + M * k);
+			b[k].setFrA(y + i + M * k);
+		}
+		for (size_t k = 0; k < u; k++) {
+			f(a[k], a[k], b[k]);
+		}
+		for (size_t k = 0; k < u; k++) {
+			a[k].getFrA(z + i + M * k);
+		}
+	}
+	for (; i < n; i += M) {
+		a[0].setFrA(x + i);
+		b[0].setFrA(y + i);
+		f(a[0], a[0], b[0]);
+		a[0].getFrA(z + i);
+	}
+}
+
+void mulVecFrAVX512(Fr *z, const Fr *x, const Fr *y, size_t n)
+{
+	opVecFr<FrM::mul>(z, x, y, n);
+}
+
+void addVecFrAVX512(Fr *z, const Fr *x, const Fr *y, size_t n)
+{
+	opVecFr<FrM::add>(z, x, y, n);
+}
+
+void subVecFrAVX512(Fr *z, const Fr *x, const Fr *y, size_t n)
+{
+	opVecFr<FrM::sub>(z, x, y, n);
+}
+
+/*
+	Montgomery's trick for each lane of FrM
+	u chains (t[i] = t[i-u] x[i]) hide the latency of FrM::mul
+	and the last products of the chains are inverted by one mcl::invVec per block
+	zeros are replaced by one in the products and set to zero at the end
+*/
+void invVecFrAVX512(Fr *_y, const Fr *_x, size_t n)
+{
+	assert(n % M == 0);
+	FrA *y = (FrA*)_y;
+	const FrA *x = (const FrA*)_x;
+	const size_t u = 4;
+	const size_t maxBlockN = 128;
+	FrM *t = (FrM*)CYBOZU_ALIGNED_ALLOCA(sizeof(FrM) * maxBlockN, 64);
+	n /= M;
+	while (n > 0) {
+		const size_t m = n < maxBlockN ? n : maxBlockN;
+		const size_t un = m < u ? m : u;
+		FrM a;
+		for (size_t i = 0; i < m; i++) {
+			a.setFrA(x + i * M);
+			a.cset(a.isZero(), FrM::one()); // skip zero
+			if (i < u) {
+				t[i] = a;
+			} else {
+				FrM::mul(t[i], t[i - u], a);
+			}
+		}
+		FrM inv[u];
+		CYBOZU_ALIGN(64) FrA v[M * u];
+		for (size_t k = 0; k < un; k++) {
+			t[m - un + k].getFrA(v + k * M);
+		}
+		mcl::invVec<mcl::Fr>((mcl::Fr*)v, (const mcl::Fr*)v, M * un, M * un);
+		for (size_t k = 0; k < un; k++) {
+			inv[(m - un + k) % u].setFrA(v + k * M);
+		}
+		for (size_t i = m; i > 0;) {
+			i--;
+			FrM& w = inv[i % u];
+			a.setFrA(x + i * M);
+			const Vmask c = a.isZero();
+			FrM r;
+			if (i < u) {
+				r = w;
+			} else {
+				a.cset(c, FrM::one());
+				FrM::mul(r, w, t[i - u]);
+				FrM::mul(w, w, a);
+			}
+			r.cset(c, FrM::zero());
+			r.getFrA(y + i * M);
+		}
+		x += m * M;
+		y += m * M;
+		n -= m;
+	}
+}
+
 bool initMsm(const mcl::CurveParam& cp)
 {
 	assert(EcM::a_ == 0);
@@ -1643,6 +2510,15 @@ bool initMsm(const mcl::CurveParam& cp)
 #else
 	if (cp != mcl::BLS12_381) return false;
 #endif
+	// same as s_param.g2 and g3 in pairing_impl.hpp (BLS12-381 is M-type)
+	Fp2 g2 = Fp2::get_gTbl()[0];
+	Fp2 g3 = Fp2::get_gTbl()[3];
+	if (cp.isMtype) {
+		Fp2::inv(g2, g2);
+		Fp2::inv(g3, g3);
+	}
+	EcM2::g2_.setFp2(g2);
+	EcM2::g3_.setFp2(g3);
 	if ((mcl::bint::g_cpuType & mcl::bint::tAVX512_IFMA) == 0) return false;
 	return true;
 }
@@ -1886,6 +2762,15 @@ void setParam(G1 *P, Fr *x, size_t n, cybozu::XorShift& rg)
 	}
 }
 
+void setParam(G2 *P, Fr *x, size_t n, cybozu::XorShift& rg)
+{
+	for (size_t i = 0; i < n; i++) {
+		uint32_t v = rg.get32();
+		hashAndMapToG2(P[i], &v, sizeof(v));
+		if (x) x[i].setByCSPRNG(rg);
+	}
+}
+
 CYBOZU_TEST_AUTO(cmp)
 {
 	const size_t n = 8;
@@ -2495,6 +3380,95 @@ CYBOZU_TEST_AUTO(mulEach)
 #endif
 }
 
+void setRandFr(Fr *x, size_t n, cybozu::XorShift& rg)
+{
+	for (size_t i = 0; i < n; i++) {
+		x[i].setByCSPRNG(rg);
+	}
+	x[1].clear();
+	x[n / 2] = 1;
+	x[n - 1] = -1;
+}
+
+CYBOZU_TEST_AUTO(vecFr)
+{
+	cybozu::XorShift rg;
+	const size_t N = 256;
+	std::vector<Fr> x(N), y(N), z(N), w(N);
+	setRandFr(&x[0], N, rg);
+	setRandFr(&y[0], N, rg);
+	y[2].clear();
+	for (size_t n = 8; n <= N; n += 8) {
+		mulVecFrAVX512(&z[0], &x[0], &y[0], n);
+		for (size_t i = 0; i < n; i++) {
+			CYBOZU_TEST_EQUAL(z[i], x[i] * y[i]);
+		}
+		addVecFrAVX512(&z[0], &x[0], &y[0], n);
+		for (size_t i = 0; i < n; i++) {
+			CYBOZU_TEST_EQUAL(z[i], x[i] + y[i]);
+		}
+		subVecFrAVX512(&z[0], &x[0], &y[0], n);
+		for (size_t i = 0; i < n; i++) {
+			CYBOZU_TEST_EQUAL(z[i], x[i] - y[i]);
+		}
+		invVecFrAVX512(&z[0], &x[0], n);
+		mcl::invVec(&w[0], &x[0], n);
+		CYBOZU_TEST_EQUAL_ARRAY(z, w, n);
+	}
+	// in-place
+	z = x;
+	mulVecFrAVX512(&z[0], &z[0], &z[0], N);
+	for (size_t i = 0; i < N; i++) {
+		CYBOZU_TEST_EQUAL(z[i], x[i] * x[i]);
+	}
+	z = x;
+	invVecFrAVX512(&z[0], &z[0], N);
+	mcl::invVec(&w[0], &x[0], N);
+	CYBOZU_TEST_EQUAL_ARRAY(z, w, N);
+	// more than one block of invVecFrAVX512
+	const size_t L = 8 * 300;
+	std::vector<Fr> a(L), b(L), c(L);
+	setRandFr(&a[0], L, rg);
+	a[8 * 128].clear();
+	invVecFrAVX512(&b[0], &a[0], L);
+	mcl::invVec(&c[0], &a[0], L);
+	CYBOZU_TEST_EQUAL_ARRAY(b, c, L);
+	// FrM
+	FrM xM, yM, zM;
+	CYBOZU_ALIGN(64) FrA v[M];
+	memcpy(v, &x[0], sizeof(v));
+	xM.setFrA(v);
+	memcpy(v, &y[0], sizeof(v));
+	yM.setFrA(v);
+	FrM::sqr(zM, xM);
+	FrM::mul(zM, zM, yM);
+	FrM::sub(zM, zM, xM);
+	FrM::add(zM, zM, FrM::one());
+	zM.getFrA(v);
+	for (size_t i = 0; i < M; i++) {
+		CYBOZU_TEST_EQUAL(((const Fr*)v)[i], x[i] * x[i] * y[i] - x[i] + 1);
+	}
+#ifdef NDEBUG
+	{
+		const int C = 1000;
+		const size_t n = 1024;
+		std::vector<Fr> a(n), b(n), c(n);
+		setRandFr(&a[0], n, rg);
+		setRandFr(&b[0], n, rg);
+		CYBOZU_BENCH_C("FrM::mul", C*100, FrM::mul, xM, xM, yM);
+		CYBOZU_BENCH_C("FrM::add", C*100, FrM::add, xM, xM, yM);
+		CYBOZU_BENCH_C("mulVecFr", C, mulVecFrAVX512, &c[0], &a[0], &b[0], n);
+		CYBOZU_BENCH_C("mul    ", C, lpN, Fr::mul, &c[0], &a[0], &b[0], n);
+		CYBOZU_BENCH_C("addVecFr", C, addVecFrAVX512, &c[0], &a[0], &b[0], n);
+		CYBOZU_BENCH_C("add    ", C, lpN, Fr::add, &c[0], &a[0], &b[0], n);
+		CYBOZU_BENCH_C("subVecFr", C, subVecFrAVX512, &c[0], &a[0], &b[0], n);
+		CYBOZU_BENCH_C("sub    ", C, lpN, Fr::sub, &c[0], &a[0], &b[0], n);
+		CYBOZU_BENCH_C("invVecFr", C, invVecFrAVX512, &c[0], &a[0], n);
+		CYBOZU_BENCH_C("invVec ", C, mcl::invVec<Fr>, &c[0], &a[0], n, 1024);
+	}
+#endif
+}
+
 void copyMulVec(G1& R, const G1 *_P, const Fr *x, size_t n)
 {
 	G1 *P = (G1*)CYBOZU_ALLOCA(sizeof(G1) * n);
@@ -2531,6 +3505,123 @@ CYBOZU_TEST_AUTO(mulVec)
 #endif
 }
 
+#ifndef MCL_MSM_BLS12_377
+CYBOZU_TEST_AUTO(opG2)
+{
+	const size_t n = 8; // fixed
+	G2 P[n], Q[n], R[n], T[n];
+	G2A *PA = (G2A*)P;
+	G2A *QA = (G2A*)Q;
+	G2A *TA = (G2A*)T;
+
+	EcM2 PM, QM, TM;
+	cybozu::XorShift rg;
+	setParam(P, 0, n, rg);
+	setParam(Q, 0, n, rg);
+	P[3].clear();
+	Q[4].clear();
+
+	// R = 2P
+	for (size_t i = 0; i < n; i++) {
+		G2::dbl(R[i], P[i]);
+	}
+	PM.setG2A(PA);
+	EcM2::dbl<true>(TM, PM);
+	TM.getG2A(TA);
+	CYBOZU_TEST_EQUAL_ARRAY(R, T, n);
+	PM.setG2A(PA, false);
+	EcM2::dbl<false>(TM, PM);
+	TM.getG2A(TA, false);
+	CYBOZU_TEST_EQUAL_ARRAY(R, T, n);
+
+	// R = P + Q
+	for (size_t i = 0; i < n; i++) {
+		G2::add(R[i], P[i], Q[i]);
+	}
+	PM.setG2A(PA);
+	QM.setG2A(QA);
+	EcM2::add<true>(TM, PM, QM);
+	TM.getG2A(TA);
+	CYBOZU_TEST_EQUAL_ARRAY(R, T, n);
+	PM.setG2A(PA, false);
+	QM.setG2A(QA, false);
+	EcM2::add<false>(TM, PM, QM);
+	TM.getG2A(TA, false);
+	CYBOZU_TEST_EQUAL_ARRAY(R, T, n);
+	for (size_t i = 0; i < n; i++) {
+		Q[i].normalize();
+	}
+	QM.setG2A(QA, false);
+	EcM2::add<false, true>(TM, PM, QM);
+	TM.getG2A(TA, false);
+	CYBOZU_TEST_EQUAL_ARRAY(R, T, n);
+
+	// R = Frob(P) = zP
+	Fr z;
+	z.setMpz(mpz_class(g_absZ));
+	Fr::neg(z, z);
+	for (size_t i = 0; i < n; i++) {
+		G2::mul(R[i], P[i], z);
+	}
+	PM.setG2A(PA);
+	EcM2::Frobenius(TM, PM);
+	TM.getG2A(TA);
+	CYBOZU_TEST_EQUAL_ARRAY(R, T, n);
+
+	// normalize
+	normalizeJacobiVec<EcM2>(&PM, 1);
+	PM.setG2A(PA, false);
+	normalizeJacobiVec<EcM2>(&PM, 1);
+	PM.getG2A(TA, false);
+	CYBOZU_TEST_EQUAL_ARRAY(P, T, n);
+}
+
+CYBOZU_TEST_AUTO(mulEachG2)
+{
+	const size_t n = 40;
+	G2 P[n], Q[n], R[n];
+	Fr x[n];
+	cybozu::XorShift rg;
+	setParam(P, x, n, rg);
+	P[3].clear();
+	x[5] = 0;
+	x[6] = 1;
+	x[7] = -1;
+	x[8].setMpz(g_absZ);
+	x[9].setMpz(mpz_class(g_absZ) * g_absZ - 1);
+	for (size_t i = 0; i < n; i++) {
+		Q[i] = P[i];
+		G2::mul(R[i], P[i], x[i]);
+	}
+	mulEachAVX512G2(Q, x, n);
+	CYBOZU_TEST_EQUAL_ARRAY(R, Q, n);
+}
+
+CYBOZU_TEST_AUTO(mulVecG2)
+{
+	const size_t n = 1027;
+	std::vector<G2> P(n);
+	std::vector<Fr> x(n);
+	G2 Q, R;
+	cybozu::XorShift rg;
+	setParam(P.data(), x.data(), n, rg);
+	P[32].clear();
+	P[n/2].clear();
+	Q.clear();
+	for (size_t i = 0; i < n; i++) {
+		G2 T;
+		G2::mul(T, P[i], x[i]);
+		Q += T;
+	}
+	mulVecAVX512G2(R, P.data(), x.data(), n);
+	CYBOZU_TEST_EQUAL(Q, R);
+#ifdef NDEBUG
+	CYBOZU_BENCH_C("mulVecG2", 10, mulVecAVX512G2, R, P.data(), x.data(), n, 0);
+	CYBOZU_BENCH_C("mulEachG2", 10, mulEachAVX512G2, P.data(), x.data(), n & ~size_t(7));
+#endif
+}
+#endif // MCL_MSM_BLS12_377
+
 void msmBench(int C, size_t db, size_t de, size_t b)
 {
 	printf("d = [%zd, %zd], b = %zd\n", db, de, b);
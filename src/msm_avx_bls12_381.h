@@ -279,6 +279,124 @@ static const CYBOZU_ALIGN(64) uint64_t g_zeroProjA_[] = {
 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
 };
+static const CYBOZU_ALIGN(64) uint64_t g_one2_[] = {
+0x6480ea8e9b9af, 0x6480ea8e9b9af, 0x6480ea8e9b9af, 0x6480ea8e9b9af, 0x6480ea8e9b9af, 0x6480ea8e9b9af, 0x6480ea8e9b9af, 0x6480ea8e9b9af,
+0x65766c8fe444f, 0x65766c8fe444f, 0x65766c8fe444f, 0x65766c8fe444f, 0x65766c8fe444f, 0x65766c8fe444f, 0x65766c8fe444f, 0x65766c8fe444f,
+0x8b540fea96f7d, 0x8b540fea96f7d, 0x8b540fea96f7d, 0x8b540fea96f7d, 0x8b540fea96f7d, 0x8b540fea96f7d, 0x8b540fea96f7d, 0x8b540fea96f7d,
+0x3b2ee82efd422, 0x3b2ee82efd422, 0x3b2ee82efd422, 0x3b2ee82efd422, 0x3b2ee82efd422, 0x3b2ee82efd422, 0x3b2ee82efd422, 0x3b2ee82efd422,
+0xa6723e5f0ade5, 0xa6723e5f0ade5, 0xa6723e5f0ade5, 0xa6723e5f0ade5, 0xa6723e5f0ade5, 0xa6723e5f0ade5, 0xa6723e5f0ade5, 0xa6723e5f0ade5,
+0xff6eb6fdd4230, 0xff6eb6fdd4230, 0xff6eb6fdd4230, 0xff6eb6fdd4230, 0xff6eb6fdd4230, 0xff6eb6fdd4230, 0xff6eb6fdd4230, 0xff6eb6fdd4230,
+0xe06ef23c24a25, 0xe06ef23c24a25, 0xe06ef23c24a25, 0xe06ef23c24a25, 0xe06ef23c24a25, 0xe06ef23c24a25, 0xe06ef23c24a25, 0xe06ef23c24a25,
+0x14c8e, 0x14c8e, 0x14c8e, 0x14c8e, 0x14c8e, 0x14c8e, 0x14c8e, 0x14c8e,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+};
+static const CYBOZU_ALIGN(64) uint64_t g_zeroJacobi2_[] = {
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+};
+static const CYBOZU_ALIGN(64) uint64_t g_zeroProj2_[] = {
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x1, 0x1, 0x1, 0x1, 0x1, 0x1, 0x1, 0x1,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0, 0x0,
+};
 
 struct G {
 	static const Vec& mask() { return *(const Vec*)g_mask_; }
@@ -286,3 +404,26 @@ struct G {
 	static const Vec* ap() { return (const Vec*)g_ap_; }
 };
 
+static const size_t g_frN = 5;
+static const CYBOZU_ALIGN(64) uint64_t g_frRp_[] = { 0xffffeffffffff, 0xffffeffffffff, 0xffffeffffffff, 0xffffeffffffff, 0xffffeffffffff, 0xffffeffffffff, 0xffffeffffffff, 0xffffeffffffff, };
+static const CYBOZU_ALIGN(64) uint64_t g_frAp_[] = {
+0xfffff00000001, 0xfffff00000001, 0xfffff00000001, 0xfffff00000001, 0xfffff00000001, 0xfffff00000001, 0xfffff00000001, 0xfffff00000001,
+0x2fffe5bfefff, 0x2fffe5bfefff, 0x2fffe5bfefff, 0x2fffe5bfefff, 0x2fffe5bfefff, 0x2fffe5bfefff, 0x2fffe5bfefff, 0x2fffe5bfefff,
+0x9a1d80553bda4, 0x9a1d80553bda4, 0x9a1d80553bda4, 0x9a1d80553bda4, 0x9a1d80553bda4, 0x9a1d80553bda4, 0x9a1d80553bda4, 0x9a1d80553bda4,
+0x7d483339d8080, 0x7d483339d8080, 0x7d483339d8080, 0x7d483339d8080, 0x7d483339d8080, 0x7d483339d8080, 0x7d483339d8080, 0x7d483339d8080,
+0x73eda753299d, 0x73eda753299d, 0x73eda753299d, 0x73eda753299d, 0x73eda753299d, 0x73eda753299d, 0x73eda753299d, 0x73eda753299d,
+};
+static const CYBOZU_ALIGN(64) uint64_t g_frR_[] = {
+0x1fffffffe, 0x1fffffffe, 0x1fffffffe, 0x1fffffffe, 0x1fffffffe, 0x1fffffffe, 0x1fffffffe, 0x1fffffffe,
+0xfa00034802000, 0xfa00034802000, 0xfa00034802000, 0xfa00034802000, 0xfa00034802000, 0xfa00034802000, 0xfa00034802000, 0xfa00034802000,
+0xcbc4ff55884b7, 0xcbc4ff55884b7, 0xcbc4ff55884b7, 0xcbc4ff55884b7, 0xcbc4ff55884b7, 0xcbc4ff55884b7, 0xcbc4ff55884b7, 0xcbc4ff55884b7,
+0x56f998c4fefe, 0x56f998c4fefe, 0x56f998c4fefe, 0x56f998c4fefe, 0x56f998c4fefe, 0x56f998c4fefe, 0x56f998c4fefe, 0x56f998c4fefe,
+0x1824b159acc5, 0x1824b159acc5, 0x1824b159acc5, 0x1824b159acc5, 0x1824b159acc5, 0x1824b159acc5, 0x1824b159acc5, 0x1824b159acc5,
+};
+
+struct GFr {
+	static const Vec& mask() { return *(const Vec*)g_mask_; }
+	static const Vec& rp() { return *(const Vec*)g_frRp_; }
+	static const Vec* ap() { return (const Vec*)g_frAp_; }
+};
+
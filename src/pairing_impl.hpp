@@ -13,6 +13,9 @@
 
 #ifdef MCL_USE_OMP
 #include <omp.h>
+#elif defined(MCL_USE_STD_THREAD)
+#include <thread>
+#include <vector>
 #endif
 
 #include "compress.hpp"
@@ -1113,36 +1116,101 @@ MCL_DLL_API void millerLoopVec(Fp12& f, const G1* Pvec, const G2* Qvec, size_t n
 	}
 }
 
+namespace local {
+
+#if defined(MCL_USE_OMP) || defined(MCL_USE_STD_THREAD)
+inline size_t getProcNum()
+{
+#ifdef MCL_USE_OMP
+	return omp_get_num_procs();
+#else
+	const size_t n = std::thread::hardware_concurrency();
+	return n ? n : 1;
+#endif
+}
+
+// call f(i) for i = 0, ..., n-1 in parallel
+template<class F>
+void parallelFor(const F& f, size_t n)
+{
+#ifdef MCL_USE_OMP
+	#pragma omp parallel for num_threads(int(n))
+	for (int i = 0; i < int(n); i++) {
+		f(i);
+	}
+#else
+	// the current thread computes f(0)
+	std::vector<std::thread> th;
+	th.reserve(n - 1);
+	for (size_t i = 1; i < n; i++) {
+#ifndef CYBOZU_DONT_USE_EXCEPTION
+		try {
+			th.push_back(std::thread(f, i));
+		} catch (...) {
+			f(i);
+		}
+#else
+		th.push_back(std::thread(f, i));
+#endif
+	}
+	f(0);
+	for (size_t i = 0; i < th.size(); i++) {
+		th[i].join();
+	}
+#endif
+}
+#endif
+
+/*
+	split [0, n) into cpuN parts whose sizes differ by at most one
+	fs[i] = prod_{j in the i-th part} millerLoop(Pvec[j], Qvec[j])
+*/
+struct MillerLoopVecPart {
+	Fp12 *fs;
+	const G1 *Pvec;
+	const G2 *Qvec;
+	size_t n;
+	size_t cpuN;
+	void operator()(size_t i) const
+	{
+		const size_t q = n / cpuN;
+		const size_t r = n % cpuN;
+		const size_t adj = q * i + fp::min_(i, r);
+		millerLoopVec(fs[i], Pvec + adj, Qvec + adj, q + (i < r), true);
+	}
+};
+
+} // mcl::local
+
 MCL_DLL_API void millerLoopVecMT(Fp12& f, const G1* Pvec, const G2* Qvec, size_t n, size_t cpuN)
 {
 	if (n == 0) {
 		f = 1;
 		return;
 	}
-#ifdef MCL_USE_OMP
-	const size_t minN = 16;
+#if defined(MCL_USE_OMP) || defined(MCL_USE_STD_THREAD)
 	if (cpuN == 0) {
-		cpuN = omp_get_num_procs();
+		// each thread computes at least minN pairs if cpuN is not specified
+		const size_t minN = 16;
+		cpuN = local::getProcNum();
 		if (n < minN * cpuN) {
 			cpuN = (n + minN - 1) / minN;
 		}
 	}
-	if (cpuN <= 1 || n <= cpuN) {
-		millerLoopVec(f, Pvec, Qvec, n);
+	/*
+		each thread has its own Fp12 and computes the Miller loop of at least one pair
+		the squarings of Fp12 are duplicated in threads
+	*/
+	if (cpuN > n) cpuN = n;
+	if (cpuN <= 1) {
+		millerLoopVec(f, Pvec, Qvec, n, true);
 		return;
 	}
 	Fp12 *fs = (Fp12*)CYBOZU_ALLOCA(sizeof(Fp12) * cpuN);
-	size_t q = n / cpuN;
-	size_t r = n % cpuN;
-	#pragma omp parallel for
-	for (size_t i = 0; i < cpuN; i++) {
-		size_t adj = q * i + fp::min_(i, r);
-		millerLoopVec(fs[i], Pvec + adj, Qvec + adj, q + (i < r));
-	}
-	f = 1;
-//	#pragma omp declare reduction(red:Fp12:omp_out *= omp_in) initializer(omp_priv = omp_orig)
-//	#pragma omp parallel for reduction(red:f)
-	for (size_t i = 0; i < cpuN; i++) {
+	const local::MillerLoopVecPart part = { fs, Pvec, Qvec, n, cpuN };
+	local::parallelFor(part, cpuN);
+	f = fs[0];
+	for (size_t i = 1; i < cpuN; i++) {
 		f *= fs[i];
 	}
 #else
@@ -1151,6 +1219,242 @@ MCL_DLL_API void millerLoopVecMT(Fp12& f, const G1* Pvec, const G2* Qvec, size_t
 #endif
 }
 
+MCL_DLL_API size_t getMulVecFixedBaseWindowSize(size_t n)
+{
+	// minimize the num of additions to the buckets and to sum them up
+	const size_t bitSize = Fr::getBitSize();
+	size_t c = 2;
+	size_t minCost = size_t(-1);
+	for (size_t i = 2; i <= 20; i++) {
+		size_t cost = n * ((bitSize + i - 1) / i) + (size_t(2) << i);
+		if (cost < minCost) {
+			minCost = cost;
+			c = i;
+		}
+	}
+	return c;
+}
+
+namespace local {
+
+template<class G>
+void precomputeMulVecT(G *tbl, const G *xVec, size_t n, size_t c)
+{
+	if (c == 0) c = getMulVecFixedBaseWindowSize(n);
+	const size_t winN = (Fr::getBitSize() + c - 1) / c;
+	mcl::ec::mulVecFixedBasePrecompute(tbl, xVec, n, c, winN);
+}
+
+template<class G>
+void mulVecFixedBaseT(G& z, const G *tbl, const Fr *yVec, size_t n, size_t c)
+{
+	if (c == 0) c = getMulVecFixedBaseWindowSize(n);
+	const size_t winN = (Fr::getBitSize() + c - 1) / c;
+#ifndef MCL_DONT_USE_MALLOC
+	const size_t next = Fr::getUnitSize();
+	Unit *yp = (Unit*)malloc(sizeof(Unit) * next * n);
+	if (yp) {
+		for (size_t i = 0; i < n; i++) {
+			yVec[i].getUnitArray(yp + next * i);
+		}
+		bool b = mcl::ec::mulVecFixedBase(z, tbl, c, winN, yp, next, n);
+		free(yp);
+		if (b) return;
+	}
+#endif
+	// tbl[i * winN] = xVec[i]
+	z.clear();
+	for (size_t i = 0; i < n; i++) {
+		G t;
+		G::mul(t, tbl[i * winN], yVec[i]);
+		z += t;
+	}
+}
+
+} // mcl::local
+
+MCL_DLL_API size_t getPrecomputedMulVecSize(size_t n, size_t c)
+{
+	if (c == 0) c = getMulVecFixedBaseWindowSize(n);
+	return n * ((Fr::getBitSize() + c - 1) / c);
+}
+
+MCL_DLL_API void precomputeMulVec(G1 *tbl, const G1 *xVec, size_t n, size_t c)
+{
+	local::precomputeMulVecT(tbl, xVec, n, c);
+}
+
+MCL_DLL_API void precomputeMulVec(G2 *tbl, const G2 *xVec, size_t n, size_t c)
+{
+	local::precomputeMulVecT(tbl, xVec, n, c);
+}
+
+MCL_DLL_API void mulVecFixedBase(G1& z, const G1 *tbl, const Fr *yVec, size_t n, size_t c)
+{
+	local::mulVecFixedBaseT(z, tbl, yVec, n, c);
+}
+
+MCL_DLL_API void mulVecFixedBase(G2& z, const G2 *tbl, const Fr *yVec, size_t n, size_t c)
+{
+	local::mulVecFixedBaseT(z, tbl, yVec, n, c);
+}
+
+namespace local {
+
+template<class G>
+size_t deserializeVecT(G *xVec, const void *buf, size_t bufSize, size_t n, bool *okVec, size_t cpuN)
+{
+	const size_t size = G::getSerializedByteSize();
+	const uint8_t *src = (const uint8_t*)buf;
+	const size_t readN = fp::min_(n, bufSize / size);
+	size_t okN = 0;
+#ifdef MCL_USE_OMP
+	if (cpuN == 0) cpuN = omp_get_num_procs();
+	#pragma omp parallel for num_threads(int(cpuN)) reduction(+:okN)
+	for (size_t i = 0; i < readN; i++) {
+#else
+	(void)cpuN;
+	for (size_t i = 0; i < readN; i++) {
+#endif
+		const bool ok = xVec[i].deserialize(src + size * i, size) == size;
+		if (ok) {
+			okN++;
+		} else {
+			xVec[i].clear();
+		}
+		if (okVec) okVec[i] = ok;
+	}
+	for (size_t i = readN; i < n; i++) {
+		xVec[i].clear();
+		if (okVec) okVec[i] = false;
+	}
+	return okN;
+}
+
+} // mcl::local
+
+MCL_DLL_API size_t deserializeVec(G1 *xVec, const void *buf, size_t bufSize, size_t n, bool *okVec, size_t cpuN)
+{
+	return local::deserializeVecT(xVec, buf, bufSize, n, okVec, cpuN);
+}
+
+MCL_DLL_API size_t deserializeVec(G2 *xVec, const void *buf, size_t bufSize, size_t n, bool *okVec, size_t cpuN)
+{
+	return local::deserializeVecT(xVec, buf, bufSize, n, okVec, cpuN);
+}
+
+namespace local {
+
+// return the index of the first point in xVec[begin:end] which is not in G, or end
+template<class G>
+size_t findInvalidOrder(const G *xVec, size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; i++) {
+		if (!xVec[i].isValidOrder()) return i;
+	}
+	return end;
+}
+
+template<class G>
+size_t isValidOrderVecT(const G *xVec, size_t n, size_t cpuN)
+{
+#ifdef MCL_USE_OMP
+	if (cpuN == 0) cpuN = omp_get_num_procs();
+	const size_t blockSize = 256;
+	const size_t blockN = (n + blockSize - 1) / blockSize;
+	size_t bad = n;
+	#pragma omp parallel for num_threads(int(cpuN)) schedule(dynamic) reduction(min:bad)
+	for (int i = 0; i < int(blockN); i++) {
+		const size_t begin = i * blockSize;
+		const size_t end = fp::min_(begin + blockSize, n);
+		const size_t idx = findInvalidOrder(xVec, begin, end);
+		if (idx < end && idx < bad) bad = idx;
+	}
+	return bad;
+#else
+	(void)cpuN;
+	return findInvalidOrder(xVec, 0, n);
+#endif
+}
+
+} // mcl::local
+
+MCL_DLL_API size_t isValidOrderVec(const G1 *xVec, size_t n, size_t cpuN)
+{
+	return local::isValidOrderVecT(xVec, n, cpuN);
+}
+
+MCL_DLL_API size_t isValidOrderVec(const G2 *xVec, size_t n, size_t cpuN)
+{
+	return local::isValidOrderVecT(xVec, n, cpuN);
+}
+
+/*
+	H_i = hashAndMapToG1(msgVec[i])
+	e(sigVec[i], Q) = e(H_i, pubVec[i]) for all i
+	<= finalExp(millerLoop(S, Q) prod_i millerLoop(-r_i H_i, pubVec[i])) = 1
+	where S = sum_i r_i sigVec[i] for random 64-bit r_i
+*/
+MCL_DLL_API bool verifyBatchG1(const G1 *sigVec, const G2 *pubVec, const void *const *msgVec, const size_t *msgSizeVec, size_t n, const G2& Q, size_t cpuN)
+{
+	if (n == 0) return false;
+#ifdef MCL_DONT_USE_MALLOC
+	(void)cpuN;
+	for (size_t i = 0; i < n; i++) {
+		G1 P[2];
+		G2 R[2];
+		hashAndMapToG1(P[0], msgVec[i], msgSizeVec[i]);
+		G1::neg(P[0], P[0]);
+		P[1] = sigVec[i];
+		R[0] = pubVec[i];
+		R[1] = Q;
+		Fp12 e;
+		millerLoopVec(e, P, R, 2);
+		finalExp(e, e);
+		if (!e.isOne()) return false;
+	}
+	return true;
+#else
+	// P = [-r_0 H_0, ..., -r_{n-1} H_{n-1}, S], R = [pubVec[0], ..., pubVec[n-1], Q]
+	G1 *P = (G1*)malloc((sizeof(G1) * 2 + sizeof(Fr)) * (n + 1) + sizeof(G2) * (n + 1));
+	if (P == 0) return false;
+	G1 *sig = P + n + 1;
+	Fr *r = (Fr*)(sig + n + 1);
+	G2 *R = (G2*)(r + n + 1);
+	for (size_t i = 0; i < n; i++) {
+		Fr t;
+		t.setByCSPRNG();
+		uint64_t v;
+		memcpy(&v, t.getUnit(), sizeof(v));
+		if (v == 0) v = 1;
+		r[i].setArrayMask(&v, 1);
+		sig[i] = sigVec[i];
+		R[i] = pubVec[i];
+	}
+	R[n] = Q;
+	hashAndMapToG1Vec(P, msgVec, msgSizeVec, n, cpuN);
+#ifdef MCL_USE_OMP
+	if (cpuN == 0) cpuN = omp_get_num_procs();
+	#pragma omp parallel for num_threads(int(cpuN))
+	for (int i = 0; i < int(n); i++) {
+		G1::mul(P[i], P[i], r[i]);
+		G1::neg(P[i], P[i]);
+	}
+#else
+	for (size_t i = 0; i < n; i++) {
+		G1::mul(P[i], P[i], r[i]);
+		G1::neg(P[i], P[i]);
+	}
+#endif
+	G1::mulVecMT(P[n], sig, r, n, cpuN);
+	Fp12 e;
+	millerLoopVecMT(e, P, R, n + 1, cpuN);
+	free(P);
+	finalExp(e, e);
+	return e.isOne();
+#endif
+}
+
 MCL_DLL_API void verifyOrderG1(bool doVerify)
 {
 	if (s_param.isBLS12) {
@@ -1163,18 +1467,17 @@ MCL_DLL_API void verifyOrderG2(bool doVerify)
 }
 
 /*
-	Faster Subgroup Checks for BLS12-381
-	Sean Bowe, https://eprint.iacr.org/2019/814
-	Frob^2(P) - z Frob^3(P) == P
+	M. Scott, A note on group membership tests for G1, G2 and GT on BLS pairing-friendly curves
+	https://eprint.iacr.org/2021/1130
+	P is in G2 iff Frob(P) == z P
 */
 MCL_DLL_API bool isValidOrderBLS12(const G2& P)
 {
-	G2 T2, T3;
-	Frobenius2(T2, P);
-	Frobenius(T3, T2);
-	G2::mulGeneric(T3, T3, s_param.z);
-	T2 -= T3;
-	return T2 == P;
+	G2 T1, T2;
+	Frobenius(T1, P);
+	mulByAbsZ(T2, P);
+	if (s_param.isNegative) G2::neg(T2, T2);
+	return T1 == T2;
 }
 
 MCL_DLL_API void Frobenius(G2& D, const G2& S)
@@ -1203,10 +1506,27 @@ MCL_DLL_API void init(bool *pb, const mcl::CurveParam& cp)
 	if (!*pb) return;
 	G1::setMulVecGLV(mcl::ec::mulVecGLVT<GLV1, G1>);
 	G2::setMulVecGLV(mcl::ec::mulVecGLVT<GLV2, G2>);
+#ifdef MCL_USE_OMP
+	G1::setMulVecGLVMT(mcl::ec::mulVecGLVMT<GLV1, G1>);
+	G2::setMulVecGLVMT(mcl::ec::mulVecGLVMT<GLV2, G2>);
+#endif
+	mapTo.mapTo_WB19_.setPowVecOpti(0, 0);
+	mapTo.setMulByCofactorVecOpti(0);
 #if MCL_MSM == 1
 	if (mcl::msm::initMsm(cp)) {
 		G1::setMulVecOpti(mcl::msm::mulVecAVX512);
 		G1::setMulEachOpti(mcl::msm::mulEachAVX512);
+#ifndef MCL_MSM_BLS12_377
+		// FpM2 and EcM2 assume i^2 = -1, b = 4(1 + i) and z of BLS12-381
+		G2::setMulVecOpti(mcl::msm::mulVecAVX512G2);
+		G2::setMulEachOpti(mcl::msm::mulEachAVX512G2);
+		mapTo.mapTo_WB19_.setPowVecOpti(mcl::msm::powVecAVX512, mcl::msm::powVecAVX512Fp2);
+		mapTo.setMulByCofactorVecOpti(mcl::msm::mulByCofactorBLS12fastAVX512);
+#endif
+		Fr::setMulVecOpti(mcl::msm::mulVecFrAVX512);
+		Fr::setAddVecOpti(mcl::msm::addVecFrAVX512);
+		Fr::setSubVecOpti(mcl::msm::subVecFrAVX512);
+		Fr::setInvVecOpti(mcl::msm::invVecFrAVX512);
 	}
 #endif
 	Fp12::setPowVecGLV(powVecGLV);
@@ -0,0 +1,149 @@
+/**
+	@file
+	@brief SHA-256 compression functions with SHA extensions and AVX2
+	@author MITSUNARI Shigeo(@herumi)
+	@license modified new BSD license
+	http://opensource.org/licenses/BSD-3-Clause
+*/
+#include "sha256_x64.hpp"
+#ifdef _WIN32
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+namespace mcl { namespace sha256 {
+
+namespace {
+
+const uint32_t kTbl[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+typedef __m256i Vec;
+
+inline Vec vadd(const Vec& a, const Vec& b) { return _mm256_add_epi32(a, b); }
+inline Vec vxor(const Vec& a, const Vec& b) { return _mm256_xor_si256(a, b); }
+inline Vec vand(const Vec& a, const Vec& b) { return _mm256_and_si256(a, b); }
+inline Vec vor(const Vec& a, const Vec& b) { return _mm256_or_si256(a, b); }
+template<int s>
+inline Vec vrot(const Vec& x) { return vor(_mm256_srli_epi32(x, s), _mm256_slli_epi32(x, 32 - s)); }
+
+/*
+	load the 8 words at offset off of the 8 lanes as big endian
+	w[i] = { BE32(buf[0] + off + 4i), ..., BE32(buf[7] + off + 4i) }
+*/
+inline void load8x8(Vec w[8], const uint8_t *const buf[8], size_t off)
+{
+	const Vec bswap = _mm256_set_epi8(
+		12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+		12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+	Vec t[8];
+	for (int j = 0; j < 8; j++) {
+		t[j] = _mm256_shuffle_epi8(_mm256_loadu_si256((const Vec*)(buf[j] + off)), bswap);
+	}
+	// transpose 8x8 words
+	Vec u[8];
+	for (int j = 0; j < 8; j += 2) {
+		u[j] = _mm256_unpacklo_epi32(t[j], t[j + 1]);
+		u[j + 1] = _mm256_unpackhi_epi32(t[j], t[j + 1]);
+	}
+	for (int j = 0; j < 8; j += 4) {
+		t[j + 0] = _mm256_unpacklo_epi64(u[j + 0], u[j + 2]);
+		t[j + 1] = _mm256_unpackhi_epi64(u[j + 0], u[j + 2]);
+		t[j + 2] = _mm256_unpacklo_epi64(u[j + 1], u[j + 3]);
+		t[j + 3] = _mm256_unpackhi_epi64(u[j + 1], u[j + 3]);
+	}
+	for (int j = 0; j < 4; j++) {
+		w[j] = _mm256_permute2x128_si256(t[j], t[j + 4], 0x20);
+		w[j + 4] = _mm256_permute2x128_si256(t[j], t[j + 4], 0x31);
+	}
+}
+
+} // namespace
+
+void compressSHANI(uint32_t h[8], const uint8_t *buf, size_t blockN)
+{
+	const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bull, 0x0405060700010203ull);
+	// (a, b, c, d), (e, f, g, h) -> (a, b, e, f), (c, d, g, h) in the order used by sha256rnds2
+	__m128i t = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&h[0]), 0xb1);
+	__m128i s1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&h[4]), 0x1b);
+	__m128i s0 = _mm_alignr_epi8(t, s1, 8);
+	s1 = _mm_blend_epi16(s1, t, 0xf0);
+	for (size_t k = 0; k < blockN; k++) {
+		const __m128i save0 = s0;
+		const __m128i save1 = s1;
+		__m128i m[4];
+		for (int i = 0; i < 16; i++) {
+			__m128i& w = m[i & 3];
+			if (i < 4) {
+				w = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(buf + i * 16)), bswap);
+			} else {
+				// w[i] = msg2(msg1(w[i-4], w[i-3]) + (w[i-2]:w[i-1] >> 32), w[i-1])
+				const __m128i& w1 = m[(i - 1) & 3];
+				t = _mm_add_epi32(_mm_sha256msg1_epu32(w, m[(i - 3) & 3]), _mm_alignr_epi8(w1, m[(i - 2) & 3], 4));
+				w = _mm_sha256msg2_epu32(t, w1);
+			}
+			t = _mm_add_epi32(w, _mm_loadu_si128((const __m128i*)&kTbl[i * 4]));
+			s1 = _mm_sha256rnds2_epu32(s1, s0, t);
+			s0 = _mm_sha256rnds2_epu32(s0, s1, _mm_shuffle_epi32(t, 0x0e));
+		}
+		s0 = _mm_add_epi32(s0, save0);
+		s1 = _mm_add_epi32(s1, save1);
+		buf += 64;
+	}
+	t = _mm_shuffle_epi32(s0, 0x1b);
+	s1 = _mm_shuffle_epi32(s1, 0xb1);
+	_mm_storeu_si128((__m128i*)&h[0], _mm_blend_epi16(t, s1, 0xf0));
+	_mm_storeu_si128((__m128i*)&h[4], _mm_alignr_epi8(s1, t, 8));
+}
+
+void compressAVX2x8(uint32_t h[64], const uint8_t *const buf[8], uint32_t mask)
+{
+	Vec w[16];
+	load8x8(w, buf, 0);
+	load8x8(w + 8, buf, 32);
+	Vec s[8], org[8];
+	for (int i = 0; i < 8; i++) {
+		s[i] = org[i] = _mm256_loadu_si256((const Vec*)&h[i * 8]);
+	}
+	for (int i = 0; i < 64; i++) {
+		Vec& wi = w[i & 15];
+		if (i >= 16) {
+			const Vec& t15 = w[(i - 15) & 15];
+			const Vec& t2 = w[(i - 2) & 15];
+			const Vec s0 = vxor(vxor(vrot<7>(t15), vrot<18>(t15)), _mm256_srli_epi32(t15, 3));
+			const Vec s1 = vxor(vxor(vrot<17>(t2), vrot<19>(t2)), _mm256_srli_epi32(t2, 10));
+			wi = vadd(vadd(wi, s0), vadd(w[(i - 7) & 15], s1));
+		}
+		const Vec& a = s[0];
+		const Vec& e = s[4];
+		Vec t1 = vadd(s[7], vxor(vxor(vrot<6>(e), vrot<11>(e)), vrot<25>(e)));
+		t1 = vadd(t1, vxor(s[6], vand(e, vxor(s[5], s[6]))));
+		t1 = vadd(t1, vadd(_mm256_set1_epi32(int(kTbl[i])), wi));
+		Vec t2 = vxor(vxor(vrot<2>(a), vrot<13>(a)), vrot<22>(a));
+		t2 = vadd(t2, vor(vand(vor(a, s[1]), s[2]), vand(a, s[1])));
+		s[7] = s[6];
+		s[6] = s[5];
+		s[5] = s[4];
+		s[4] = vadd(s[3], t1);
+		s[3] = s[2];
+		s[2] = s[1];
+		s[1] = s[0];
+		s[0] = vadd(t1, t2);
+	}
+	const Vec bit = _mm256_set_epi32(128, 64, 32, 16, 8, 4, 2, 1);
+	const Vec m = _mm256_cmpeq_epi32(vand(_mm256_set1_epi32(int(mask)), bit), bit);
+	for (int i = 0; i < 8; i++) {
+		_mm256_storeu_si256((Vec*)&h[i * 8], vadd(org[i], vand(s[i], m)));
+	}
+}
+
+} } // mcl::sha256
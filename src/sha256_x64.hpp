@@ -0,0 +1,29 @@
+#pragma once
+/**
+	@file
+	@brief SHA-256 compression functions with SHA extensions and AVX2
+	@author MITSUNARI Shigeo(@herumi)
+	@license modified new BSD license
+	http://opensource.org/licenses/BSD-3-Clause
+*/
+#include <stdint.h>
+#include <stddef.h>
+
+namespace mcl { namespace sha256 {
+
+/*
+	update h[0:8] by blockN blocks (64 bytes each) at buf
+	require SHA extensions and SSE4.1
+*/
+void compressSHANI(uint32_t h[8], const uint8_t *buf, size_t blockN);
+
+/*
+	multi-buffer version for 8 lanes
+	h[i * 8 + j] is the i-th word of the state of the j-th lane
+	update the state of the j-th lane by one block at buf[j] if (mask >> j) & 1
+	buf[j] must be readable (64 bytes) even if the j-th lane is masked
+	require AVX2
+*/
+void compressAVX2x8(uint32_t h[64], const uint8_t *const buf[8], uint32_t mask);
+
+} } // mcl::sha256
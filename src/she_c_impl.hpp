@@ -276,6 +276,53 @@ mclSize sheSaveTableForGTDLP(void *buf, mclSize maxBufSize)
 	return saveTable(buf, maxBufSize, SHE::ePQhashTbl_);
 }
 
+int sheMapTableForG1DLP(const char *path)
+	try
+{
+	SHE::mapTableForG1DLP(path);
+	return 0;
+} catch (std::exception&) {
+	return -1;
+}
+int sheMapTableForG2DLP(const char *path)
+	try
+{
+	SHE::mapTableForG2DLP(path);
+	return 0;
+} catch (std::exception&) {
+	return -1;
+}
+int sheMapTableForGTDLP(const char *path)
+	try
+{
+	SHE::mapTableForGTDLP(path);
+	return 0;
+} catch (std::exception&) {
+	return -1;
+}
+
+template<class HashTable>
+int saveTableFile(const char *path, const HashTable& table)
+	try
+{
+	table.saveMapFile(path);
+	return 0;
+} catch (std::exception&) {
+	return -1;
+}
+int sheSaveTableFileForG1DLP(const char *path)
+{
+	return saveTableFile(path, SHE::PhashTbl_);
+}
+int sheSaveTableFileForG2DLP(const char *path)
+{
+	return saveTableFile(path, SHE::QhashTbl_);
+}
+int sheSaveTableFileForGTDLP(const char *path)
+{
+	return saveTableFile(path, SHE::ePQhashTbl_);
+}
+
 mclSize sheGetTableSizeForG1DLP() { return SHE::PhashTbl_.getTableSize(); }
 mclSize sheGetTableSizeForG2DLP() { return SHE::QhashTbl_.getTableSize(); }
 mclSize sheGetTableSizeForGTDLP() { return SHE::ePQhashTbl_.getTableSize(); }
@@ -302,6 +349,33 @@ int sheEncGT(sheCipherTextGT *c, const shePublicKey *pub, mclInt m)
 	return encT(c, pub, m);
 }
 
+template<class CT, class PK>
+int encVecT(CT *c, const PK *pub, const mclInt *m, mclSize n)
+	try
+{
+	if (n == 0) return 0;
+	std::vector<int64_t> mVec(m, m + n);
+	cast(pub)->encVec(cast(c), &mVec[0], n);
+	return 0;
+} catch (std::exception&) {
+	return -1;
+}
+
+int sheEncG1Vec(sheCipherTextG1 *c, const shePublicKey *pub, const mclInt *m, mclSize n)
+{
+	return encVecT(c, pub, m, n);
+}
+
+int sheEncG2Vec(sheCipherTextG2 *c, const shePublicKey *pub, const mclInt *m, mclSize n)
+{
+	return encVecT(c, pub, m, n);
+}
+
+int sheEncGTVec(sheCipherTextGT *c, const shePublicKey *pub, const mclInt *m, mclSize n)
+{
+	return encVecT(c, pub, m, n);
+}
+
 bool setArray(mpz_class& m, const void *buf, mclSize bufSize)
 {
 	if (bufSize > Fr::getUnitSize() * sizeof(mcl::Unit)) return false;
@@ -460,6 +534,37 @@ int sheDecGT(mclInt *m, const sheSecretKey *sec, const sheCipherTextGT *c)
 	return decT(m, sec, c);
 }
 
+template<class CT>
+int decVecT(mclInt *m, const sheSecretKey *sec, const CT *c, mclSize n)
+	try
+{
+	if (n == 0) return 0;
+	std::vector<int64_t> mVec(n);
+	bool b;
+	cast(sec)->decVec(&mVec[0], cast(c), n, &b);
+	for (size_t i = 0; i < n; i++) {
+		m[i] = mclInt(mVec[i]);
+	}
+	return b ? 0 : -1;
+} catch (std::exception&) {
+	return -1;
+}
+
+int sheDecG1Vec(mclInt *m, const sheSecretKey *sec, const sheCipherTextG1 *c, mclSize n)
+{
+	return decVecT(m, sec, c, n);
+}
+
+int sheDecG2Vec(mclInt *m, const sheSecretKey *sec, const sheCipherTextG2 *c, mclSize n)
+{
+	return decVecT(m, sec, c, n);
+}
+
+int sheDecGTVec(mclInt *m, const sheSecretKey *sec, const sheCipherTextGT *c, mclSize n)
+{
+	return decVecT(m, sec, c, n);
+}
+
 template<class CT>
 int decViaGTT(mclInt *m, const sheSecretKey *sec, const CT *c)
 	try
@@ -635,6 +740,24 @@ int sheFinalExpGT(sheCipherTextGT *y, const sheCipherTextGT *x)
 	return 0;
 }
 
+int sheMulVec(sheCipherTextGT *z, const sheCipherTextG1 *x, const sheCipherTextG2 *y, mclSize n)
+	try
+{
+	CipherTextGT::mulVec(*cast(z), cast(x), cast(y), n);
+	return 0;
+} catch (std::exception&) {
+	return -1;
+}
+
+int sheMulVecMT(sheCipherTextGT *z, const sheCipherTextG1 *x, const sheCipherTextG2 *y, mclSize n, mclSize cpuN)
+	try
+{
+	CipherTextGT::mulVecMT(*cast(z), cast(x), cast(y), n, cpuN);
+	return 0;
+} catch (std::exception&) {
+	return -1;
+}
+
 template<class CT>
 int reRandT(CT& c, const shePublicKey *pub)
 {
@@ -721,6 +844,21 @@ int shePrecomputedPublicKeyEncGT(sheCipherTextGT *c, const shePrecomputedPublicK
 	return pEncT(c, pub, m);
 }
 
+int shePrecomputedPublicKeyEncG1Vec(sheCipherTextG1 *c, const shePrecomputedPublicKey *pub, const mclInt *m, mclSize n)
+{
+	return encVecT(c, pub, m, n);
+}
+
+int shePrecomputedPublicKeyEncG2Vec(sheCipherTextG2 *c, const shePrecomputedPublicKey *pub, const mclInt *m, mclSize n)
+{
+	return encVecT(c, pub, m, n);
+}
+
+int shePrecomputedPublicKeyEncGTVec(sheCipherTextGT *c, const shePrecomputedPublicKey *pub, const mclInt *m, mclSize n)
+{
+	return encVecT(c, pub, m, n);
+}
+
 template<class CT>
 int pEncIntVecT(CT *c, const shePrecomputedPublicKey *pub, const void *buf, mclSize bufSize)
 	try
@@ -3,6 +3,7 @@
 #include <mcl/aggregate_sig.hpp>
 #include <cybozu/benchmark.hpp>
 #include <cybozu/xorshift.hpp>
+#include <cybozu/itoa.hpp>
 
 using namespace mcl::aggs;
 
@@ -102,3 +103,56 @@ CYBOZU_TEST_AUTO(aggregate)
 	aggregateTest(msgVec);
 #endif
 }
+
+bool verifyEach(const std::vector<Signature>& sigVec, const std::vector<PublicKey>& pubVec, const std::vector<std::string>& msgVec)
+{
+	for (size_t i = 0; i < sigVec.size(); i++) {
+		if (!pubVec[i].verify(sigVec[i], msgVec[i])) return false;
+	}
+	return true;
+}
+
+CYBOZU_TEST_AUTO(verifyBatch)
+{
+	const size_t n = 40;
+	std::vector<SecretKey> secVec(n);
+	std::vector<PublicKey> pubVec(n);
+	std::vector<Signature> sigVec(n);
+	std::vector<std::string> msgVec(n);
+	for (size_t i = 0; i < n; i++) {
+		secVec[i].init();
+		secVec[i].getPublicKey(pubVec[i]);
+		// the same message may be signed by different keys
+		msgVec[i] = cybozu::itoa(i % 30);
+		secVec[i].sign(sigVec[i], msgVec[i]);
+	}
+	CYBOZU_TEST_ASSERT(!Signature::verifyBatch(sigVec.data(), pubVec.data(), 0, 0, 0));
+	for (size_t m = 1; m <= n; m += 13) {
+		std::vector<Signature> sv(sigVec.begin(), sigVec.begin() + m);
+		std::vector<PublicKey> pv(pubVec.begin(), pubVec.begin() + m);
+		std::vector<std::string> mv(msgVec.begin(), msgVec.begin() + m);
+		CYBOZU_TEST_ASSERT(Signature::verifyBatch(sv, pv, mv));
+		// wrong message
+		mv[m / 2] += "x";
+		CYBOZU_TEST_ASSERT(!Signature::verifyBatch(sv, pv, mv));
+		mv[m / 2] = msgVec[m / 2];
+		// wrong public key
+		if (m > 1) {
+			std::swap(pv[0], pv[m - 1]);
+			CYBOZU_TEST_ASSERT(!Signature::verifyBatch(sv, pv, mv));
+			std::swap(pv[0], pv[m - 1]);
+		}
+		// swapped signatures whose sum is unchanged
+		if (m > 1) {
+			std::swap(sv[0], sv[m - 1]);
+			CYBOZU_TEST_ASSERT(!Signature::verifyBatch(sv, pv, mv));
+			std::swap(sv[0], sv[m - 1]);
+		}
+		CYBOZU_TEST_ASSERT(Signature::verifyBatch(sv, pv, mv, 1));
+	}
+	CYBOZU_TEST_EXCEPTION(Signature::verifyBatch(sigVec, pubVec, std::vector<std::string>(n - 1)), cybozu::Exception);
+#ifdef NDEBUG
+	CYBOZU_BENCH_C("verify each", 3, verifyEach, sigVec, pubVec, msgVec);
+	CYBOZU_BENCH_C("verifyBatch", 3, Signature::verifyBatch, sigVec, pubVec, msgVec, 0);
+#endif
+}
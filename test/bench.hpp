@@ -326,4 +326,22 @@ void testLagrange()
 #endif
 		CYBOZU_BENCH_C("LagrangeInterpolation", 100, mcl::LagrangeInterpolation, &b, s, x, y, k);
 	}
+	{
+		// F without mulVec and invVec
+		const int k = 10;
+		Fp2 c[k];
+		Fp2 x[k], y[k];
+		for (size_t i = 0; i < k; i++) {
+			c[i].a.setByCSPRNG();
+			c[i].b.setByCSPRNG();
+		}
+		for (size_t i = 0; i < k; i++) {
+			x[i].a.setByCSPRNG();
+			x[i].b.setByCSPRNG();
+			mcl::evaluatePolynomial(y[i], c, k, x[i]);
+		}
+		Fp2 s;
+		mcl::LagrangeInterpolation(s, x, y, k);
+		CYBOZU_TEST_EQUAL(s, c[0]);
+	}
 }
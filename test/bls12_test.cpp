@@ -4,6 +4,7 @@
 cybozu::CpuClock clk;
 #include <cybozu/test.hpp>
 #include <mcl/bls12_381.hpp>
+#include <mcl/point_file.hpp>
 #include <cybozu/option.hpp>
 #include <cybozu/xorshift.hpp>
 
@@ -588,6 +589,75 @@ CYBOZU_TEST_AUTO(deserialize)
 	}
 }
 
+template<class G>
+void testPointFile(const G& P, const char *name)
+{
+	const size_t n = 300;
+	std::vector<G> xVec(n);
+	std::vector<Fr> yVec(n);
+	cybozu::XorShift rg;
+	for (size_t i = 0; i < n; i++) {
+		G::mul(xVec[i], P, i + 1);
+		yVec[i].setByCSPRNG(rg);
+	}
+	xVec[5].clear();
+	G z1, z2;
+	G::mulVec(z1, xVec.data(), yVec.data(), n);
+	mcl::savePointFile(name, xVec.data(), n);
+	{
+		mcl::PointFileT<G> f(name);
+		CYBOZU_TEST_EQUAL(f.size(), n);
+		CYBOZU_TEST_ASSERT(f.isValid());
+		for (size_t i = 0; i < n; i++) {
+			CYBOZU_TEST_EQUAL(f[i], xVec[i]);
+		}
+		G::mulVec(z2, f.data(), yVec.data(), n);
+		CYBOZU_TEST_EQUAL(z1, z2);
+		// the file is not changed
+		f.data()[0] = f[1];
+	}
+	{
+		mcl::PointFileT<G> f(name);
+		CYBOZU_TEST_EQUAL(f[0], xVec[0]);
+		// a point not in the subgroup
+		G Q;
+		mcl::ec::tryAndIncMapTo(Q, typename G::Fp(1));
+		Q.normalize();
+		if (!Q.isValidOrder()) {
+			f.data()[1] = Q;
+			CYBOZU_TEST_ASSERT(!f.isValid());
+		}
+		// not normalized
+		G::dbl(f.data()[2], f[2]);
+		CYBOZU_TEST_ASSERT(!f.isValid());
+	}
+	{
+		// broken data
+		FILE *fp = fopen(name, "r+b");
+		CYBOZU_TEST_ASSERT(fp);
+		fseek(fp, long(sizeof(mcl::PointFileHeader) + sizeof(G)), SEEK_SET);
+		fputc(1, fp);
+		fclose(fp);
+	}
+	CYBOZU_TEST_EXCEPTION(mcl::PointFileT<G> f(name), cybozu::Exception);
+	{
+		mcl::PointFileT<G> f(name, false);
+		CYBOZU_TEST_ASSERT(!f.isValid());
+	}
+	CYBOZU_TEST_EXCEPTION(mcl::PointFileT<G1> f("not-exist-point-file"), cybozu::Exception);
+	cybozu::RemoveFile(name);
+}
+
+CYBOZU_TEST_AUTO(pointFile)
+{
+	G1 P;
+	G2 Q;
+	mapToG1(P, 5);
+	mapToG2(Q, 5);
+	testPointFile(P, "point_file_g1.bin");
+	testPointFile(Q, "point_file_g2.bin");
+}
+
 CYBOZU_TEST_AUTO(verifyG1)
 {
 	const char *ok_x = "ad50e39253e0de4fad89440f01f1874c8bc91fdcd59ad66162984b10690e51ccf4d95e4222df14549d745d8b971199";
@@ -712,6 +782,61 @@ void splitTest(const mpz_class& mx, const mpz_class& L)
 	CYBOZU_TEST_EQUAL(ma, mx % L);
 }
 
+template<class G>
+size_t isValidOrderEach(const G *xVec, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		if (!xVec[i].isValidOrder()) return i;
+	}
+	return n;
+}
+
+template<class G>
+void testIsValidOrderVec(const G& P)
+{
+	const size_t n = 1000;
+	std::vector<G> xVec(n);
+	xVec[0] = P;
+	for (size_t i = 1; i < n; i++) {
+		G::add(xVec[i], xVec[i - 1], P);
+	}
+	xVec[10].clear();
+	// a point not in the subgroup
+	G Q;
+	mcl::ec::tryAndIncMapTo(Q, typename G::Fp(1));
+	CYBOZU_TEST_ASSERT(!Q.isValidOrder());
+	const size_t badTbl[] = { n, 0, 255, 256, 700, n - 1 };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(badTbl); i++) {
+		const size_t bad = badTbl[i];
+		std::vector<G> v = xVec;
+		if (bad < n) {
+			v[bad] = Q;
+			// the second one is not reported
+			if (bad + 10 < n) v[bad + 10] = Q;
+		}
+		for (size_t cpuN = 0; cpuN < 3; cpuN++) {
+			CYBOZU_TEST_EQUAL(isValidOrderVec(v.data(), n, cpuN), bad);
+		}
+	}
+	CYBOZU_TEST_EQUAL(isValidOrderVec(xVec.data(), 0), 0u);
+#ifdef NDEBUG
+	CYBOZU_BENCH_C("isValidOrder", 1, isValidOrderEach, xVec.data(), n);
+	CYBOZU_BENCH_C("isValidOrderVec", 1, isValidOrderVec, xVec.data(), n, 0);
+#endif
+}
+
+CYBOZU_TEST_AUTO(isValidOrderVec)
+{
+	G1 P;
+	G2 Q;
+	mapToG1(P, 5);
+	mapToG2(Q, 5);
+	puts("G1");
+	testIsValidOrderVec(P);
+	puts("G2");
+	testIsValidOrderVec(Q);
+}
+
 CYBOZU_TEST_AUTO(split)
 {
 	const char *Ls = "ac45a4010001a40200000000ffffffff";
@@ -167,6 +167,28 @@ void testBLS12_377()
 	testGTBLS12_377(P, Q);
 }
 
+/*
+	compare isValidOrderBLS12 with rQ == 0
+	for points made by tryAndIncMapTo (without clearing the cofactor) and multiples of P
+*/
+template<class G>
+void testIsValidOrderBLS12(const G& P)
+{
+	const mpz_class& r = Fr::getOp().mp;
+	int okN = 0;
+	for (int i = 1; i < 30; i++) {
+		G Q, T;
+		mcl::ec::tryAndIncMapTo(Q, typename G::Fp(i));
+		G::mulGeneric(T, Q, r);
+		CYBOZU_TEST_EQUAL(isValidOrderBLS12(Q), T.isZero());
+		G::mul(Q, P, i);
+		CYBOZU_TEST_ASSERT(isValidOrderBLS12(Q));
+		okN += T.isZero();
+	}
+	// the cofactor is large, so almost all Q are not in the subgroup
+	CYBOZU_TEST_ASSERT(okN < 3);
+}
+
 void testCurve(const mcl::CurveParam& cp)
 {
 	initPairing(cp);
@@ -211,6 +233,10 @@ void testCurve(const mcl::CurveParam& cp)
 		GT::pow(e, e1, a * b);
 		CYBOZU_TEST_EQUAL(e2, e);
 	}
+	if (cp == mcl::BLS12_377 || cp == mcl::BLS12_381) {
+		testIsValidOrderBLS12(P);
+		testIsValidOrderBLS12(Q);
+	}
 	testCommon(P, Q);
 	testBench(P, Q);
 	testSquareRoot();
@@ -629,6 +629,49 @@ void millerLoopVecMTTest()
 	}
 }
 
+void verifyBatchG1Test()
+{
+	const size_t n = 5;
+	const size_t msgSize = 8;
+	char msg[n * msgSize];
+	mclBnG2 Q, pub[n];
+	mclBnG1 sig[n];
+	mclBnG2_hashAndMapTo(&Q, "Q", 1);
+	for (size_t i = 0; i < n; i++) {
+		mclBnFr x;
+		mclBnFr_setInt(&x, int(i * 12345 + 7));
+		memset(msg + i * msgSize, 'a' + int(i), msgSize);
+		mclBnG2_mul(&pub[i], &Q, &x);
+		mclBnG1_hashAndMapTo(&sig[i], msg + i * msgSize, msgSize);
+		mclBnG1_mul(&sig[i], &sig[i], &x);
+	}
+	CYBOZU_TEST_ASSERT(!mclBn_verifyBatchG1(sig, pub, msg, msgSize, 0, &Q, 0));
+	CYBOZU_TEST_ASSERT(mclBn_verifyBatchG1(sig, pub, msg, msgSize, n, &Q, 0));
+	msg[msgSize * 2] ^= 1;
+	CYBOZU_TEST_ASSERT(!mclBn_verifyBatchG1(sig, pub, msg, msgSize, n, &Q, 0));
+	msg[msgSize * 2] ^= 1;
+	mclBnG1_add(&sig[0], &sig[0], &sig[1]);
+	CYBOZU_TEST_ASSERT(!mclBn_verifyBatchG1(sig, pub, msg, msgSize, n, &Q, 0));
+}
+
+void hashAndMapToVecTest()
+{
+	const size_t n = 11;
+	const size_t msgSize = 5;
+	char msg[n * msgSize];
+	mclBnG1 P1[n], P2;
+	mclBnG2 Q1[n], Q2;
+	for (size_t i = 0; i < sizeof(msg); i++) msg[i] = char(i * 3);
+	CYBOZU_TEST_EQUAL(mclBnG1_hashAndMapToVec(P1, msg, msgSize, n, 0), 0);
+	CYBOZU_TEST_EQUAL(mclBnG2_hashAndMapToVec(Q1, msg, msgSize, n, 0), 0);
+	for (size_t i = 0; i < n; i++) {
+		CYBOZU_TEST_ASSERT(!mclBnG1_hashAndMapTo(&P2, msg + i * msgSize, msgSize));
+		CYBOZU_TEST_ASSERT(!mclBnG2_hashAndMapTo(&Q2, msg + i * msgSize, msgSize));
+		CYBOZU_TEST_ASSERT(mclBnG1_isEqual(&P1[i], &P2));
+		CYBOZU_TEST_ASSERT(mclBnG2_isEqual(&Q1[i], &Q2));
+	}
+}
+
 void serializeTest()
 {
 	const size_t FrSize = mclBn_getFrByteSize();
@@ -704,6 +747,62 @@ void serializeTest()
 	CYBOZU_TEST_EQUAL(n, expectSize);
 }
 
+void deserializeVecTest()
+{
+	const size_t n = 1100; // greater than the block size of deserializeVec
+	const size_t G1Size = mclBn_getG1ByteSize();
+	const size_t G2Size = G1Size * 2;
+	std::vector<mclBnG1> P1(n), P2(n);
+	std::vector<mclBnG2> Q1(n), Q2(n);
+	std::vector<char> buf1(G1Size * n), buf2(G2Size * n);
+	std::vector<int> ok(n);
+	for (size_t i = 0; i < n; i++) {
+		mclBnG1_hashAndMapTo(&P1[i], &i, sizeof(i));
+		mclBnG2_hashAndMapTo(&Q1[i], &i, sizeof(i));
+		if (i == 7) {
+			mclBnG1_clear(&P1[i]);
+			mclBnG2_clear(&Q1[i]);
+		}
+		CYBOZU_TEST_EQUAL(mclBnG1_serialize(&buf1[G1Size * i], G1Size, &P1[i]), G1Size);
+		CYBOZU_TEST_EQUAL(mclBnG2_serialize(&buf2[G2Size * i], G2Size, &Q1[i]), G2Size);
+	}
+	CYBOZU_TEST_EQUAL(mclBnG1_deserializeVec(P2.data(), ok.data(), buf1.data(), buf1.size(), n, 0), n);
+	CYBOZU_TEST_EQUAL(mclBnG2_deserializeVec(Q2.data(), 0, buf2.data(), buf2.size(), n, 0), n);
+	for (size_t i = 0; i < n; i++) {
+		CYBOZU_TEST_EQUAL(ok[i], 1);
+		CYBOZU_TEST_ASSERT(mclBnG1_isEqual(&P1[i], &P2[i]));
+		CYBOZU_TEST_ASSERT(mclBnG2_isEqual(&Q1[i], &Q2[i]));
+	}
+	// broken points and a short buffer
+	const size_t badTbl[] = { 3, 1050 };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(badTbl); i++) {
+		memset(&buf1[G1Size * badTbl[i]], 0xff, G1Size);
+		memset(&buf2[G2Size * badTbl[i]], 0xff, G2Size);
+	}
+	for (size_t cpuN = 0; cpuN < 3; cpuN++) {
+		CYBOZU_TEST_EQUAL(mclBnG1_deserializeVec(P2.data(), ok.data(), buf1.data(), buf1.size() - 1, n, cpuN), n - 3);
+		for (size_t i = 0; i < n; i++) {
+			const bool bad = i == 3 || i == 1050 || i == n - 1;
+			CYBOZU_TEST_EQUAL(ok[i], !bad);
+			if (bad) {
+				CYBOZU_TEST_ASSERT(mclBnG1_isZero(&P2[i]));
+			} else {
+				CYBOZU_TEST_ASSERT(mclBnG1_isEqual(&P1[i], &P2[i]));
+			}
+		}
+		CYBOZU_TEST_EQUAL(mclBnG2_deserializeVec(Q2.data(), ok.data(), buf2.data(), buf2.size() - 1, n, cpuN), n - 3);
+		for (size_t i = 0; i < n; i++) {
+			const bool bad = i == 3 || i == 1050 || i == n - 1;
+			CYBOZU_TEST_EQUAL(ok[i], !bad);
+			if (bad) {
+				CYBOZU_TEST_ASSERT(mclBnG2_isZero(&Q2[i]));
+			} else {
+				CYBOZU_TEST_ASSERT(mclBnG2_isEqual(&Q1[i], &Q2[i]));
+			}
+		}
+	}
+}
+
 void serializeToHexStrTest()
 {
 	const size_t FrSize = mclBn_getFrByteSize();
@@ -1264,6 +1363,30 @@ void mulVecTest()
 	CYBOZU_TEST_ASSERT(mclBnG1_isEqual(&z1, &w1));
 	CYBOZU_TEST_ASSERT(mclBnG2_isEqual(&z2, &w2));
 	CYBOZU_TEST_ASSERT(mclBnGT_isEqual(&zt, &wt));
+
+	const mclSize c = 6;
+	std::vector<mclBnG1> tbl1(mclBn_getPrecomputedMulVecSize(N, c));
+	std::vector<mclBnG2> tbl2(mclBn_getPrecomputedMulVecSize(N, c));
+	CYBOZU_TEST_EQUAL(mclBnG1_precomputeMulVec(tbl1.data(), x1Vec, N, c), 0);
+	CYBOZU_TEST_EQUAL(mclBnG2_precomputeMulVec(tbl2.data(), x2Vec, N, c), 0);
+	CYBOZU_TEST_EQUAL(mclBnG1_mulVecFixedBase(&z1, tbl1.data(), yVec, N, c), 0);
+	CYBOZU_TEST_EQUAL(mclBnG2_mulVecFixedBase(&z2, tbl2.data(), yVec, N, c), 0);
+	CYBOZU_TEST_ASSERT(mclBnG1_isEqual(&z1, &w1));
+	CYBOZU_TEST_ASSERT(mclBnG2_isEqual(&z2, &w2));
+	// the default c depends on n, so c = 0 is rejected
+	CYBOZU_TEST_EQUAL(mclBn_getPrecomputedMulVecSize(N, 0), 0u);
+	CYBOZU_TEST_EQUAL(mclBnG1_precomputeMulVec(tbl1.data(), x1Vec, N, 0), -1);
+	CYBOZU_TEST_EQUAL(mclBnG1_mulVecFixedBase(&z1, tbl1.data(), yVec, N, 0), -1);
+	CYBOZU_TEST_EQUAL(mclBnG2_mulVecFixedBase(&z2, tbl2.data(), yVec, N, 21), -1);
+	CYBOZU_TEST_ASSERT(mclBn_getMulVecFixedBaseWindowSize(N) > 0);
+	// tbl for N can be used for m < N with the same c
+	const mclSize m = N / 2;
+	CYBOZU_TEST_EQUAL(mclBnG1_mulVecFixedBase(&z1, tbl1.data(), yVec, m, c), 0);
+	CYBOZU_TEST_EQUAL(mclBnG2_mulVecFixedBase(&z2, tbl2.data(), yVec, m, c), 0);
+	mclBnG1_mulVec(&w1, x1Vec, yVec, m);
+	mclBnG2_mulVec(&w2, x2Vec, yVec, m);
+	CYBOZU_TEST_ASSERT(mclBnG1_isEqual(&z1, &w1));
+	CYBOZU_TEST_ASSERT(mclBnG2_isEqual(&z2, &w2));
 }
 
 void testAll(int curveType)
@@ -1288,7 +1411,10 @@ void testAll(int curveType)
 	precomputedTest();
 	millerLoopVecTest();
 	millerLoopVecMTTest();
+	verifyBatchG1Test();
+	hashAndMapToVecTest();
 	serializeTest();
+	deserializeVecTest();
 	serializeToHexStrTest();
 	ETHserializationTest();
 	setRandFuncTest();
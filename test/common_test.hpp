@@ -60,6 +60,17 @@ void testMulVec(const G& P)
 		CYBOZU_BENCH_C("mulVecCopy", C, mulVecCopy, Q1, xVec.data(), yVec.data(), n, x0Vec.data());
 #endif
 	}
+	puts("mulVecMT");
+	const size_t nTblMT[] = { 1, 31, 128, 1000, N };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(nTblMT); i++) {
+		const size_t n = nTblMT[i];
+		G Q1, Q2;
+		naiveMulVec(Q1, xVec.data(), yVec.data(), n);
+		for (size_t cpuN = 0; cpuN < 5; cpuN++) {
+			G::mulVecMT(Q2, xVec.data(), yVec.data(), n, cpuN);
+			CYBOZU_TEST_EQUAL(Q1, Q2);
+		}
+	}
 	puts("mulEach");
 	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(nTbl); i++) {
 		const size_t n = nTbl[i];
@@ -73,6 +84,82 @@ void testMulVec(const G& P)
 	}
 }
 
+template<class G>
+void testMulVecFixedBase(const G& P)
+{
+	using namespace mcl::bn;
+	const size_t N = 1000;
+	std::vector<G> xVec(N);
+	std::vector<Fr> yVec(N);
+	cybozu::XorShift rg;
+	for (size_t i = 0; i < N; i++) {
+		G::mul(xVec[i], P, i + 5);
+		yVec[i].setByCSPRNG(rg);
+	}
+	xVec[7].clear();
+	yVec[9].clear();
+	// the same point as xVec[1] to add to the same bucket
+	xVec[3] = xVec[1];
+	yVec[3] = yVec[1];
+	const size_t nTbl[] = { 1, 2, 16, 100, N };
+	const size_t cTbl[] = { 0, 1, 4, 8 };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(nTbl); i++) {
+		const size_t n = nTbl[i];
+		G Q1, Q2;
+		naiveMulVec(Q1, xVec.data(), yVec.data(), n);
+		for (size_t j = 0; j < CYBOZU_NUM_OF_ARRAY(cTbl); j++) {
+			const size_t c = cTbl[j];
+			std::vector<G> tbl(getPrecomputedMulVecSize(n, c));
+			precomputeMulVec(tbl.data(), xVec.data(), n, c);
+			mulVecFixedBase(Q2, tbl.data(), yVec.data(), n, c);
+			CYBOZU_TEST_EQUAL(Q1, Q2);
+		}
+	}
+	MsmPrecompT<G> precomp, precomp2;
+	precomp.init(xVec.data(), N);
+	std::string str;
+	cybozu::StringOutputStream os(str);
+	precomp.save(os);
+	cybozu::StringInputStream is(str);
+	precomp2.load(is);
+	CYBOZU_TEST_EQUAL(precomp2.size(), N);
+	CYBOZU_TEST_EQUAL(precomp2.getWindowSize(), precomp.getWindowSize());
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(nTbl); i++) {
+		const size_t n = nTbl[i];
+		G Q1, Q2;
+		naiveMulVec(Q1, xVec.data(), yVec.data(), n);
+		precomp2.mulVec(Q2, yVec.data(), n);
+		CYBOZU_TEST_EQUAL(Q1, Q2);
+	}
+	{
+		// truncated
+		std::string s = str.substr(0, str.size() - 1);
+		cybozu::StringInputStream is3(s);
+		CYBOZU_TEST_EXCEPTION(precomp2.load(is3), cybozu::Exception);
+		// broken table
+		s = str;
+		s[s.size() - 1] ^= 1;
+		cybozu::StringInputStream is4(s);
+		CYBOZU_TEST_EXCEPTION(precomp2.load(is4), cybozu::Exception);
+		// too large n (n is at offset 16)
+		s = str;
+		s[16 + 7] = 0x40;
+		cybozu::StringInputStream is5(s);
+		CYBOZU_TEST_EXCEPTION(precomp2.load(is5), cybozu::Exception);
+		// the table is not changed by a failed load
+		CYBOZU_TEST_EQUAL(precomp2.size(), N);
+		G Q1, Q2;
+		naiveMulVec(Q1, xVec.data(), yVec.data(), N);
+		precomp2.mulVec(Q2, yVec.data(), N);
+		CYBOZU_TEST_EQUAL(Q1, Q2);
+	}
+	str[0]++;
+	cybozu::StringInputStream is2(str);
+	CYBOZU_TEST_EXCEPTION(precomp2.load(is2), cybozu::Exception);
+	G Q;
+	CYBOZU_TEST_EXCEPTION(precomp.mulVec(Q, yVec.data(), N + 1), cybozu::Exception);
+}
+
 template<class G>
 void naivePowVec(G& out, const G *xVec, const Fr *yVec, size_t n)
 {
@@ -273,8 +360,10 @@ void testCommon(const G1& P, const G2& Q)
 	testMul2();
 	puts("G1");
 	testMulVec(P);
+	testMulVecFixedBase(P);
 	puts("G2");
 	testMulVec(Q);
+	testMulVecFixedBase(Q);
 	testMulCT(Q);
 	GT e;
 	mcl::bn::pairing(e, P, Q);
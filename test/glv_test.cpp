@@ -6,6 +6,8 @@
 
 #include <mcl/bls12_381.hpp>
 using namespace mcl::bn;
+#define MCL_GLV_ONLY_FUNC
+#include "../src/glv.hpp"
 
 /*
 	Skew Frobenius Map and Efficient Scalar Multiplication for Pairing-Based Cryptography
@@ -154,6 +156,63 @@ void testMulVec(const G& P, const char *name)
 		CYBOZU_BENCH_C("mulVec", C, mulVecCopy, Q1, xVec.data(), yVec.data(), n, x0Vec.data());
 #endif
 	}
+#ifdef MCL_USE_OMP
+	const size_t maxCpuN = omp_get_num_procs();
+	for (size_t cpuN = 1; cpuN <= maxCpuN; cpuN *= 2) {
+		G Q1, Q2;
+		G::mulVec(Q1, xVec.data(), yVec.data(), N);
+		G::mulVecMT(Q2, xVec.data(), yVec.data(), N, cpuN);
+		CYBOZU_TEST_EQUAL(Q1, Q2);
+#ifdef NDEBUG
+		printf("n=%d cpuN=%zd\n", N, cpuN);
+		CYBOZU_BENCH_C("mulVecMT", 10, G::mulVecMT, Q2, xVec.data(), yVec.data(), N, cpuN);
+#endif
+	}
+#endif
+}
+
+template<class G>
+void testMulVecAffine(const G& P, const char *name)
+{
+	printf("testMulVecAffine %s\n", name);
+	const size_t maxN = 1 << 16;
+	const size_t yUnitSize = 128 / mcl::UnitBitSize;
+	std::vector<G> xVec(maxN);
+	std::vector<mcl::Unit> yVec(maxN * yUnitSize);
+	cybozu::XorShift rg;
+	xVec[0] = P;
+	for (size_t i = 1; i < maxN; i++) {
+		G::add(xVec[i], xVec[i - 1], P);
+	}
+	xVec[3].clear();
+	G::normalizeVec(xVec.data(), xVec.data(), maxN);
+	for (size_t i = 0; i < yVec.size(); i++) {
+		yVec[i] = (mcl::Unit)rg.get64();
+	}
+	const size_t nTbl[] = { 2, 3, 100, 1000 };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(nTbl); i++) {
+		const size_t n = nTbl[i];
+		G Q1, Q2;
+		mcl::ec::mulVecCore(Q1, xVec.data(), yVec.data(), yUnitSize, yUnitSize, n, 0, false);
+		CYBOZU_TEST_ASSERT(mcl::ec::mulVecAffine(Q2, xVec.data(), yVec.data(), yUnitSize, yUnitSize, n, 0, false));
+		CYBOZU_TEST_EQUAL(Q1, Q2);
+		// the same bucket in each window
+		CYBOZU_TEST_ASSERT(mcl::ec::mulVecAffine(Q2, xVec.data(), yVec.data(), yUnitSize, 0, n, 0, false));
+		Q1.clear();
+		for (size_t j = 0; j < n; j++) Q1 += xVec[j];
+		G::mulArray(Q1, Q1, yVec.data(), yUnitSize);
+		CYBOZU_TEST_EQUAL(Q1, Q2);
+	}
+#ifdef NDEBUG
+	// compare Jacobi and affine buckets
+	for (size_t n = 1 << 10; n <= maxN; n *= 2) {
+		G Q1, Q2;
+		printf("n=%zd\n", n);
+		CYBOZU_BENCH_C("Jacobi", 3, mcl::ec::mulVecCore, Q1, xVec.data(), yVec.data(), yUnitSize, yUnitSize, n, 0, false);
+		CYBOZU_BENCH_C("affine", 3, mcl::ec::mulVecAffine, Q2, xVec.data(), yVec.data(), yUnitSize, yUnitSize, n, 0, false);
+		CYBOZU_TEST_EQUAL(Q1, Q2);
+	}
+#endif
 }
 
 void naivePowVec(GT& out, const GT *xVec, const Fr *yVec, size_t n)
@@ -252,6 +311,8 @@ CYBOZU_TEST_AUTO(glv)
 		testGT(e);
 		testMulVec(P, "G1");
 		testMulVec(Q, "G2");
+		testMulVecAffine(P, "G1");
+		testMulVecAffine(Q, "G2");
 		testPowVec(e);
 	}
 }
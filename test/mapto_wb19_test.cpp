@@ -848,6 +848,194 @@ void testSameUV(const MapTo& mapto)
 	}
 }
 
+void testFpToGVec(const MapTo& mapto)
+{
+	const size_t N = 35;
+	Fp u[N * 2];
+	Fp2 t[N * 2];
+	for (size_t i = 0; i < N * 2; i++) {
+		u[i].setByCSPRNG();
+		t[i].a.setByCSPRNG();
+		t[i].b.setByCSPRNG();
+	}
+	// special values
+	u[0] = 0;
+	t[0] = 0;
+	u[3] = u[2];
+	t[3] = t[2];
+	G1 P1[N], Q1;
+	G2 P2[N], Q2;
+	const size_t nTbl[] = { 1, 5, 16, 17, N };
+	for (size_t k = 0; k < CYBOZU_NUM_OF_ARRAY(nTbl); k++) {
+		const size_t n = nTbl[k];
+		mapto.FpToG1Vec(P1, u, n);
+		mapto.Fp2ToG2Vec(P2, t, n);
+		for (size_t i = 0; i < n; i++) {
+			mapto.FpToG1(Q1, u[i * 2], &u[i * 2 + 1]);
+			CYBOZU_TEST_EQUAL(P1[i], Q1);
+			mapto.Fp2ToG2(Q2, t[i * 2], &t[i * 2 + 1]);
+			CYBOZU_TEST_EQUAL(P2[i], Q2);
+		}
+	}
+#ifdef NDEBUG
+	CYBOZU_BENCH_C("FpToG1Vec x16", 100, mapto.FpToG1Vec, P1, u, 16);
+	CYBOZU_BENCH_C("Fp2ToG2Vec x16", 10, mapto.Fp2ToG2Vec, P2, t, 16);
+#endif
+}
+
+void mulByCofactorLoop(G2 *Q, const G2 *P, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		mcl::mulByCofactorBLS12fast(Q[i], P[i]);
+	}
+}
+
+void testMulByCofactorVec(const MapTo& mapto)
+{
+	const size_t N = 40;
+	// points on E2 not in G2
+	G2 P[N], Q1[N], Q2[N];
+	for (size_t i = 0; i < N; i++) {
+		Fp2 t;
+		t.a.setByCSPRNG();
+		t.b.setByCSPRNG();
+		MapTo::E2 Pp;
+		mapto.sswuG2(Pp, t);
+		mapto.iso3(P[i], Pp);
+	}
+	P[5].clear();
+	const size_t nTbl[] = { 1, 7, 8, 9, 33, N };
+	for (size_t k = 0; k < CYBOZU_NUM_OF_ARRAY(nTbl); k++) {
+		const size_t n = nTbl[k];
+		mcl::mulByCofactorBLS12fastVec(Q1, P, n);
+		mulByCofactorLoop(Q2, P, n);
+		for (size_t i = 0; i < n; i++) {
+			CYBOZU_TEST_EQUAL(Q1[i], Q2[i]);
+			CYBOZU_TEST_ASSERT(Q1[i].isNormalized());
+		}
+	}
+	// Q == P
+	mcl::mulByCofactorBLS12fastVec(P, P, N);
+	for (size_t i = 0; i < N; i++) {
+		CYBOZU_TEST_EQUAL(P[i], Q2[i]);
+		CYBOZU_TEST_ASSERT(P[i].isValid());
+	}
+#ifdef NDEBUG
+	CYBOZU_BENCH_C("mulByCofactorBLS12fast x32", 100, mulByCofactorLoop, Q2, Q1, 32);
+	CYBOZU_BENCH_C("mulByCofactorBLS12fastVec x32", 100, mcl::mulByCofactorBLS12fastVec, Q2, Q1, 32);
+#endif
+}
+
+void expandLoop(uint8_t *out, size_t outSize, const void *const *msgVec, const size_t *msgSizeVec, size_t n, const void *dst, size_t dstSize)
+{
+	for (size_t i = 0; i < n; i++) {
+		mcl::fp::expand_message_xmd(out + outSize * i, outSize, msgVec[i], msgSizeVec[i], dst, dstSize);
+	}
+}
+
+void hashAndMapToG1Loop(G1 *P, const void *const *msgVec, const size_t *msgSizeVec, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		mcl::bn::hashAndMapToG1(P[i], msgVec[i], msgSizeVec[i]);
+	}
+}
+
+void hashAndMapToG2Loop(G2 *P, const void *const *msgVec, const size_t *msgSizeVec, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		mcl::bn::hashAndMapToG2(P[i], msgVec[i], msgSizeVec[i]);
+	}
+}
+
+void testHashVec()
+{
+	const size_t N = 300;
+	std::vector<std::string> msgs(N);
+	std::vector<const void*> msgVec(N);
+	std::vector<size_t> msgSizeVec(N);
+	for (size_t i = 0; i < N; i++) {
+		msgs[i].resize(i);
+		for (size_t j = 0; j < i; j++) msgs[i][j] = char(i * 7 + j);
+		msgVec[i] = msgs[i].data();
+		msgSizeVec[i] = msgs[i].size();
+	}
+	const size_t dstTbl[] = { 0, 1, 43, 64, 200, 255, 300 };
+	const size_t outTbl[] = { 32, 64, 128, 256 };
+	std::string largeDst(300, 'a');
+	for (size_t i = 0; i < largeDst.size(); i++) largeDst[i] = char(i);
+	std::vector<uint8_t> out(N * 256), md(256);
+	for (size_t di = 0; di < CYBOZU_NUM_OF_ARRAY(dstTbl); di++) {
+		const size_t dstSize = dstTbl[di];
+		for (size_t oi = 0; oi < CYBOZU_NUM_OF_ARRAY(outTbl); oi++) {
+			const size_t outSize = outTbl[oi];
+			// n = 1, 7, 9, ... are not multiples of 8
+			const size_t nTbl[] = { 1, 7, 9, 17, N };
+			for (size_t ni = 0; ni < CYBOZU_NUM_OF_ARRAY(nTbl); ni++) {
+				const size_t n = nTbl[ni];
+				const size_t off = N - n;
+				mcl::fp::expand_message_xmd_vec(&out[0], outSize, &msgVec[off], &msgSizeVec[off], n, largeDst.data(), dstSize);
+				for (size_t i = 0; i < n; i++) {
+					mcl::fp::expand_message_xmd(&md[0], outSize, msgVec[off + i], msgSizeVec[off + i], largeDst.data(), dstSize);
+					CYBOZU_TEST_ASSERT(memcmp(&out[outSize * i], &md[0], outSize) == 0);
+				}
+			}
+		}
+	}
+	const size_t n = 100;
+	std::vector<G1> P1(n), Q1(n);
+	std::vector<G2> P2(n), Q2(n);
+	mcl::bn::hashAndMapToG1Vec(&P1[0], &msgVec[0], &msgSizeVec[0], n);
+	mcl::bn::hashAndMapToG2Vec(&P2[0], &msgVec[0], &msgSizeVec[0], n);
+	for (size_t i = 0; i < n; i++) {
+		mcl::bn::hashAndMapToG1(Q1[i], msgVec[i], msgSizeVec[i]);
+		mcl::bn::hashAndMapToG2(Q2[i], msgVec[i], msgSizeVec[i]);
+		CYBOZU_TEST_EQUAL(P1[i], Q1[i]);
+		CYBOZU_TEST_EQUAL(P2[i], Q2[i]);
+	}
+#ifdef NDEBUG
+	{
+		const int C = 100;
+		const size_t m = 64;
+		for (size_t i = 0; i < m; i++) msgSizeVec[i] = 32;
+		CYBOZU_BENCH_C("expand_message_xmd x64", C, expandLoop, &out[0], 128, &msgVec[0], &msgSizeVec[0], m, largeDst.data(), 43);
+		CYBOZU_BENCH_C("expand_message_xmd_vec x64", C, mcl::fp::expand_message_xmd_vec, &out[0], 128, &msgVec[0], &msgSizeVec[0], m, largeDst.data(), 43);
+		CYBOZU_BENCH_C("hashAndMapToG1 x64", C, hashAndMapToG1Loop, &Q1[0], &msgVec[0], &msgSizeVec[0], m);
+		CYBOZU_BENCH_C("hashAndMapToG1Vec x64", C, mcl::bn::hashAndMapToG1Vec, &P1[0], &msgVec[0], &msgSizeVec[0], m);
+		CYBOZU_BENCH_C("hashAndMapToG2 x64", C / 10, hashAndMapToG2Loop, &Q2[0], &msgVec[0], &msgSizeVec[0], m);
+		CYBOZU_BENCH_C("hashAndMapToG2Vec x64", C / 10, mcl::bn::hashAndMapToG2Vec, &P2[0], &msgVec[0], &msgSizeVec[0], m);
+	}
+#endif
+}
+
+/*
+	msgToG2(out, msg, msgSize) must use the length of dstG2
+	even if it is different from that of dstG1
+*/
+void testMsgToG2Dst(MapTo& mapto)
+{
+	const MapTo::Dst dstG1 = mapto.dstG1;
+	const MapTo::Dst dstG2 = mapto.dstG2;
+	const char *dst = "QUUX-V01-CS02-with-BLS12381G2_XMD:SHA-256_SSWU_RO_";
+	CYBOZU_TEST_ASSERT(mapto.dstG1.set("abc", 3));
+	CYBOZU_TEST_ASSERT(mapto.dstG2.set(dst, strlen(dst)));
+	const Fp2Str x = {
+		"0x02c2d18e033b960562aae3cab37a27ce00d80ccd5ba4b7fe0e7a210245129dbec7780ccc7954725f4168aff2787776e6",
+		"0x139cddbccdc5e91b9623efd38c49f81a6f83f175e80b06fc374de9eb4b41dfe4ca3a230ed250fbe3a2acf73a41177fd8",
+	};
+	const Fp2Str y = {
+		"0x1787327b68159716a37440985269cf584bcb1e621d3a7202be6ea05c4cfe244aeb197642555a0645fb87bf7466b2ba48",
+		"0x00aa65dae3c8d732d10ecd2c50f8a1baf3001578f71c694e03866e9f3d49ac1e1ce70dd94a733534f106d4cec0eddd16",
+	};
+	G2 P1, P2;
+	set(P1.x, x);
+	set(P1.y, y);
+	P1.z = 1;
+	mapto.msgToG2(P2, "abc", 3);
+	CYBOZU_TEST_EQUAL(P1, P2);
+	mapto.dstG1 = dstG1;
+	mapto.dstG2 = dstG2;
+}
+
 void testSetDst(MapTo& mapto)
 {
 	const char *dst = "abc";
@@ -883,6 +1071,10 @@ CYBOZU_TEST_AUTO(test)
 	testMsgToG1(mapto);
 	testFpToG1(mapto);
 	testSameUV(mapto);
+	testMsgToG2Dst(mapto);
+	testFpToGVec(mapto);
+	testMulByCofactorVec(mapto);
+	testHashVec();
 	// this test should be last
 	testSetDst(mapto);
 }
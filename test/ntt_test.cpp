@@ -1,5 +1,8 @@
 #include <mcl/bls12_381.hpp>
 #include <mcl/ntt.hpp>
+#include <mcl/polynomial.hpp>
+#include <mcl/lagrange.hpp>
+#include <mcl/ecparam.hpp>
 #include <cybozu/test.hpp>
 #include <cybozu/xorshift.hpp>
 
@@ -123,3 +126,300 @@ CYBOZU_TEST_AUTO(generic)
 	puts("G1");
 	test<NTT, G1>(ntt, inG1, maxBitN);
 }
+
+CYBOZU_TEST_AUTO(fourStep)
+{
+	typedef mcl::Ntt<Fr> NTT;
+	const size_t maxBitN = NTT::directMaxBitN + 3;
+	const size_t maxN = size_t(1) << maxBitN;
+	std::vector<Fr> in(maxN), out(maxN), out2(maxN);
+	cybozu::XorShift rg;
+	for (size_t i = 0; i < maxN; i++) {
+		in[i].setByCSPRNG(rg);
+	}
+	NTT ntt;
+	for (size_t bitN = 1; bitN <= maxBitN; bitN++) {
+		const size_t n = size_t(1) << bitN;
+		ntt.init(n);
+		// compare with the radix-2 implementation
+		copy(out.data(), in.data(), n);
+		ntt.ntt(out.data());
+		copy(out2.data(), in.data(), n);
+		ntt._ntt(out2.data(), ntt.getWs(), false);
+		CYBOZU_TEST_EQUAL_ARRAY(out, out2, n);
+		ntt.intt(out.data());
+		CYBOZU_TEST_EQUAL_ARRAY(out, in, n);
+	}
+}
+
+CYBOZU_TEST_AUTO(vecOp)
+{
+	const size_t maxN = 300;
+	std::vector<Fr> x(maxN), y(maxN), z(maxN), w(maxN);
+	cybozu::XorShift rg;
+	for (size_t i = 0; i < maxN; i++) {
+		x[i].setByCSPRNG(rg);
+		y[i].setByCSPRNG(rg);
+	}
+	x[3].clear();
+	x[100] = 1;
+	const size_t tbl[] = { 1, 7, 8, 15, 64, 71, 128, 257, maxN };
+	for (size_t k = 0; k < CYBOZU_NUM_OF_ARRAY(tbl); k++) {
+		const size_t n = tbl[k];
+		Fr::mulVec(z.data(), x.data(), y.data(), n);
+		for (size_t i = 0; i < n; i++) Fr::mul(w[i], x[i], y[i]);
+		CYBOZU_TEST_EQUAL_ARRAY(z, w, n);
+		Fr::addVec(z.data(), x.data(), y.data(), n);
+		for (size_t i = 0; i < n; i++) Fr::add(w[i], x[i], y[i]);
+		CYBOZU_TEST_EQUAL_ARRAY(z, w, n);
+		Fr::subVec(z.data(), x.data(), y.data(), n);
+		for (size_t i = 0; i < n; i++) Fr::sub(w[i], x[i], y[i]);
+		CYBOZU_TEST_EQUAL_ARRAY(z, w, n);
+		size_t r1 = Fr::invVec(z.data(), x.data(), n);
+		size_t r2 = mcl::invVec(w.data(), x.data(), n);
+		CYBOZU_TEST_EQUAL(r1, r2);
+		CYBOZU_TEST_EQUAL_ARRAY(z, w, n);
+		// in-place
+		z = x;
+		Fr::invVec(z.data(), z.data(), n);
+		CYBOZU_TEST_EQUAL_ARRAY(z, w, n);
+	}
+}
+
+// z = x * y
+void mulNaive(Fr *z, const Fr *x, size_t xn, const Fr *y, size_t yn)
+{
+	for (size_t i = 0; i < xn + yn - 1; i++) {
+		z[i].clear();
+	}
+	for (size_t i = 0; i < xn; i++) {
+		for (size_t j = 0; j < yn; j++) {
+			z[i + j] += x[i] * y[j];
+		}
+	}
+}
+
+CYBOZU_TEST_AUTO(polynomial)
+{
+	typedef mcl::Ntt<Fr> NTT;
+	typedef mcl::Polynomial<Fr> Poly;
+	cybozu::XorShift rg;
+	const size_t N = 64;
+	NTT ntt;
+	ntt.init(N);
+	Poly poly;
+	CYBOZU_TEST_ASSERT(!poly.init(ntt, ntt.getW()));
+	CYBOZU_TEST_ASSERT(poly.init(ntt));
+	std::vector<Fr> c(N), x(N * 3), y(N);
+	for (size_t i = 0; i < N; i++) {
+		c[i].setByCSPRNG(rg);
+	}
+	// cosetNtt
+	copy(x.data(), c.data(), N);
+	poly.cosetNtt(x.data());
+	const Fr *ws = ntt.getWs();
+	for (size_t k = 0; k < N; k++) {
+		Fr v;
+		mcl::evaluatePolynomial(v, c.data(), N, poly.getG() * ws[k]);
+		CYBOZU_TEST_EQUAL(x[k], v);
+	}
+	poly.cosetIntt(x.data());
+	CYBOZU_TEST_EQUAL_ARRAY(x, c, N);
+	// batch
+	for (size_t i = 0; i < N * 3; i++) {
+		x[i].setByCSPRNG(rg);
+	}
+	std::vector<Fr> x2 = x;
+	poly.cosetNttVec(x.data(), 3);
+	for (size_t j = 0; j < 3; j++) {
+		poly.cosetNtt(&x2[N * j]);
+	}
+	CYBOZU_TEST_EQUAL_ARRAY(x, x2, N * 3);
+	poly.cosetInttVec(x.data(), 3);
+	ntt.inttVec(x2.data(), 3);
+	for (size_t j = 0; j < 3; j++) {
+		ntt.ntt(&x2[N * j]);
+		poly.cosetIntt(&x2[N * j]);
+	}
+	CYBOZU_TEST_EQUAL_ARRAY(x, x2, N * 3);
+	// evalExtended
+	const size_t cn = N / 4;
+	CYBOZU_TEST_ASSERT(poly.evalExtended(x.data(), c.data(), cn));
+	CYBOZU_TEST_ASSERT(poly.evalExtended(y.data(), c.data(), cn, false));
+	for (size_t k = 0; k < N; k++) {
+		Fr v;
+		mcl::evaluatePolynomial(v, c.data(), cn, poly.getG() * ws[k]);
+		CYBOZU_TEST_EQUAL(x[k], v);
+		mcl::evaluatePolynomial(v, c.data(), cn, ws[k]);
+		CYBOZU_TEST_EQUAL(y[k], v);
+	}
+	CYBOZU_TEST_ASSERT(!poly.evalExtended(x.data(), c.data(), N + 1));
+	// mul
+	const size_t tbl[][2] = { { 1, 1 }, { 1, 5 }, { 7, 3 }, { 32, 33 }, { 10, 55 } };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(tbl); i++) {
+		const size_t xn = tbl[i][0], yn = tbl[i][1];
+		Fr z[N], z2[N];
+		CYBOZU_TEST_ASSERT(poly.mul(z, c.data(), xn, c.data() + 3, yn));
+		mulNaive(z2, c.data(), xn, c.data() + 3, yn);
+		CYBOZU_TEST_EQUAL_ARRAY(z, z2, xn + yn - 1);
+	}
+	{
+		Fr z[N];
+		CYBOZU_TEST_ASSERT(!poly.mul(z, c.data(), 33, c.data(), 33));
+	}
+	// f = q * (X^n - 1)
+	const size_t n = 16;
+	const size_t qn = N - n;
+	std::vector<Fr> f(N), q(qn);
+	for (size_t i = 0; i < N; i++) {
+		f[i].clear();
+	}
+	for (size_t i = 0; i < qn; i++) {
+		f[i + n] += c[i];
+		f[i] -= c[i];
+	}
+	CYBOZU_TEST_ASSERT(Poly::divByVanishing(q.data(), f.data(), N, n));
+	CYBOZU_TEST_EQUAL_ARRAY(q, c, qn);
+	f[3] += 1;
+	CYBOZU_TEST_ASSERT(!Poly::divByVanishing(q.data(), f.data(), N, n));
+	f[3] -= 1;
+	// divide on the coset
+	poly.cosetNtt(f.data());
+	CYBOZU_TEST_ASSERT(poly.divByVanishingOnCoset(f.data(), n));
+	poly.cosetIntt(f.data());
+	CYBOZU_TEST_EQUAL_ARRAY(f, c, qn);
+	for (size_t i = qn; i < N; i++) {
+		CYBOZU_TEST_ASSERT(f[i].isZero());
+	}
+	CYBOZU_TEST_ASSERT(!poly.divByVanishingOnCoset(f.data(), 3));
+}
+
+CYBOZU_TEST_AUTO(polynomialFourStep)
+{
+	typedef mcl::Ntt<Fr> NTT;
+	typedef mcl::Polynomial<Fr> Poly;
+	const size_t N = size_t(1) << (NTT::directMaxBitN + 1);
+	NTT ntt;
+	ntt.init(N);
+	Poly poly;
+	CYBOZU_TEST_ASSERT(poly.init(ntt));
+	cybozu::XorShift rg;
+	std::vector<Fr> c(N * 2), x;
+	for (size_t i = 0; i < N * 2; i++) {
+		c[i].setByCSPRNG(rg);
+	}
+	x = c;
+	poly.cosetNttVec(x.data(), 2);
+	poly.cosetIntt(x.data());
+	poly.cosetIntt(x.data() + N);
+	CYBOZU_TEST_EQUAL_ARRAY(x, c, N * 2);
+	// (X - 1) * (X^(N-2) + ... + 1) = X^(N-1) - 1
+	std::vector<Fr> a(2), b(N - 1), z(N);
+	a[0] = -1;
+	a[1] = 1;
+	for (size_t i = 0; i < N - 1; i++) {
+		b[i] = 1;
+	}
+	CYBOZU_TEST_ASSERT(poly.mul(z.data(), a.data(), 2, b.data(), N - 1));
+	CYBOZU_TEST_EQUAL(z[0], -1);
+	CYBOZU_TEST_EQUAL(z[N - 1], 1);
+	for (size_t i = 1; i < N - 1; i++) {
+		CYBOZU_TEST_ASSERT(z[i].isZero());
+	}
+}
+
+CYBOZU_TEST_AUTO(nttEc)
+{
+	typedef mcl::Ntt<Fr> NTT;
+	const size_t maxBitN = 7;
+	const size_t maxN = size_t(1) << maxBitN;
+	std::vector<G1> in(maxN), out(maxN), out2(maxN);
+	hashAndMapToG1(in[0], "abc", 3);
+	for (size_t i = 1; i < maxN; i++) {
+		G1::dbl(in[i], in[i - 1]);
+	}
+	NTT ntt;
+	for (size_t bitN = 1; bitN <= maxBitN; bitN++) {
+		const size_t n = size_t(1) << bitN;
+		ntt.init(n);
+		copy(out.data(), in.data(), n);
+		ntt.nttEc(out.data());
+		copy(out2.data(), in.data(), n);
+		ntt._ntt(out2.data(), ntt.getWs(), false);
+		CYBOZU_TEST_EQUAL_ARRAY(out, out2, n);
+		for (size_t i = 0; i < n; i++) {
+			CYBOZU_TEST_ASSERT(out[i].isNormalized());
+		}
+		ntt.inttEc(out.data());
+		CYBOZU_TEST_EQUAL_ARRAY(out, in, n);
+	}
+	/*
+		[tau^i]P -> [L_i(tau)]P
+		sum_i L_i(tau) w^i = tau
+	*/
+	const size_t n = maxN;
+	ntt.init(n);
+	Fr tau;
+	tau.setByCSPRNG();
+	Fr t = 1;
+	for (size_t i = 0; i < n; i++) {
+		G1::mul(out[i], in[0], t);
+		t *= tau;
+	}
+	ntt.inttEc(out.data());
+	G1 Q;
+	G1::mulVec(Q, out.data(), ntt.getWs(), n);
+	CYBOZU_TEST_EQUAL(Q, in[0] * tau);
+}
+
+void testRoot(const char *name)
+{
+	typedef mcl::Ntt<Fr> NTT;
+	NTT ntt;
+	CYBOZU_TEST_ASSERT(ntt.initRoot());
+	const size_t maxBitN = ntt.getMaxBitN();
+	printf("%s maxBitN=%zd\n", name, maxBitN);
+	// root is a primitive 2^maxBitN-th root of unity
+	Fr t = ntt.root_;
+	for (size_t i = 1; i < maxBitN; i++) {
+		Fr::sqr(t, t);
+	}
+	CYBOZU_TEST_EQUAL(t, -1);
+	CYBOZU_TEST_ASSERT(!ntt.init((size_t(1) << maxBitN) * 2));
+	const size_t testBitN = maxBitN < 10 ? maxBitN : 10;
+	const size_t maxN = size_t(1) << testBitN;
+	std::vector<Fr> in(maxN), out(maxN), out2(maxN);
+	cybozu::XorShift rg;
+	for (size_t i = 0; i < maxN; i++) {
+		in[i].setByCSPRNG(rg);
+	}
+	for (size_t bitN = 1; bitN <= testBitN; bitN++) {
+		const size_t n = size_t(1) << bitN;
+		CYBOZU_TEST_ASSERT(ntt.init(n));
+		copy(out.data(), in.data(), n);
+		ntt.ntt(out.data());
+		if (n <= 64) {
+			nttNaive(out2.data(), in.data(), n, ntt.getWs());
+		} else {
+			copy(out2.data(), in.data(), n);
+			ntt._ntt(out2.data(), ntt.getWs(), false);
+		}
+		CYBOZU_TEST_EQUAL_ARRAY(out, out2, n);
+		ntt.intt(out.data());
+		CYBOZU_TEST_EQUAL_ARRAY(out, in, n);
+	}
+}
+
+CYBOZU_TEST_AUTO(otherCurves)
+{
+	initPairing(mcl::BN254);
+	testRoot("BN254");
+	initPairing(mcl::BN_SNARK1);
+	testRoot("BN_SNARK1");
+	initPairing(mcl::BLS12_377);
+	testRoot("BLS12_377");
+	Fr::init(mcl::ecparam::secp256k1.n);
+	testRoot("secp256k1");
+	initPairing(mcl::BLS12_381);
+	testRoot("BLS12_381");
+}
@@ -94,6 +94,106 @@ CYBOZU_TEST_AUTO(encDec)
 	}
 }
 
+CYBOZU_TEST_AUTO(decVec)
+{
+	sheSecretKey sec;
+	sheSecretKeySetByCSPRNG(&sec);
+	shePublicKey pub;
+	sheGetPublicKey(&pub, &sec);
+
+	const size_t N = 30;
+	sheCipherTextG1 c1[N];
+	sheCipherTextG2 c2[N];
+	sheCipherTextGT ct[N];
+	mclInt m[N];
+	for (size_t i = 0; i < N; i++) {
+		m[i] = mclInt(i * 12345) - 100000; // use giant steps
+		sheEncG1(&c1[i], &pub, m[i]);
+		sheEncG2(&c2[i], &pub, m[i]);
+		sheEncGT(&ct[i], &pub, m[i]);
+	}
+	mclInt dec[N] = {};
+	CYBOZU_TEST_EQUAL(sheDecG1Vec(dec, &sec, c1, N), 0);
+	CYBOZU_TEST_EQUAL_ARRAY(dec, m, N);
+	CYBOZU_TEST_EQUAL(sheDecG2Vec(dec, &sec, c2, N), 0);
+	CYBOZU_TEST_EQUAL_ARRAY(dec, m, N);
+	CYBOZU_TEST_EQUAL(sheDecGTVec(dec, &sec, ct, N), 0);
+	CYBOZU_TEST_EQUAL_ARRAY(dec, m, N);
+	CYBOZU_TEST_EQUAL(sheDecG1Vec(dec, &sec, c1, 0), 0);
+}
+
+CYBOZU_TEST_AUTO(encVec)
+{
+	sheSecretKey sec;
+	sheSecretKeySetByCSPRNG(&sec);
+	shePublicKey pub;
+	sheGetPublicKey(&pub, &sec);
+	shePrecomputedPublicKey *ppub = shePrecomputedPublicKeyCreate();
+	CYBOZU_TEST_EQUAL(shePrecomputedPublicKeyInit(ppub, &pub), 0);
+
+	const size_t N = 20;
+	sheCipherTextG1 c1[N];
+	sheCipherTextG2 c2[N];
+	sheCipherTextGT ct[N];
+	mclInt m[N];
+	for (size_t i = 0; i < N; i++) {
+		m[i] = mclInt(i * 37) - 300;
+	}
+	mclInt dec[N] = {};
+	CYBOZU_TEST_EQUAL(sheEncG1Vec(c1, &pub, m, N), 0);
+	CYBOZU_TEST_EQUAL(sheDecG1Vec(dec, &sec, c1, N), 0);
+	CYBOZU_TEST_EQUAL_ARRAY(dec, m, N);
+	CYBOZU_TEST_EQUAL(sheEncG2Vec(c2, &pub, m, N), 0);
+	CYBOZU_TEST_EQUAL(sheDecG2Vec(dec, &sec, c2, N), 0);
+	CYBOZU_TEST_EQUAL_ARRAY(dec, m, N);
+	CYBOZU_TEST_EQUAL(sheEncGTVec(ct, &pub, m, N), 0);
+	CYBOZU_TEST_EQUAL(sheDecGTVec(dec, &sec, ct, N), 0);
+	CYBOZU_TEST_EQUAL_ARRAY(dec, m, N);
+	CYBOZU_TEST_EQUAL(shePrecomputedPublicKeyEncG1Vec(c1, ppub, m, N), 0);
+	CYBOZU_TEST_EQUAL(sheDecG1Vec(dec, &sec, c1, N), 0);
+	CYBOZU_TEST_EQUAL_ARRAY(dec, m, N);
+	CYBOZU_TEST_EQUAL(shePrecomputedPublicKeyEncG2Vec(c2, ppub, m, N), 0);
+	CYBOZU_TEST_EQUAL(sheDecG2Vec(dec, &sec, c2, N), 0);
+	CYBOZU_TEST_EQUAL_ARRAY(dec, m, N);
+	CYBOZU_TEST_EQUAL(shePrecomputedPublicKeyEncGTVec(ct, ppub, m, N), 0);
+	CYBOZU_TEST_EQUAL(sheDecGTVec(dec, &sec, ct, N), 0);
+	CYBOZU_TEST_EQUAL_ARRAY(dec, m, N);
+	CYBOZU_TEST_EQUAL(sheEncG1Vec(c1, &pub, m, 0), 0);
+	shePrecomputedPublicKeyDestroy(ppub);
+}
+
+CYBOZU_TEST_AUTO(mulVec)
+{
+	sheSecretKey sec;
+	sheSecretKeySetByCSPRNG(&sec);
+	shePublicKey pub;
+	sheGetPublicKey(&pub, &sec);
+
+	const size_t N = 10;
+	sheCipherTextG1 c1[N];
+	sheCipherTextG2 c2[N];
+	mclInt m1[N], m2[N];
+	mclInt ip = 0;
+	for (size_t i = 0; i < N; i++) {
+		m1[i] = mclInt(i) - 3;
+		m2[i] = mclInt(i * 2) + 1;
+		ip += m1[i] * m2[i];
+	}
+	CYBOZU_TEST_EQUAL(sheEncG1Vec(c1, &pub, m1, N), 0);
+	CYBOZU_TEST_EQUAL(sheEncG2Vec(c2, &pub, m2, N), 0);
+	sheCipherTextGT ct;
+	mclInt dec;
+	CYBOZU_TEST_EQUAL(sheMulVec(&ct, c1, c2, N), 0);
+	CYBOZU_TEST_EQUAL(sheDecGT(&dec, &sec, &ct), 0);
+	CYBOZU_TEST_EQUAL(dec, ip);
+	CYBOZU_TEST_EQUAL(sheMulVecMT(&ct, c1, c2, N, 0), 0);
+	CYBOZU_TEST_EQUAL(sheDecGT(&dec, &sec, &ct), 0);
+	CYBOZU_TEST_EQUAL(dec, ip);
+	CYBOZU_TEST_EQUAL(sheMulVec(&ct, c1, c2, 0), 0);
+	CYBOZU_TEST_EQUAL(sheDecGT(&dec, &sec, &ct), 0);
+	CYBOZU_TEST_EQUAL(dec, 0);
+}
+
 CYBOZU_TEST_AUTO(addMul)
 {
 	sheSecretKey sec;
@@ -647,7 +747,7 @@ CYBOZU_TEST_AUTO(saveLoad)
 	shePublicKey pub;
 	sheGetPublicKey(&pub, &sec);
 	const size_t hashSize = 1 << g_hashBitSize;
-	const size_t byteSizePerEntry = 8;
+	const size_t byteSizePerEntry = 11; // 64-byte bucket per 6 entries
 	sheSetRangeForGTDLP(hashSize);
 	std::string buf;
 	buf.resize(hashSize * byteSizePerEntry + 1024);
@@ -677,6 +777,35 @@ CYBOZU_TEST_AUTO(saveLoad)
 	CYBOZU_TEST_EQUAL(dec, m);
 }
 
+CYBOZU_TEST_AUTO(mapTable)
+{
+	sheSecretKey sec;
+	sheSecretKeySetByCSPRNG(&sec);
+	shePublicKey pub;
+	sheGetPublicKey(&pub, &sec);
+	const char *name = "she_c_table_gt.bin";
+	const size_t hashSize = 1000;
+	sheSetRangeForGTDLP(hashSize);
+	CYBOZU_TEST_EQUAL(sheSaveTableFileForGTDLP(name), 0);
+	const int64_t m = hashSize - 1;
+	sheCipherTextGT ct;
+	CYBOZU_TEST_EQUAL(sheEncGT(&ct, &pub, m), 0);
+	sheSetRangeForGTDLP(1);
+	sheSetTryNum(1);
+	int64_t dec = 0;
+	CYBOZU_TEST_ASSERT(sheDecGT(&dec, &sec, &ct) != 0);
+	CYBOZU_TEST_EQUAL(sheMapTableForGTDLP(name), 0);
+	CYBOZU_TEST_EQUAL(sheGetTableSizeForGTDLP(), hashSize);
+	CYBOZU_TEST_EQUAL(sheDecGT(&dec, &sec, &ct), 0);
+	CYBOZU_TEST_EQUAL(dec, m);
+	// the group does not match
+	CYBOZU_TEST_ASSERT(sheMapTableForG1DLP(name) != 0);
+	CYBOZU_TEST_ASSERT(sheMapTableForG2DLP("not-exist-she-table-file") != 0);
+	sheSetRangeForDLP(hashSize);
+	sheSetTryNum(tryNum);
+	remove(name);
+}
+
 int main(int argc, char *argv[])
 	try
 {
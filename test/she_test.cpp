@@ -2,6 +2,7 @@
 #include <cybozu/test.hpp>
 #include <cybozu/benchmark.hpp>
 #include <cybozu/xorshift.hpp>
+#include <cybozu/file.hpp>
 #include <fstream>
 #include <time.h>
 #include <mcl/she.hpp>
@@ -219,6 +220,29 @@ void HashTableTest(const G& P)
 	hashTbl2.load(ss);
 	hashTbl2.setTryNum(tryNum);
 	GAHashTableTest(maxSize, tryNum, P, hashTbl2);
+	// a broken stream does not change the table
+	const std::string s = ss.str();
+	mcl::she::local::HashTable<G> hashTbl3(hashTbl2);
+	{
+		std::stringstream ss2(s.substr(0, s.size() / 2));
+		CYBOZU_TEST_EXCEPTION(hashTbl2.load(ss2), std::exception);
+		CYBOZU_TEST_ASSERT(hashTbl2 == hashTbl3);
+	}
+	{
+		// too large hashSize with the consistent bucketNum
+		const size_t hashSize = 0x7fffffff;
+		std::stringstream ss2;
+		cybozu::save(ss2, mcl::she::getCurveParam().curveType);
+		cybozu::writeChar(ss2, 'V');
+		cybozu::writeChar(ss2, char(3));
+		cybozu::writeChar(ss2, mcl::she::local::GtoChar<G>());
+		cybozu::save(ss2, hashSize);
+		const size_t bucketNum = (hashSize + 5) / 6; // the load factor is 3/4 of KeyCountBucket::N
+		cybozu::save(ss2, bucketNum);
+		CYBOZU_TEST_EXCEPTION(hashTbl2.load(ss2), std::exception);
+		CYBOZU_TEST_ASSERT(hashTbl2 == hashTbl3);
+	}
+	GAHashTableTest(maxSize, tryNum, P, hashTbl2);
 }
 
 CYBOZU_TEST_AUTO(HashTable)
@@ -231,6 +255,69 @@ CYBOZU_TEST_AUTO(HashTable)
 	HashTableTest(Q);
 }
 
+/*
+	write a table in the old format (sorted vector of 32-bit hash and count)
+*/
+template<class G, bool isEC>
+void saveOldHashTable(std::ostream& os, const G& P, int hashSize)
+{
+	typedef mcl::she::local::InterfaceForHashTable<G, isEC> I;
+	std::vector<mcl::she::local::KeyCount> kcv(hashSize);
+	G xP;
+	I::clear(xP);
+	for (int i = 1; i <= hashSize; i++) {
+		I::add(xP, xP, P);
+		I::normalize(xP);
+		kcv[i - 1].key = I::getHash(xP);
+		kcv[i - 1].count = i;
+	}
+	std::stable_sort(kcv.begin(), kcv.end());
+	cybozu::save(os, mcl::she::getCurveParam().curveType);
+	cybozu::writeChar(os, mcl::she::local::GtoChar<G>());
+	cybozu::save(os, kcv.size());
+	cybozu::write(os, &kcv[0], sizeof(kcv[0]) * kcv.size());
+	P.save(os);
+}
+
+template<class G, bool isEC>
+void oldHashTableTest(const G& P)
+{
+	typedef mcl::she::local::HashTable<G, isEC> HashTbl;
+	const int maxSize = 100;
+	const int tryNum = 5;
+	HashTbl hashTbl, hashTbl2, hashTbl3;
+	hashTbl.init(P, maxSize, tryNum);
+	std::stringstream ss;
+	saveOldHashTable<G, isEC>(ss, P, maxSize);
+	const std::string old = ss.str();
+	hashTbl2.load(ss);
+	hashTbl2.setTryNum(tryNum);
+	CYBOZU_TEST_EQUAL(hashTbl2.getTableSize(), hashTbl.getTableSize());
+	CYBOZU_TEST_ASSERT(hashTbl != hashTbl2);
+	for (int i = -maxSize * tryNum; i <= maxSize * tryNum; i++) {
+		G xP;
+		mcl::she::local::InterfaceForHashTable<G, isEC>::mul(xP, P, i);
+		CYBOZU_TEST_EQUAL(hashTbl.log(xP), i);
+		CYBOZU_TEST_EQUAL(hashTbl2.log(xP), i);
+	}
+	// a table loaded from the old format is saved in the old format
+	std::stringstream ss2;
+	hashTbl2.save(ss2);
+	CYBOZU_TEST_EQUAL(ss2.str(), old);
+	hashTbl3.load(ss2);
+	CYBOZU_TEST_ASSERT(hashTbl2 == hashTbl3);
+	// not found
+	{
+		G xP;
+		mcl::she::local::InterfaceForHashTable<G, isEC>::mul(xP, P, maxSize * 2 + 1);
+		bool b;
+		hashTbl.basicLog(xP, &b);
+		CYBOZU_TEST_ASSERT(!b);
+		hashTbl2.basicLog(xP, &b);
+		CYBOZU_TEST_ASSERT(!b);
+	}
+}
+
 template<class HashTbl>
 void GTHashTableTest(int maxSize, int tryNum, const GT& g, const HashTbl& hashTbl)
 {
@@ -268,6 +355,221 @@ CYBOZU_TEST_AUTO(GTHashTable)
 	GTHashTableTest(maxSize, tryNum, g, hashTbl2);
 }
 
+CYBOZU_TEST_AUTO(oldHashTable)
+{
+	G1 P;
+	hashAndMapToG1(P, "abc");
+	G2 Q;
+	hashAndMapToG2(Q, "abc");
+	GT g;
+	pairing(g, P, Q);
+	oldHashTableTest<G1, true>(P);
+	oldHashTableTest<G2, true>(Q);
+	oldHashTableTest<GT, false>(g);
+}
+
+struct Progress {
+	size_t callN;
+	size_t done;
+	size_t total;
+	static void call(void *arg, size_t done, size_t total)
+	{
+		Progress *self = (Progress*)arg;
+		self->callN++;
+		CYBOZU_TEST_ASSERT(done > self->done);
+		self->done = done;
+		self->total = total;
+	}
+};
+
+template<class G, bool isEC>
+void initHashTableTest(const G& P)
+{
+	typedef mcl::she::local::HashTable<G, isEC> HashTbl;
+	const int hashSize = 3000;
+	HashTbl hashTbl1, hashTbl2, hashTbl3;
+	Progress progress = {};
+	hashTbl1.setProgressFunc(Progress::call, &progress);
+	hashTbl1.init(P, hashSize, 1, 1);
+	const size_t blockSize = mcl::she::local::initBlockSize;
+	CYBOZU_TEST_EQUAL(progress.callN, (hashSize + blockSize - 1) / blockSize);
+	CYBOZU_TEST_EQUAL(progress.done, size_t(hashSize));
+	CYBOZU_TEST_EQUAL(progress.total, size_t(hashSize));
+	// the table does not depend on the num of threads
+	hashTbl2.init(P, hashSize, 1, 3);
+	CYBOZU_TEST_ASSERT(hashTbl1 == hashTbl2);
+	hashTbl3.init(P, hashSize);
+	CYBOZU_TEST_ASSERT(hashTbl1 == hashTbl3);
+	G xP;
+	mcl::she::local::InterfaceForHashTable<G, isEC>::clear(xP);
+	for (int i = 0; i <= hashSize; i++) {
+		CYBOZU_TEST_EQUAL(hashTbl2.basicLog(xP), i);
+		mcl::she::local::InterfaceForHashTable<G, isEC>::add(xP, xP, P);
+	}
+}
+
+CYBOZU_TEST_AUTO(initHashTable)
+{
+	G1 P;
+	hashAndMapToG1(P, "abc");
+	G2 Q;
+	hashAndMapToG2(Q, "abc");
+	GT g;
+	pairing(g, P, Q);
+	initHashTableTest<G1, true>(P);
+	initHashTableTest<G2, true>(Q);
+	initHashTableTest<GT, false>(g);
+	// small tables where the two buckets of an entry often overlap
+	for (int hashSize = 1; hashSize <= 64; hashSize++) {
+		mcl::she::local::HashTable<G1> hashTbl;
+		hashTbl.init(P, hashSize);
+		G1 xP;
+		xP.clear();
+		for (int i = 0; i <= hashSize; i++) {
+			CYBOZU_TEST_EQUAL(hashTbl.basicLog(xP), i);
+			G1::add(xP, xP, P);
+		}
+		bool b;
+		hashTbl.basicLog(xP, &b);
+		CYBOZU_TEST_ASSERT(!b);
+	}
+}
+
+template<class G, bool isEC>
+void mapHashTableTest(const G& P, const char *name)
+{
+	typedef mcl::she::local::HashTable<G, isEC> HashTbl;
+	// the buckets are aligned to a cache line in the mapped area
+	CYBOZU_TEST_EQUAL(sizeof(mcl::she::local::HashTableFileHeader), 64u);
+	CYBOZU_TEST_EQUAL(sizeof(mcl::she::local::KeyCountBucket), 64u);
+	const int maxSize = 300;
+	const int tryNum = 3;
+	HashTbl hashTbl1, hashTbl2;
+	hashTbl1.init(P, maxSize, tryNum);
+	hashTbl1.saveMapFile(name);
+	hashTbl2.mapFile(name, P);
+	CYBOZU_TEST_ASSERT(hashTbl2.isMapped());
+	CYBOZU_TEST_ASSERT(hashTbl1 == hashTbl2);
+	hashTbl2.setTryNum(tryNum);
+	for (int i = -maxSize * tryNum; i <= maxSize * tryNum; i += 7) {
+		G xP;
+		mcl::she::local::InterfaceForHashTable<G, isEC>::mul(xP, P, i);
+		CYBOZU_TEST_EQUAL(hashTbl2.log(xP), i);
+	}
+	{
+		std::stringstream ss1, ss2;
+		hashTbl1.save(ss1);
+		hashTbl2.save(ss2);
+		CYBOZU_TEST_EQUAL(ss1.str(), ss2.str());
+	}
+	// a copy of a mapped table has its own buckets
+	{
+		HashTbl hashTbl3;
+		{
+			HashTbl tmp;
+			tmp.mapFile(name, P);
+			tmp.setTryNum(tryNum);
+			HashTbl hashTbl4(tmp);
+			CYBOZU_TEST_ASSERT(!hashTbl4.isMapped());
+			CYBOZU_TEST_ASSERT(hashTbl4 == hashTbl1);
+			hashTbl3 = tmp;
+		}
+		CYBOZU_TEST_ASSERT(!hashTbl3.isMapped());
+		CYBOZU_TEST_ASSERT(hashTbl3 == hashTbl1);
+		for (int i = -maxSize * tryNum; i <= maxSize * tryNum; i += 7) {
+			G xP;
+			mcl::she::local::InterfaceForHashTable<G, isEC>::mul(xP, P, i);
+			CYBOZU_TEST_EQUAL(hashTbl3.log(xP), i);
+		}
+	}
+	// P does not match
+	G P2;
+	mcl::she::local::InterfaceForHashTable<G, isEC>::dbl(P2, P);
+	CYBOZU_TEST_EXCEPTION(hashTbl2.mapFile(name, P2), cybozu::Exception);
+	// the table is not changed
+	CYBOZU_TEST_ASSERT(hashTbl2.isMapped());
+	CYBOZU_TEST_ASSERT(hashTbl1 == hashTbl2);
+	// init after mapFile
+	hashTbl2.mapFile(name, P);
+	hashTbl2.init(P, maxSize, tryNum);
+	CYBOZU_TEST_ASSERT(!hashTbl2.isMapped());
+	CYBOZU_TEST_ASSERT(hashTbl1 == hashTbl2);
+	{
+		// bad version
+		FILE *fp = fopen(name, "r+b");
+		CYBOZU_TEST_ASSERT(fp);
+		fseek(fp, offsetof(mcl::she::local::HashTableFileHeader, version), SEEK_SET);
+		fputc(2, fp);
+		fclose(fp);
+	}
+	CYBOZU_TEST_EXCEPTION(hashTbl2.mapFile(name, P), cybozu::Exception);
+	hashTbl1.saveMapFile(name);
+	{
+		// broken size
+		FILE *fp = fopen(name, "ab");
+		CYBOZU_TEST_ASSERT(fp);
+		fputc(1, fp);
+		fclose(fp);
+	}
+	CYBOZU_TEST_EXCEPTION(hashTbl2.mapFile(name, P), cybozu::Exception);
+	CYBOZU_TEST_EXCEPTION(hashTbl2.mapFile("not-exist-she-table-file", P), cybozu::Exception);
+	CYBOZU_TEST_ASSERT(hashTbl1 == hashTbl2);
+	cybozu::RemoveFile(name);
+}
+
+CYBOZU_TEST_AUTO(mapHashTable)
+{
+	G1 P;
+	hashAndMapToG1(P, "abc");
+	G2 Q;
+	hashAndMapToG2(Q, "abc");
+	GT g;
+	pairing(g, P, Q);
+	mapHashTableTest<G1, true>(P, "she_table_g1.bin");
+	mapHashTableTest<G2, true>(Q, "she_table_g2.bin");
+	mapHashTableTest<GT, false>(g, "she_table_gt.bin");
+	// a table of the old format can't be mapped
+	{
+		mcl::she::local::HashTable<G1> hashTbl;
+		std::stringstream ss;
+		saveOldHashTable<G1, true>(ss, P, 10);
+		hashTbl.load(ss);
+		// the file is not changed
+		const char *oldName = "she_table_old.bin";
+		{
+			std::ofstream ofs(oldName, std::ios::binary);
+			ofs << "abc";
+		}
+		CYBOZU_TEST_EXCEPTION(hashTbl.saveMapFile(oldName), cybozu::Exception);
+		{
+			std::ifstream ifs(oldName, std::ios::binary);
+			std::string s;
+			ifs >> s;
+			CYBOZU_TEST_EQUAL(s, "abc");
+		}
+		cybozu::RemoveFile(oldName);
+	}
+	// SHE
+	const char *name = "she_table_gt.bin";
+	const SecretKey& sec = g_sec;
+	PublicKey pub;
+	sec.getPublicKey(pub);
+	const int hashSize = 200;
+	setRangeForGTDLP(hashSize);
+	getHashTableGT().saveMapFile(name);
+	setRangeForGTDLP(1);
+	CipherTextGT c;
+	pub.enc(c, hashSize - 1);
+	bool b;
+	sec.dec(c, &b);
+	CYBOZU_TEST_ASSERT(!b);
+	mapTableForGTDLP(name);
+	CYBOZU_TEST_EQUAL(sec.dec(c), hashSize - 1);
+	CYBOZU_TEST_EXCEPTION(mapTableForG1DLP(name), cybozu::Exception);
+	setRangeForDLP(1024);
+	cybozu::RemoveFile(name);
+}
+
 CYBOZU_TEST_AUTO(enc_dec)
 {
 	SecretKey& sec = g_sec;
@@ -312,6 +614,211 @@ CYBOZU_TEST_AUTO(enc_dec)
 	}
 }
 
+template<class CT>
+void decLoop(int64_t *m, const SecretKey& sec, const CT *c, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		m[i] = sec.dec(c[i]);
+	}
+}
+
+template<class CT>
+void decVecTest(const SecretKey& sec, const CT *c, const int64_t *m, size_t n, bool allInRange)
+{
+	std::vector<int64_t> dec(n);
+	bool ok;
+	sec.decVec(&dec[0], c, n, &ok);
+	CYBOZU_TEST_EQUAL(ok, allInRange);
+	for (size_t i = 0; i < n; i++) {
+		bool b;
+		int64_t d = sec.dec(c[i], &b);
+		if (b) {
+			CYBOZU_TEST_EQUAL(dec[i], m[i]);
+			CYBOZU_TEST_EQUAL(d, m[i]);
+		} else {
+			CYBOZU_TEST_EQUAL(dec[i], 0);
+		}
+	}
+	if (!allInRange) {
+		CYBOZU_TEST_EXCEPTION(sec.decVec(&dec[0], c, n), cybozu::Exception);
+	}
+}
+
+CYBOZU_TEST_AUTO(decVec)
+{
+	const SecretKey& sec = g_sec;
+	PublicKey pub;
+	sec.getPublicKey(pub);
+	const int hashSize = 64;
+	const int tryNum = 4;
+	// |m| <= hashSize * (tryNum * 2 - 1)
+	const int maxM = hashSize * (tryNum * 2 - 1);
+	setRangeForDLP(hashSize);
+	setTryNum(tryNum);
+	cybozu::XorShift rg;
+	const size_t N = 40;
+	int64_t m[N];
+	CipherTextG1 c1[N];
+	CipherTextG2 c2[N];
+	CipherTextGT ct[N];
+	for (size_t i = 0; i < N; i++) {
+		m[i] = int64_t(rg.get32() % (maxM * 2 + 1)) - maxM;
+	}
+	m[0] = 0;
+	m[1] = maxM;
+	m[2] = -maxM;
+	for (size_t i = 0; i < N; i++) {
+		pub.enc(c1[i], m[i]);
+		pub.enc(c2[i], m[i]);
+		pub.enc(ct[i], m[i]);
+	}
+	for (size_t n = 0; n <= N; n += 13) {
+		decVecTest(sec, c1, m, n, true);
+		decVecTest(sec, c2, m, n, true);
+		decVecTest(sec, ct, m, n, true);
+	}
+	useDecG1ViaGT(true);
+	useDecG2ViaGT(true);
+	decVecTest(sec, c1, m, N, true);
+	decVecTest(sec, c2, m, N, true);
+	useDecG1ViaGT(false);
+	useDecG2ViaGT(false);
+	// out of range
+	m[3] = maxM + 1;
+	m[7] = -maxM - 100;
+	pub.enc(c1[3], m[3]);
+	pub.enc(c2[3], m[3]);
+	pub.enc(ct[3], m[3]);
+	pub.enc(c1[7], m[7]);
+	pub.enc(c2[7], m[7]);
+	pub.enc(ct[7], m[7]);
+	decVecTest(sec, c1, m, N, false);
+	decVecTest(sec, c2, m, N, false);
+	decVecTest(sec, ct, m, N, false);
+#ifdef NDEBUG
+	{
+		setRangeForG1DLP(1 << 16);
+		setTryNum(16);
+		const size_t n = 1024;
+		std::vector<CipherTextG1> cv(n);
+		std::vector<int64_t> mv(n), dv(n);
+		for (size_t i = 0; i < n; i++) {
+			mv[i] = int64_t(rg.get32() % (1 << 21)) - (1 << 20);
+			pub.enc(cv[i], mv[i]);
+		}
+		CYBOZU_BENCH_C("dec G1 x1024", 1, decLoop, &dv[0], sec, &cv[0], n);
+		CYBOZU_TEST_ASSERT(dv == mv);
+		CYBOZU_BENCH_C("decVec G1 x1024", 1, sec.decVec, &dv[0], &cv[0], n, 0);
+		CYBOZU_TEST_ASSERT(dv == mv);
+	}
+#endif
+	setRangeForDLP(1024);
+	setTryNum(1);
+}
+
+template<class PK, class CT>
+void encLoop(const PK& pub, CT *c, const int64_t *m, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		pub.enc(c[i], m[i]);
+	}
+}
+
+template<class G>
+bool isNormalized(const G& P)
+{
+	return P.isZero() || P.z.isOne();
+}
+
+template<class PK, class CT>
+void encVecTest(const SecretKey& sec, const PK& pub, CT *c, const int64_t *m, size_t n)
+{
+	pub.encVec(c, m, n);
+	for (size_t i = 0; i < n; i++) {
+		CT d;
+		pub.enc(d, m[i]);
+		CT::sub(d, d, c[i]);
+		CYBOZU_TEST_ASSERT(sec.isZero(d));
+		if (i > 0) CYBOZU_TEST_ASSERT(c[i] != c[i - 1]);
+	}
+}
+
+template<class PK>
+void encVecTestG(const SecretKey& sec, const PK& pub, const int64_t *m, size_t n)
+{
+	std::vector<CipherTextG1> c1(n);
+	std::vector<CipherTextG2> c2(n);
+	std::vector<CipherTextGT> ct(n);
+	encVecTest(sec, pub, &c1[0], m, n);
+	encVecTest(sec, pub, &c2[0], m, n);
+	encVecTest(sec, pub, &ct[0], m, n);
+	for (size_t i = 0; i < n; i++) {
+		CYBOZU_TEST_ASSERT(isNormalized(c1[i].getS()));
+		CYBOZU_TEST_ASSERT(isNormalized(c1[i].getT()));
+		CYBOZU_TEST_ASSERT(isNormalized(c2[i].getS()));
+		CYBOZU_TEST_ASSERT(isNormalized(c2[i].getT()));
+		CYBOZU_TEST_EQUAL(sec.dec(c1[i]), m[i]);
+		CYBOZU_TEST_EQUAL(sec.dec(c2[i]), m[i]);
+		CYBOZU_TEST_EQUAL(sec.dec(ct[i]), m[i]);
+	}
+}
+
+CYBOZU_TEST_AUTO(encVec)
+{
+	const SecretKey& sec = g_sec;
+	PublicKey pub;
+	sec.getPublicKey(pub);
+	PrecomputedPublicKey ppub;
+	ppub.init(pub);
+	cybozu::XorShift rg;
+	const size_t N = 300;
+	std::vector<int64_t> m(N);
+	for (size_t i = 0; i < N; i++) {
+		m[i] = int64_t(rg.get32() % 2001) - 1000;
+	}
+	m[0] = 0;
+	m[1] = 1;
+	m[2] = -1;
+	m[3] = m[4] = 5;
+	const size_t tbl[] = { 1, 2, 17, 40 };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(tbl); i++) {
+		encVecTestG(sec, pub, &m[0], tbl[i]);
+		encVecTestG(sec, ppub, &m[0], tbl[i]);
+	}
+	// over the block size of the shared inversion
+	std::vector<CipherTextG1> c1(N);
+	ppub.encVec(&c1[0], &m[0], N);
+	for (size_t i = 0; i < N; i++) {
+		CYBOZU_TEST_EQUAL(sec.dec(c1[i]), m[i]);
+	}
+	// large m
+	const int64_t largeTbl[] = { int64_t(1) << 40, -(int64_t(1) << 50), 0x7fffffffffffffffll, -0x7fffffffffffffffll - 1 };
+	const size_t largeN = CYBOZU_NUM_OF_ARRAY(largeTbl);
+	encVecTest(sec, pub, &c1[0], largeTbl, largeN);
+	encVecTest(sec, ppub, &c1[0], largeTbl, largeN);
+	CipherTextGT ct[largeN];
+	encVecTest(sec, pub, ct, largeTbl, largeN);
+	encVecTest(sec, ppub, ct, largeTbl, largeN);
+#ifdef NDEBUG
+	{
+		const size_t n = 256;
+		std::vector<CipherTextG1> cv(n);
+		std::vector<CipherTextG2> cv2(n);
+		std::vector<CipherTextGT> cvt(n);
+		CYBOZU_BENCH_C("pub enc G1 x256", 10, encLoop, pub, &cv[0], &m[0], n);
+		CYBOZU_BENCH_C("pub encVec G1 x256", 10, pub.encVec, &cv[0], &m[0], n);
+		CYBOZU_BENCH_C("ppub enc G1 x256", 10, encLoop, ppub, &cv[0], &m[0], n);
+		CYBOZU_BENCH_C("ppub encVec G1 x256", 10, ppub.encVec, &cv[0], &m[0], n);
+		CYBOZU_BENCH_C("ppub enc G2 x256", 10, encLoop, ppub, &cv2[0], &m[0], n);
+		CYBOZU_BENCH_C("ppub encVec G2 x256", 10, ppub.encVec, &cv2[0], &m[0], n);
+		CYBOZU_BENCH_C("pub enc GT x256", 1, encLoop, pub, &cvt[0], &m[0], n);
+		CYBOZU_BENCH_C("pub encVec GT x256", 1, pub.encVec, &cvt[0], &m[0], n);
+		CYBOZU_BENCH_C("ppub enc GT x256", 1, encLoop, ppub, &cvt[0], &m[0], n);
+		CYBOZU_BENCH_C("ppub encVec GT x256", 1, ppub.encVec, &cvt[0], &m[0], n);
+	}
+#endif
+}
+
 void normalizeCipher1(const CipherTextG1 *c1, size_t n)
 {
 	G1 cc;
@@ -666,6 +1173,190 @@ CYBOZU_TEST_AUTO(innerProduct)
 	CYBOZU_TEST_EQUAL(innerProduct, sec.dec(c));
 }
 
+template<class CT>
+void sumLoop(CT& z, const CT *c, size_t n)
+{
+	z.clear();
+	for (size_t i = 0; i < n; i++) {
+		z.add(c[i]);
+	}
+}
+
+template<class CT>
+void mulIntLoop(CT& z, const CT *c, const int64_t *w, size_t n)
+{
+	z.clear();
+	for (size_t i = 0; i < n; i++) {
+		CT t;
+		CT::mul(t, c[i], w[i]);
+		z.add(t);
+	}
+}
+
+// check dec(c) == m without DLP
+template<class CT>
+void checkDec(const SecretKey& sec, const PublicKey& pub, const CT& c, int64_t m)
+{
+	CT d;
+	pub.enc(d, m);
+	CT::sub(d, d, c);
+	CYBOZU_TEST_ASSERT(sec.isZero(d));
+}
+
+template<class CT>
+void sumVecTest(const SecretKey& sec, const PublicKey& pub, const int64_t *m, const int64_t *w, size_t n)
+{
+	std::vector<CT> c(n);
+	int64_t sum = 0;
+	int64_t ip = 0;
+	for (size_t i = 0; i < n; i++) {
+		pub.enc(c[i], m[i]);
+		sum += m[i];
+		ip += m[i] * w[i];
+	}
+	// the same point and the negative point
+	if (n > 4) {
+		c[1] = c[0];
+		CT::neg(c[3], c[2]);
+		sum += m[0] - m[1] - m[2] - m[3];
+		ip += m[0] * w[1] - m[1] * w[1] - m[2] * w[3] - m[3] * w[3];
+	}
+	if (n > 6) {
+		c[5].clear();
+		sum -= m[5];
+		ip -= m[5] * w[5];
+	}
+	CT z;
+	CT::sumVec(z, c.data(), n);
+	checkDec(sec, pub, z, sum);
+	CT::sumVecMT(z, c.data(), n);
+	checkDec(sec, pub, z, sum);
+	CT::sumVecMT(z, c.data(), n, 3);
+	checkDec(sec, pub, z, sum);
+	CT::innerProduct(z, c.data(), w, n);
+	checkDec(sec, pub, z, ip);
+	// large weights use mulVec
+	const int64_t L = 1000003;
+	std::vector<int64_t> wL(n);
+	std::vector<Fr> wF(n);
+	for (size_t i = 0; i < n; i++) {
+		wL[i] = w[i] * L;
+		wF[i] = w[i];
+	}
+	CT::innerProduct(z, c.data(), wL.data(), n);
+	checkDec(sec, pub, z, ip * L);
+	CT::innerProduct(z, c.data(), wF.data(), n);
+	checkDec(sec, pub, z, ip);
+}
+
+CYBOZU_TEST_AUTO(sumVec)
+{
+	const SecretKey& sec = g_sec;
+	PublicKey pub;
+	sec.getPublicKey(pub);
+	cybozu::XorShift rg;
+	const size_t N = 1500;
+	std::vector<int64_t> m(N), w(N);
+	for (size_t i = 0; i < N; i++) {
+		m[i] = int64_t(rg.get32() % 2001) - 1000;
+		w[i] = int64_t(rg.get32() % 2001) - 1000;
+	}
+	const size_t tbl[] = { 0, 1, 2, 7, 33 };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(tbl); i++) {
+		const size_t n = tbl[i];
+		sumVecTest<CipherTextG1>(sec, pub, m.data(), w.data(), n);
+		sumVecTest<CipherTextG2>(sec, pub, m.data(), w.data(), n);
+		sumVecTest<CipherTextGT>(sec, pub, m.data(), w.data(), n);
+	}
+	// over the block size of sumVec
+	sumVecTest<CipherTextG1>(sec, pub, m.data(), w.data(), N);
+#ifdef NDEBUG
+	{
+		const size_t n = 1024;
+		std::vector<CipherTextG1> c1(n);
+		std::vector<CipherTextGT> ct(n);
+		pub.encVec(c1.data(), m.data(), n);
+		for (size_t i = 0; i < n; i++) {
+			CipherTextG1::add(c1[i], c1[i], c1[(i + 1) % n]); // not normalized
+			pub.enc(ct[i], m[i]);
+		}
+		std::vector<int64_t> wL(n);
+		for (size_t i = 0; i < n; i++) {
+			wL[i] = int64_t(rg.get64() >> 1);
+		}
+		CipherTextG1 z1;
+		CipherTextGT zt;
+		CYBOZU_BENCH_C("add G1 x1024", 10, sumLoop, z1, c1.data(), n);
+		CYBOZU_BENCH_C("sumVec G1 x1024", 10, CipherTextG1::sumVec, z1, c1.data(), n);
+		CYBOZU_BENCH_C("mul G1 x1024", 1, mulIntLoop, z1, c1.data(), wL.data(), n);
+		CYBOZU_BENCH_C("innerProduct G1 x1024", 1, CipherTextG1::innerProduct, z1, c1.data(), wL.data(), n);
+		CYBOZU_BENCH_C("mul GT x1024", 1, mulIntLoop, zt, ct.data(), wL.data(), n);
+		CYBOZU_BENCH_C("innerProduct GT x1024", 1, CipherTextGT::innerProduct, zt, ct.data(), wL.data(), n);
+		pub.encVec(c1.data(), m.data(), n);
+		CYBOZU_BENCH_C("add normalized G1 x1024", 10, sumLoop, z1, c1.data(), n);
+		CYBOZU_BENCH_C("sumVec normalized G1 x1024", 10, CipherTextG1::sumVec, z1, c1.data(), n);
+	}
+#endif
+}
+
+void mulLoop(CipherTextGT& z, const CipherTextG1 *x, const CipherTextG2 *y, size_t n)
+{
+	z.clear();
+	for (size_t i = 0; i < n; i++) {
+		CipherTextGT t;
+		CipherTextGT::mul(t, x[i], y[i]);
+		z.add(t);
+	}
+}
+
+CYBOZU_TEST_AUTO(mulVec)
+{
+	const SecretKey& sec = g_sec;
+	PublicKey pub;
+	sec.getPublicKey(pub);
+	cybozu::XorShift rg;
+	const size_t N = 1030;
+	std::vector<int64_t> m1(N), m2(N);
+	for (size_t i = 0; i < N; i++) {
+		m1[i] = int64_t(rg.get32() % 201) - 100;
+		m2[i] = int64_t(rg.get32() % 201) - 100;
+	}
+	std::vector<CipherTextG1> c1(N);
+	std::vector<CipherTextG2> c2(N);
+	pub.encVec(c1.data(), m1.data(), N);
+	pub.encVec(c2.data(), m2.data(), N);
+	CipherTextG1::add(c1[0], c1[0], c1[1]); // not normalized
+	m1[0] += m1[1];
+	const size_t tbl[] = { 0, 1, 5, 33, N };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(tbl); i++) {
+		const size_t n = tbl[i];
+		int64_t ip = 0;
+		for (size_t j = 0; j < n; j++) {
+			ip += m1[j] * m2[j];
+		}
+		CipherTextGT z;
+		CipherTextGT::mulVec(z, c1.data(), c2.data(), n);
+		checkDec(sec, pub, z, ip);
+		if (n > 100) continue;
+		CipherTextGT::mulVecMT(z, c1.data(), c2.data(), n);
+		checkDec(sec, pub, z, ip);
+		CipherTextGT::mulVecMT(z, c1.data(), c2.data(), n, 3);
+		checkDec(sec, pub, z, ip);
+		CipherTextGT z2;
+		mulLoop(z2, c1.data(), c2.data(), n);
+		CYBOZU_TEST_ASSERT(z == z2);
+	}
+#ifdef NDEBUG
+	{
+		const size_t n = 256;
+		CipherTextGT z;
+		CYBOZU_BENCH_C("mul x256", 1, mulLoop, z, c1.data(), c2.data(), n);
+		CYBOZU_BENCH_C("mulVec x256", 1, CipherTextGT::mulVec, z, c1.data(), c2.data(), n);
+		CYBOZU_BENCH_C("mulVecMT x256", 1, CipherTextGT::mulVecMT, z, c1.data(), c2.data(), n, 0);
+	}
+#endif
+}
+
 template<class T>
 T testIo(const T& x)
 {